@@ -16,6 +16,7 @@
 #include "ui/pages/global/AccountListPage.h"
 #include "ui/pages/global/PasteEEPage.h"
 #include "ui/pages/global/CustomCommandsPage.h"
+#include "ui/pages/global/DownloadStatsPage.h"
 
 #include "ui/themes/ITheme.h"
 #include "ui/themes/SystemTheme.h"
@@ -700,8 +701,14 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv)
         m_settings->registerSetting("Downloadsource", "Mojang");
         m_settings->registerSetting("Downloadsourceurl", "");
         m_settings->registerSetting("Downloadsourceproxy",false);
+        // pick the fastest healthy mirror instead of the one selected above
+        m_settings->registerSetting("DownloadsourceAuto", false);
 
         m_settings->registerSetting("Threads", 8);
+        m_settings->registerSetting("ThreadsPerHost", 6);
+        m_settings->registerSetting("MaxConnections", 32);
+        // in KiB/s, 0 means unlimited
+        m_settings->registerSetting("MaxDownloadSpeed", 0);
 
         // Console
         m_settings->registerSetting("ShowConsole", false);
@@ -744,6 +751,12 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv)
         m_settings->registerSetting("ShowGlobalGameTime", true);
         m_settings->registerSetting("RecordGameTime", true);
 
+        // Read the game files ahead while a launch is prepared
+        m_settings->registerSetting("PrefetchGameFiles", false);
+
+        // Record a timeline of each launch
+        m_settings->registerSetting("TraceLaunches", false);
+
         // Minecraft launch method
         m_settings->registerSetting("MCLaunchMethod", "LauncherPart");
 
@@ -793,6 +806,7 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv)
             m_globalSettingsProvider->addPage<ExternalToolsPage>();
             m_globalSettingsProvider->addPage<AccountListPage>();
             m_globalSettingsProvider->addPage<PasteEEPage>();
+            m_globalSettingsProvider->addPage<DownloadStatsPage>();
         }
         qDebug() << "<> Settings loaded.";
     }
@@ -1606,6 +1620,42 @@ shared_qobject_ptr<QNetworkAccessManager> Application::network()
     return m_network;
 }
 
+shared_qobject_ptr<Net::HostScheduler> Application::hostScheduler()
+{
+    if (!m_hostScheduler)
+    {
+        m_hostScheduler.reset(new Net::HostScheduler(getconfigfile() ? m_settings : nullptr));
+    }
+    return m_hostScheduler;
+}
+
+shared_qobject_ptr<Net::DownloadCoordinator> Application::downloadCoordinator()
+{
+    if (!m_downloadCoordinator)
+    {
+        m_downloadCoordinator.reset(new Net::DownloadCoordinator(getconfigfile() ? m_settings : nullptr));
+    }
+    return m_downloadCoordinator;
+}
+
+shared_qobject_ptr<Net::MirrorSelector> Application::mirrors()
+{
+    if (!m_mirrors)
+    {
+        m_mirrors.reset(new Net::MirrorSelector(m_network));
+    }
+    return m_mirrors;
+}
+
+shared_qobject_ptr<Net::DownloadStats> Application::downloadStats()
+{
+    if (!m_downloadStats)
+    {
+        m_downloadStats.reset(new Net::DownloadStats("downloadstats.json"));
+    }
+    return m_downloadStats;
+}
+
 shared_qobject_ptr<Meta::Index> Application::metadataIndex()
 {
     if (!m_metadataIndex)
@@ -1745,6 +1795,8 @@ void Application::sourceFinished()
     {
         qDebug() << "No valid 'sources' array found in JSON";
     }
+    mirrors()->setMirrors(downloadSources);
+    mirrors()->probe();
 
     // Parse the "ygg" array
     if (jsonObject.contains("ygg") && jsonObject["ygg"].isArray())
@@ -11,6 +11,9 @@
 
 #include "DownloadSource.h"
 #include "net/NetJob.h"
+#include "net/DownloadCoordinator.h"
+#include "net/MirrorSelector.h"
+#include "net/DownloadStats.h"
 #include <BaseInstance.h>
 
 #include "minecraft/launch/QuickPlayTarget.h"
@@ -128,6 +131,14 @@ public:
 
     shared_qobject_ptr<HttpMetaCache> metacache();
 
+    shared_qobject_ptr<Net::HostScheduler> hostScheduler();
+
+    shared_qobject_ptr<Net::DownloadCoordinator> downloadCoordinator();
+
+    shared_qobject_ptr<Net::MirrorSelector> mirrors();
+
+    shared_qobject_ptr<Net::DownloadStats> downloadStats();
+
     shared_qobject_ptr<Meta::Index> metadataIndex();
 
     QString getJarsPath();
@@ -219,6 +230,10 @@ private:
     shared_qobject_ptr<AccountList> m_accounts;
 
     shared_qobject_ptr<HttpMetaCache> m_metacache;
+    shared_qobject_ptr<Net::HostScheduler> m_hostScheduler;
+    shared_qobject_ptr<Net::DownloadCoordinator> m_downloadCoordinator;
+    shared_qobject_ptr<Net::MirrorSelector> m_mirrors;
+    shared_qobject_ptr<Net::DownloadStats> m_downloadStats;
     shared_qobject_ptr<Meta::Index> m_metadataIndex;
 
     std::shared_ptr<SettingsObject> m_settings;
@@ -134,7 +134,7 @@ public:
     void setManagedPack(const QString& type, const QString& id, const QString& name, const QString& versionId, const QString& version);
     void setmodpacks(const QString& addonId,const QString& fileId,const QString& platform);
 
-    /// guess log level from a line of game log
+    /// guess log level from a line of game log. This runs on a worker thread while the game logs.
     virtual MessageLevel::Enum guessLevel(const QString &line, MessageLevel::Enum level)
     {
         return level;
@@ -0,0 +1,148 @@
+#include "FileHashCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QDebug>
+
+#include "FileSystem.h"
+
+FileHashCache::FileHashCache(const QString &path) : m_path(path)
+{
+    // without a file, there is nothing to read
+    m_loaded = m_path.isEmpty();
+}
+
+void FileHashCache::loadOnce()
+{
+    if(m_loaded)
+    {
+        return;
+    }
+    m_loaded = true;
+    QFile file(m_path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+    readEntries(QJsonDocument::fromJson(file.readAll()).object());
+}
+
+void FileHashCache::readEntries(const QJsonObject &root)
+{
+    m_entries.clear();
+    for(auto iter = root.begin(); iter != root.end(); iter++)
+    {
+        auto entry = iter.value().toObject();
+        Entry known;
+        known.size = entry.value("size").toDouble(-1);
+        known.modified = entry.value("modified").toDouble(-1);
+        known.sha1 = QByteArray::fromHex(entry.value("sha1").toString().toLatin1());
+        m_entries.insert(iter.key(), known);
+    }
+}
+
+QJsonObject FileHashCache::writeEntries() const
+{
+    QJsonObject root;
+    for(auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+    {
+        QJsonObject entry;
+        entry.insert("size", double(iter->size));
+        entry.insert("modified", double(iter->modified));
+        entry.insert("sha1", QString::fromLatin1(iter->sha1.toHex()));
+        root.insert(iter.key(), entry);
+    }
+    return root;
+}
+
+QByteArray FileHashCache::hash(const QString &path)
+{
+    QFileInfo info(path);
+    if(!info.isFile())
+    {
+        return QByteArray();
+    }
+    auto absolutePath = info.absoluteFilePath();
+    auto size = info.size();
+    auto modified = info.lastModified().toMSecsSinceEpoch();
+    {
+        QMutexLocker locker(&m_mutex);
+        loadOnce();
+        auto known = m_entries.find(absolutePath);
+        if(known != m_entries.end() && known->size == size && known->modified == modified && !known->sha1.isEmpty())
+        {
+            known->used = true;
+            return known->sha1;
+        }
+    }
+
+    // reading the file takes a while, other files can be looked up meanwhile
+    QFile file(path);
+    QCryptographicHash sha1(QCryptographicHash::Sha1);
+    if(!file.open(QIODevice::ReadOnly) || !sha1.addData(&file))
+    {
+        return QByteArray();
+    }
+    Entry entry;
+    entry.size = size;
+    entry.modified = modified;
+    entry.sha1 = sha1.result();
+    entry.used = true;
+
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(absolutePath, entry);
+    m_changed = true;
+    return entry.sha1;
+}
+
+void FileHashCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if(m_path.isEmpty() || !m_changed)
+    {
+        return;
+    }
+    try
+    {
+        FS::write(m_path, QJsonDocument(writeEntries()).toJson(QJsonDocument::Compact));
+        m_changed = false;
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << e.what();
+    }
+}
+
+void FileHashCache::forgetUnused()
+{
+    QMutexLocker locker(&m_mutex);
+    loadOnce();
+    for(auto iter = m_entries.begin(); iter != m_entries.end();)
+    {
+        if(iter->used)
+        {
+            iter++;
+            continue;
+        }
+        iter = m_entries.erase(iter);
+        m_changed = true;
+    }
+}
+
+void FileHashCache::fromJson(const QJsonObject &root)
+{
+    QMutexLocker locker(&m_mutex);
+    m_loaded = true;
+    m_changed = false;
+    readEntries(root);
+}
+
+QJsonObject FileHashCache::toJson()
+{
+    QMutexLocker locker(&m_mutex);
+    loadOnce();
+    return writeEntries();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+
+/*
+ * SHA-1 hashes of files, remembered along with their size and modification time, so a file is only read again when it
+ * looks like it changed.
+ *
+ * The hashes are kept as a JSON object of absolute paths, either in a file of their own or as part of a bigger JSON
+ * document. It can be used from several threads at once.
+ */
+class FileHashCache
+{
+public:
+    /// keep the hashes in the file, or nowhere if there is none
+    explicit FileHashCache(const QString &path = QString());
+
+    /// SHA-1 of the file, or an empty array if it can't be read
+    QByteArray hash(const QString &path);
+
+    /// write the hashes to the file, if they changed since they were read
+    void save();
+
+    /// forget the files that weren't asked about since the hashes were read
+    void forgetUnused();
+
+    /// for hashes kept as part of another document, instead of the file
+    void fromJson(const QJsonObject &root);
+    QJsonObject toJson();
+
+private:
+    struct Entry
+    {
+        qint64 size = -1;
+        qint64 modified = -1;
+        QByteArray sha1;
+        bool used = false;
+    };
+
+    void loadOnce();
+    void readEntries(const QJsonObject &root);
+    QJsonObject writeEntries() const;
+
+private:
+    QString m_path;
+    QMutex m_mutex;
+    bool m_loaded = false;
+    bool m_changed = false;
+    QHash<QString, Entry> m_entries;
+};
@@ -0,0 +1,105 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include "FileHashCache.h"
+#include "FileSystem.h"
+
+class FileHashCacheTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+
+    QString writeFile(const QString &name, const QByteArray &data)
+    {
+        auto path = FS::PathCombine(m_dir.path(), name);
+        FS::write(path, data);
+        return path;
+    }
+
+    // what the cache would remember for the file, with the hash given
+    static QJsonObject entryFor(const QString &path, const QByteArray &sha1)
+    {
+        QFileInfo info(path);
+        QJsonObject entry;
+        entry.insert("size", double(info.size()));
+        entry.insert("modified", double(info.lastModified().toMSecsSinceEpoch()));
+        entry.insert("sha1", QString::fromLatin1(sha1.toHex()));
+        QJsonObject root;
+        root.insert(info.absoluteFilePath(), entry);
+        return root;
+    }
+
+private
+slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void test_hash()
+    {
+        auto path = writeFile("hashed.jar", "some content");
+        FileHashCache hashes;
+        QCOMPARE(hashes.hash(path), QCryptographicHash::hash("some content", QCryptographicHash::Sha1));
+        QVERIFY(hashes.hash(FS::PathCombine(m_dir.path(), "not there")).isEmpty());
+        QVERIFY(hashes.hash(m_dir.path()).isEmpty());
+    }
+
+    void test_remembered()
+    {
+        auto path = writeFile("remembered.jar", "remembered");
+        // a file that looks the same isn't read again, so the remembered hash is what comes out
+        FileHashCache hashes;
+        hashes.fromJson(entryFor(path, "not really a hash"));
+        QCOMPARE(hashes.hash(path), QByteArray("not really a hash"));
+
+        // one that looks different is
+        FS::write(path, "changed, and longer");
+        QCOMPARE(hashes.hash(path), QCryptographicHash::hash("changed, and longer", QCryptographicHash::Sha1));
+    }
+
+    void test_forgetUnused()
+    {
+        auto used = writeFile("used.jar", "used");
+        auto unused = writeFile("unused.jar", "unused");
+        FileHashCache hashes;
+        hashes.hash(used);
+        hashes.hash(unused);
+
+        FileHashCache again;
+        again.fromJson(hashes.toJson());
+        again.hash(used);
+        again.forgetUnused();
+        auto root = again.toJson();
+        QCOMPARE(root.keys(), QStringList({QFileInfo(used).absoluteFilePath()}));
+    }
+
+    void test_saved()
+    {
+        auto path = writeFile("saved.jar", "saved");
+        auto cachePath = FS::PathCombine(m_dir.path(), "hashes.json");
+        {
+            FileHashCache hashes(cachePath);
+            hashes.hash(path);
+            hashes.save();
+        }
+        QVERIFY(QFileInfo(cachePath).isFile());
+
+        FileHashCache loaded(cachePath);
+        QCOMPARE(loaded.toJson().keys(), QStringList({QFileInfo(path).absoluteFilePath()}));
+        QCOMPARE(loaded.hash(path), QCryptographicHash::hash("saved", QCryptographicHash::Sha1));
+
+        // none of them were asked about
+        FileHashCache forgetful(cachePath);
+        forgetful.forgetUnused();
+        QVERIFY(forgetful.toJson().isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(FileHashCacheTest)
+
+#include "FileHashCache_test.moc"
@@ -23,6 +23,23 @@
     #include <shlobj.h>
 #else
     #include <utime.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/ioctl.h>
+    #include <sys/stat.h>
+    #include <climits>
+    #include <cstdio>
+#endif
+
+#if defined(Q_OS_LINUX)
+    #include <linux/fs.h>
+#endif
+
+#if defined(Q_OS_MAC) && defined(__has_include)
+    #if __has_include(<sys/clonefile.h>)
+        #include <sys/clonefile.h>
+        #define HAVE_CLONEFILE
+    #endif
 #endif
 
 namespace FS {
@@ -171,6 +188,120 @@ bool copy::operator()(const QString &offset)
     return true;
 }
 
+namespace {
+bool reflinkFile(const QString &src, const QString &dst)
+{
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    int srcFd = ::open(QFile::encodeName(src).constData(), O_RDONLY | O_CLOEXEC);
+    if(srcFd < 0)
+    {
+        return false;
+    }
+    int dstFd = ::open(QFile::encodeName(dst).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if(dstFd < 0)
+    {
+        ::close(srcFd);
+        return false;
+    }
+    bool cloned = ::ioctl(dstFd, FICLONE, srcFd) == 0;
+    ::close(dstFd);
+    ::close(srcFd);
+    if(!cloned)
+    {
+        ::unlink(QFile::encodeName(dst).constData());
+    }
+    return cloned;
+#elif defined(HAVE_CLONEFILE)
+    return ::clonefile(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData(), 0) == 0;
+#else
+    Q_UNUSED(src);
+    Q_UNUSED(dst);
+    return false;
+#endif
+}
+
+bool hardlinkFile(const QString &src, const QString &dst)
+{
+#if defined Q_OS_WIN32
+    auto nativeSrc = QDir::toNativeSeparators(src);
+    auto nativeDst = QDir::toNativeSeparators(dst);
+    return CreateHardLinkW((LPCWSTR)nativeDst.utf16(), (LPCWSTR)nativeSrc.utf16(), NULL) != 0;
+#else
+    return ::link(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData()) == 0;
+#endif
+}
+}
+
+CloneMethod cloneFile(const QString &src, const QString &dst, bool allowHardlink)
+{
+    if(reflinkFile(src, dst))
+    {
+        return CloneMethod::Reflink;
+    }
+    if(allowHardlink && hardlinkFile(src, dst))
+    {
+        return CloneMethod::Hardlink;
+    }
+    if(QFile::copy(src, dst))
+    {
+        return CloneMethod::Copy;
+    }
+    return CloneMethod::Failed;
+}
+
+bool replaceFile(const QString &src, const QString &dst)
+{
+#if defined Q_OS_WIN32
+    auto nativeSrc = QDir::toNativeSeparators(src);
+    auto nativeDst = QDir::toNativeSeparators(dst);
+    return MoveFileExW((LPCWSTR)nativeSrc.utf16(), (LPCWSTR)nativeDst.utf16(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return ::rename(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData()) == 0;
+#endif
+}
+
+qint64 readAhead(const QString &path)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD) || defined(Q_OS_MAC)
+    int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    struct stat info;
+    if(::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+#if defined(Q_OS_MAC)
+    struct radvisory advice;
+    advice.ra_offset = 0;
+    advice.ra_count = int(qMin<qint64>(info.st_size, INT_MAX));
+    ::fcntl(fd, F_RDADVISE, &advice);
+#else
+    // the reading goes on after the file is closed
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    ::close(fd);
+    return info.st_size;
+#else
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return -1;
+    }
+    QByteArray buffer(1024 * 1024, Qt::Uninitialized);
+    qint64 size = 0;
+    qint64 read;
+    while((read = file.read(buffer.data(), buffer.size())) > 0)
+    {
+        size += read;
+    }
+    return size;
+#endif
+}
+
 bool deletePath(QString path)
 {
     bool OK = true;
@@ -77,6 +77,36 @@ private:
     QDir m_dst;
 };
 
+/// how cloneFile() put the file in place
+enum class CloneMethod
+{
+    Failed,
+    /// copy-on-write clone, shares the data until either file is changed
+    Reflink,
+    Hardlink,
+    Copy
+};
+
+/**
+ * Make dst a copy of src, as cheaply as the file system allows: a copy-on-write clone (reflink) where supported, else a
+ * hard link (if allowed), else a plain copy.
+ * A hard link shares the file, so only allow it if nothing is going to change dst in place.
+ * dst must not exist yet. Safe to call from worker threads.
+ */
+CloneMethod cloneFile(const QString &src, const QString &dst, bool allowHardlink);
+
+/**
+ * Move src over dst in one step, replacing dst if it exists. At no point is there no file at dst.
+ */
+bool replaceFile(const QString &src, const QString &dst);
+
+/**
+ * Get the system to read the file into its cache, so it's there when it's needed.
+ * Where the system can be asked to read ahead, this only starts the reading, else the file is read here.
+ * Returns the size of the file, or -1 if it can't be opened. Safe to call from worker threads.
+ */
+qint64 readAhead(const QString &path);
+
 /**
  * Delete a folder recursively
  */
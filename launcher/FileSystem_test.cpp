@@ -112,6 +112,52 @@ slots:
         f();
     }
 
+    void test_cloneFile_data()
+    {
+        QTest::addColumn<bool>("allowHardlink");
+        QTest::newRow("hardlink") << true;
+        QTest::newRow("no hardlink") << false;
+    }
+
+    void test_cloneFile()
+    {
+        QFETCH(bool, allowHardlink);
+        QTemporaryDir tempDir;
+        auto src = FS::PathCombine(tempDir.path(), "source");
+        auto dst = FS::PathCombine(tempDir.path(), "clone");
+        {
+            QFile file(src);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("some content");
+        }
+        auto method = FS::cloneFile(src, dst, allowHardlink);
+        QVERIFY(method != FS::CloneMethod::Failed);
+        if(!allowHardlink)
+        {
+            QVERIFY(method != FS::CloneMethod::Hardlink);
+        }
+        QFile clone(dst);
+        QVERIFY(clone.open(QIODevice::ReadOnly));
+        QCOMPARE(clone.readAll(), QByteArray("some content"));
+        clone.close();
+
+        // the target has to be new
+        QCOMPARE(FS::cloneFile(src, dst, allowHardlink), FS::CloneMethod::Failed);
+    }
+
+    void test_readAhead()
+    {
+        QTemporaryDir tempDir;
+        auto path = FS::PathCombine(tempDir.path(), "file");
+        {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(3 * 1024 * 1024 + 5, 'x'));
+        }
+        QCOMPARE(FS::readAhead(path), qint64(3 * 1024 * 1024 + 5));
+        QCOMPARE(FS::readAhead(FS::PathCombine(tempDir.path(), "missing")), qint64(-1));
+    }
+
     void test_getDesktop()
     {
         QCOMPARE(FS::getDesktopDir(), QStandardPaths::writableLocation(QStandardPaths::DesktopLocation));
@@ -1,11 +1,15 @@
 #include "LoggedProcess.h"
 #include "MessageLevel.h"
 #include <QDebug>
+#include <QTextCodec>
 
 #include <sys.h>
 
 LoggedProcess::LoggedProcess(QObject *parent) : QProcess(parent)
 {
+    // the same as QString::fromLocal8Bit, but it doesn't garble characters that are split between two reads
+    m_err_decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
+    m_out_decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
     // QProcess has a strange interface... let's map a lot of those into a few.
     connect(this, &QProcess::readyReadStandardOutput, this, &LoggedProcess::on_stdOut);
     connect(this, &QProcess::readyReadStandardError, this, &LoggedProcess::on_stdErr);
@@ -22,9 +26,9 @@ LoggedProcess::~LoggedProcess()
     }
 }
 
-QStringList reprocess(const QByteArray & data, QString & leftover)
+QStringList LoggedProcess::splitLines(const QString & text, QString & leftover)
 {
-    QString str = leftover + QString::fromLocal8Bit(data);
+    QString str = leftover + text;
 
     str.remove('\r');
     QStringList lines = str.split("\n");
@@ -34,13 +38,13 @@ QStringList reprocess(const QByteArray & data, QString & leftover)
 
 void LoggedProcess::on_stdErr()
 {
-    auto lines = reprocess(readAllStandardError(), m_err_leftover);
+    auto lines = splitLines(m_err_decoder->toUnicode(readAllStandardError()), m_err_leftover);
     emit log(lines, MessageLevel::StdErr);
 }
 
 void LoggedProcess::on_stdOut()
 {
-    auto lines = reprocess(readAllStandardOutput(), m_out_leftover);
+    auto lines = splitLines(m_out_decoder->toUnicode(readAllStandardOutput()), m_out_leftover);
     emit log(lines, MessageLevel::StdOut);
 }
 
@@ -57,7 +61,7 @@ void LoggedProcess::on_exit(int exit_code, QProcess::ExitStatus status)
     }
     if (!m_out_leftover.isEmpty())
     {
-        emit log({m_err_leftover}, MessageLevel::StdOut);
+        emit log({m_out_leftover}, MessageLevel::StdOut);
         m_out_leftover.clear();
     }
 
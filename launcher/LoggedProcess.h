@@ -16,6 +16,8 @@
 #pragma once
 
 #include <QProcess>
+#include <QTextDecoder>
+#include <memory>
 #include "MessageLevel.h"
 
 /*
@@ -47,6 +49,9 @@ public:
 
     void setDetachable(bool detachable);
 
+    /// the complete lines in the output read so far. What comes after the last line break is kept in leftover for the next read.
+    static QStringList splitLines(const QString &text, QString &leftover);
+
 signals:
     void log(QStringList lines, MessageLevel::Enum level);
     void stateChanged(LoggedProcess::State state);
@@ -71,6 +76,9 @@ private:
 private:
     QString m_err_leftover;
     QString m_out_leftover;
+    /// keep what is left of a character cut in two between reads
+    std::unique_ptr<QTextDecoder> m_err_decoder;
+    std::unique_ptr<QTextDecoder> m_out_decoder;
     bool m_killed = false;
     State m_state = NotRunning;
     int m_exit_code = 0;
@@ -47,15 +47,27 @@ bool MMCZip::mergeZipFiles(QuaZip *into, QFileInfo from, QSet<QString> &containe
         }
         contained.insert(filename);
 
-        if (!fileInsideMod.open(QIODevice::ReadOnly))
+        QuaZipFileInfo info_in;
+        if (!modZip.getCurrentFileInfo(&info_in))
+        {
+            qCritical() << "Failed to read the header of " << filename << " from " << from.fileName();
+            return false;
+        }
+
+        // copy the entry as it is stored, there's no point in inflating and deflating it again
+        int method = 0;
+        int level = 0;
+        if (!fileInsideMod.open(QIODevice::ReadOnly, &method, &level, true))
         {
             qCritical() << "Failed to open " << filename << " from " << from.fileName();
             return false;
         }
 
         QuaZipNewInfo info_out(fileInsideMod.getActualFileName());
+        info_out.dateTime = info_in.dateTime;
+        info_out.uncompressedSize = info_in.uncompressedSize;
 
-        if (!zipOutFile.open(QIODevice::WriteOnly, info_out))
+        if (!zipOutFile.open(QIODevice::WriteOnly, info_out, nullptr, info_in.crc, method, level, true))
         {
             qCritical() << "Failed to open " << filename << " in the jar";
             fileInsideMod.close();
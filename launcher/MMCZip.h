@@ -29,6 +29,8 @@ namespace MMCZip
 
     /**
      * Merge two zip files, using a filter function
+     *
+     * Entries are copied in their compressed form, without being inflated and deflated again.
      */
     bool mergeZipFiles(QuaZip *into, QFileInfo from, QSet<QString> &contained,
                                             const JlCompress::FilterFunction filter = nullptr);
@@ -0,0 +1,119 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QMap>
+
+#include "TestUtil.h"
+
+#include <quazip.h>
+#include <quazipfile.h>
+#include "MMCZip.h"
+#include "FileSystem.h"
+
+class MMCZipTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+
+    // text that deflates well, so stored and compressed entries differ
+    static QByteArray text(const QByteArray &seed)
+    {
+        QByteArray out;
+        for(int i = 0; i < 200; i++)
+        {
+            out += seed + QByteArray::number(i % 7) + '\n';
+        }
+        return out;
+    }
+
+    QString writeZip(const QString &name, const QMap<QString, QByteArray> &files, int method = Z_DEFLATED)
+    {
+        auto path = FS::PathCombine(m_dir.path(), name);
+        QuaZip zip(path);
+        if(!zip.open(QuaZip::mdCreate))
+        {
+            return QString();
+        }
+        for(auto iter = files.begin(); iter != files.end(); iter++)
+        {
+            QuaZipFile file(&zip);
+            if(!file.open(QIODevice::WriteOnly, QuaZipNewInfo(iter.key()), nullptr, 0, method))
+            {
+                return QString();
+            }
+            file.write(iter.value());
+            file.close();
+        }
+        zip.close();
+        return path;
+    }
+
+    static QMap<QString, QByteArray> readZip(const QString &path)
+    {
+        QMap<QString, QByteArray> out;
+        QuaZip zip(path);
+        if(!zip.open(QuaZip::mdUnzip))
+        {
+            return out;
+        }
+        QuaZipFile file(&zip);
+        for(bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+        {
+            if(!file.open(QIODevice::ReadOnly))
+            {
+                return QMap<QString, QByteArray>();
+            }
+            out.insert(zip.getCurrentFileName(), file.readAll());
+            file.close();
+        }
+        return out;
+    }
+
+    // how the entry is compressed, -1 if it isn't there
+    static int methodOf(const QString &path, const QString &name)
+    {
+        QuaZip zip(path);
+        QuaZipFileInfo info;
+        if(!zip.open(QuaZip::mdUnzip) || !zip.setCurrentFile(name) || !zip.getCurrentFileInfo(&info))
+        {
+            return -1;
+        }
+        return info.method;
+    }
+
+private
+slots:
+    void test_createModdedJar()
+    {
+        auto source = writeZip("minecraft.jar", {
+            {"a.class", text("source a")},
+            {"b.class", text("source b")},
+            {"META-INF/MANIFEST.MF", "Manifest-Version: 1.0\n"}
+        });
+        QVERIFY(!source.isEmpty());
+        // stored entries have to come out stored, and still readable
+        auto stored = writeZip("stored.zip", {{"b.class", text("stored b")}}, 0);
+        QVERIFY(!stored.isEmpty());
+        auto deflated = writeZip("deflated.zip", {{"a.class", text("deflated a")}, {"c.class", text("deflated c")}});
+        QVERIFY(!deflated.isEmpty());
+        auto disabled = writeZip("disabled.zip.disabled", {{"c.class", text("disabled c")}});
+        QVERIFY(!disabled.isEmpty());
+
+        auto target = FS::PathCombine(m_dir.path(), "modded.jar");
+        QList<Mod> mods = {Mod(QFileInfo(disabled)), Mod(QFileInfo(stored)), Mod(QFileInfo(deflated))};
+        QVERIFY(MMCZip::createModdedJar(source, target, mods));
+
+        auto contents = readZip(target);
+        QCOMPARE(contents.keys(), QStringList({"a.class", "b.class", "c.class"}));
+        QCOMPARE(contents["a.class"], text("deflated a"));
+        QCOMPARE(contents["b.class"], text("stored b"));
+        QCOMPARE(contents["c.class"], text("deflated c"));
+        // copied over as they were, not inflated and compressed again
+        QCOMPARE(methodOf(target, "b.class"), 0);
+        QCOMPARE(methodOf(target, "a.class"), int(Z_DEFLATED));
+    }
+};
+
+QTEST_GUILESS_MAIN(MMCZipTest)
+
+#include "MMCZip_test.moc"
@@ -0,0 +1,168 @@
+#include "CensorFilter.h"
+
+#include <QQueue>
+#include <algorithm>
+#include <iterator>
+
+CensorFilter::CensorFilter(const QMap<QString, QString> &replacements)
+{
+    std::fill(std::begin(m_rootAscii), std::end(m_rootAscii), -1);
+
+    // the trie, with the children of each node in a map until they are put in place
+    QVector<QMap<ushort, int>> children(1);
+    m_nodes.resize(1);
+    for(auto iter = replacements.begin(); iter != replacements.end(); iter++)
+    {
+        const auto &secret = iter.key();
+        if(secret.isEmpty())
+        {
+            continue;
+        }
+        int node = 0;
+        for(auto c: secret)
+        {
+            auto found = children[node].constFind(c.unicode());
+            if(found != children[node].constEnd())
+            {
+                node = *found;
+                continue;
+            }
+            int added = m_nodes.size();
+            m_nodes.append(Node());
+            children.append(QMap<ushort, int>());
+            children[node].insert(c.unicode(), added);
+            node = added;
+        }
+        m_nodes[node].secret = m_secrets.size();
+        m_secrets.append(secret);
+        m_replacements.append(iter.value());
+    }
+
+    for(int node = 0; node < m_nodes.size(); node++)
+    {
+        m_nodes[node].firstEdge = m_edges.size();
+        m_nodes[node].edgeCount = children[node].size();
+        for(auto iter = children[node].begin(); iter != children[node].end(); iter++)
+        {
+            m_edges.append({iter.key(), iter.value()});
+            if(node == 0 && iter.key() < 128)
+            {
+                m_rootAscii[iter.key()] = iter.value();
+            }
+        }
+    }
+
+    // fail links, shallow nodes first
+    QQueue<int> queue;
+    queue.enqueue(0);
+    while(!queue.isEmpty())
+    {
+        int parent = queue.dequeue();
+        const auto &parentNode = m_nodes[parent];
+        for(int i = parentNode.firstEdge; i < parentNode.firstEdge + parentNode.edgeCount; i++)
+        {
+            auto edge = m_edges[i];
+            auto &node = m_nodes[edge.node];
+            if(parent != 0)
+            {
+                node.fail = step(m_nodes[parent].fail, edge.c);
+            }
+            const auto &fail = m_nodes[node.fail];
+            node.output = fail.secret >= 0 ? node.fail : fail.output;
+            queue.enqueue(edge.node);
+        }
+    }
+}
+
+int CensorFilter::child(int node, ushort c) const
+{
+    if(node == 0 && c < 128)
+    {
+        return m_rootAscii[c];
+    }
+    const auto &parent = m_nodes[node];
+    auto first = m_edges.constBegin() + parent.firstEdge;
+    auto last = first + parent.edgeCount;
+    auto found = std::lower_bound(first, last, c, [](const Edge &edge, ushort c) { return edge.c < c; });
+    if(found != last && found->c == c)
+    {
+        return found->node;
+    }
+    return -1;
+}
+
+int CensorFilter::step(int node, ushort c) const
+{
+    while(true)
+    {
+        int next = child(node, c);
+        if(next >= 0)
+        {
+            return next;
+        }
+        if(node == 0)
+        {
+            return 0;
+        }
+        node = m_nodes[node].fail;
+    }
+}
+
+QString CensorFilter::censor(const QString &in) const
+{
+    if(m_secrets.isEmpty())
+    {
+        return in;
+    }
+
+    struct Match
+    {
+        int start;
+        int length;
+        int secret;
+    };
+    // stays empty, and doesn't allocate, for the lines without secrets
+    QVector<Match> matches;
+    auto data = in.utf16();
+    int node = 0;
+    for(int i = 0; i < in.size(); i++)
+    {
+        node = step(node, data[i]);
+        int hit = m_nodes[node].secret >= 0 ? node : m_nodes[node].output;
+        for(; hit >= 0; hit = m_nodes[hit].output)
+        {
+            int secret = m_nodes[hit].secret;
+            int length = m_secrets[secret].size();
+            matches.append({i - length + 1, length, secret});
+        }
+    }
+    if(matches.isEmpty())
+    {
+        return in;
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b)
+    {
+        return a.start < b.start || (a.start == b.start && a.length > b.length);
+    });
+    QString out;
+    out.reserve(in.size());
+    int done = 0;
+    for(const auto &match: matches)
+    {
+        int end = match.start + match.length;
+        if(match.start >= done)
+        {
+            out.append(in.midRef(done, match.start - done));
+            out.append(m_replacements[match.secret]);
+            done = end;
+        }
+        else if(end > done)
+        {
+            // overlaps the secret replaced before it, goes away with it
+            done = end;
+        }
+    }
+    out.append(in.midRef(done));
+    return out;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+/*
+ * Replaces secrets, like the access token, in the lines of a launch log.
+ *
+ * The secrets are put into one automaton (Aho-Corasick) when the filter is made, so a line is looked at once no matter
+ * how many secrets there are. Where secrets overlap, the leftmost, longest one is replaced and the rest of the overlap
+ * is dropped with it, so no part of a secret is left in the line.
+ */
+class CensorFilter
+{
+public:
+    CensorFilter() = default;
+    /// secret -> what to show instead
+    explicit CensorFilter(const QMap<QString, QString> &replacements);
+
+    bool isEmpty() const
+    {
+        return m_secrets.isEmpty();
+    }
+
+    /// returns the line itself, without making a copy, when there is nothing to censor in it
+    QString censor(const QString &in) const;
+
+private:
+    struct Node
+    {
+        /// the children, in m_edges
+        int firstEdge = 0;
+        int edgeCount = 0;
+        /// the longest proper suffix that is also in the trie
+        int fail = 0;
+        /// the secret that ends here, -1 if none
+        int secret = -1;
+        /// the next node on the fail chain where a secret ends, -1 if none
+        int output = -1;
+    };
+    struct Edge
+    {
+        ushort c;
+        int node;
+    };
+
+    int child(int node, ushort c) const;
+    int step(int node, ushort c) const;
+
+private:
+    QVector<Node> m_nodes;
+    /// sorted by character within each node
+    QVector<Edge> m_edges;
+    /// most lines never get past the root, so its children are looked up directly
+    int m_rootAscii[128] = {};
+    QVector<QString> m_secrets;
+    QVector<QString> m_replacements;
+};
@@ -31,6 +31,37 @@ public: /* methods */
     };
     virtual ~LaunchStep() {};
 
+    /**
+     * Only wait for these steps, instead of all the steps added to the launch before this one.
+     * They have to be added before this step. Steps that don't wait for each other run at the same time.
+     */
+    void setDependencies(const QList<LaunchStep *> &dependencies)
+    {
+        m_dependencies = dependencies;
+        m_hasDependencies = true;
+    }
+    bool hasDependencies() const
+    {
+        return m_hasDependencies;
+    }
+    const QList<LaunchStep *> &dependencies() const
+    {
+        return m_dependencies;
+    }
+
+    /**
+     * The step runs alongside a step that goes on for long, like the game. Its lines go into the log right away,
+     * instead of being held back until the steps before it are done.
+     */
+    void setRunsAlongside(bool alongside)
+    {
+        m_runsAlongside = alongside;
+    }
+    bool runsAlongside() const
+    {
+        return m_runsAlongside;
+    }
+
 private: /* methods */
     void bind(LaunchTask *parent);
 
@@ -47,4 +78,9 @@ public slots:
 
 protected: /* data */
     LaunchTask *m_parent;
+
+private: /* data */
+    QList<LaunchStep *> m_dependencies;
+    bool m_hasDependencies = false;
+    bool m_runsAlongside = false;
 };
@@ -54,6 +54,16 @@ void LaunchTask::prependStep(shared_qobject_ptr<LaunchStep> step)
     m_steps.prepend(step);
 }
 
+void LaunchTask::start()
+{
+    // before the launch starts, so it is in the trace too
+    if(!m_traceFile.isEmpty() && !m_trace)
+    {
+        m_trace.reset(new Tracer::Session(m_traceFile));
+    }
+    Task::start();
+}
+
 void LaunchTask::executeTask()
 {
     m_instance->setCrashed(false);
@@ -61,54 +71,156 @@ void LaunchTask::executeTask()
     {
         state = LaunchTask::Finished;
         emitSucceeded();
+        return;
     }
+
+    // steps wait for all the ones before them, unless they say otherwise
+    m_dependencies.clear();
+    for(int i = 0; i < m_steps.size(); i++)
+    {
+        QList<int> dependencies;
+        auto step = m_steps[i];
+        if(step->hasDependencies())
+        {
+            for(auto dependency: step->dependencies())
+            {
+                int index = stepIndex(dependency);
+                if(index < 0 || index >= i)
+                {
+                    qWarning() << "Launch step" << i << "depends on a step that doesn't run before it, ignoring that.";
+                    continue;
+                }
+                dependencies.append(index);
+            }
+        }
+        else
+        {
+            for(int j = 0; j < i; j++)
+            {
+                dependencies.append(j);
+            }
+        }
+        m_dependencies.append(dependencies);
+    }
+    m_stepStates = QVector<StepState>(m_steps.size(), StepState::Pending);
+    m_pendingLogs = QVector<QList<QPair<QString, MessageLevel::Enum>>>(m_steps.size());
+    m_logStep = 0;
+
     state = LaunchTask::Running;
-    onStepFinished();
+    startReadySteps();
+}
+
+void LaunchTask::startReadySteps()
+{
+    for(int i = 0; i < m_steps.size(); i++)
+    {
+        // steps can finish right away, which may end the launch
+        if(m_failed || m_finalized || state == LaunchTask::Aborted)
+        {
+            return;
+        }
+        if(m_stepStates[i] != StepState::Pending)
+        {
+            continue;
+        }
+        bool ready = true;
+        for(auto dependency: m_dependencies[i])
+        {
+            if(m_stepStates[dependency] != StepState::Done)
+            {
+                ready = false;
+                break;
+            }
+        }
+        if(!ready)
+        {
+            continue;
+        }
+        m_stepStates[i] = StepState::Running;
+        m_steps[i]->start();
+    }
+}
+
+int LaunchTask::stepIndex(QObject* step) const
+{
+    for(int i = 0; i < m_steps.size(); i++)
+    {
+        if(m_steps[i].get() == step)
+        {
+            return i;
+        }
+    }
+    return -1;
 }
 
 void LaunchTask::onReadyForLaunch()
 {
+    m_waitingStep = stepIndex(sender());
     state = LaunchTask::Waiting;
     emit readyForLaunch();
 }
 
 void LaunchTask::onStepFinished()
 {
-    // initial -> just start the first step
-    if(currentStep == -1)
+    auto index = stepIndex(sender());
+    if(index < 0 || index >= m_stepStates.size() || m_stepStates[index] != StepState::Running)
     {
-        currentStep ++;
-        m_steps[currentStep]->start();
         return;
     }
+    m_stepStates[index] = StepState::Done;
 
-    auto step = m_steps[currentStep];
-    if(step->wasSuccessful())
+    auto step = m_steps[index];
+    if(Tracer::isActive())
     {
-        // end?
-        if(currentStep == m_steps.size() - 1)
-        {
-            finalizeSteps(true, QString());
-        }
-        else
-        {
-            currentStep ++;
-            step = m_steps[currentStep];
-            step->start();
-        }
+        Tracer::instant(QString("%1 finished").arg(step->metaObject()->className()), "launch",
+                        {{"step", index}, {"succeeded", step->wasSuccessful()}});
     }
-    else
+    if(!step->wasSuccessful() && !m_failed)
     {
-        finalizeSteps(false, step->failReason());
+        // the steps that are running are left to finish, but nothing new is started
+        m_failed = true;
+        m_failReason = step->failReason();
+    }
+    flushLogs(false);
+
+    if(!m_failed)
+    {
+        startReadySteps();
+    }
+    if(m_finalized)
+    {
+        return;
     }
+    for(auto stepState: m_stepStates)
+    {
+        if(stepState == StepState::Running)
+        {
+            return;
+        }
+    }
+    // nothing runs anymore, so either something failed or everything is done
+    finalizeSteps(!m_failed, m_failReason);
 }
 
 void LaunchTask::finalizeSteps(bool successful, const QString& error)
 {
-    for(auto step = currentStep; step >= 0; step--)
+    m_finalized = true;
+    flushLogs(true);
+    for(auto step = m_steps.size() - 1; step >= 0; step--)
     {
-        m_steps[step]->finalize();
+        if(m_stepStates[step] != StepState::Pending)
+        {
+            m_steps[step]->finalize();
+        }
     }
+    // whoever looks at the log when the launch ends should find all of it there
+    if(m_logPipeline)
+    {
+        m_logPipeline->flush();
+    }
+    // the game never started, the trace ends with the launch. Whoever waits for the launch may let go of it when it
+    // ends, so hold on to the trace.
+    auto trace = std::move(m_trace);
     if(successful)
     {
         emitSucceeded();
@@ -117,37 +229,64 @@ void LaunchTask::finalizeSteps(bool successful, const QString& error)
     {
         emitFailed(error);
     }
+    if(trace)
+    {
+        trace->close();
+    }
+}
+
+void LaunchTask::setPid(qint64 pid)
+{
+    m_pid = pid;
+    if(pid >= 0)
+    {
+        // the game is up, that is the end of the launch. From here on, the trace would only pick up unrelated things.
+        closeTrace();
+    }
+}
+
+void LaunchTask::closeTrace()
+{
+    auto trace = std::move(m_trace);
+    if(trace)
+    {
+        Tracer::instant("Game started", "launch", {{"pid", m_pid}});
+        trace->close();
+    }
 }
 
 void LaunchTask::onProgressReportingRequested()
 {
+    auto index = stepIndex(sender());
+    if(index < 0)
+    {
+        return;
+    }
     state = LaunchTask::Waiting;
-    emit requestProgress(m_steps[currentStep].get());
+    emit requestProgress(m_steps[index].get());
 }
 
 void LaunchTask::setCensorFilter(QMap<QString, QString> filter)
 {
-    m_censorFilter = filter;
+    m_censorFilter = CensorFilter(filter);
+    if(m_logPipeline)
+    {
+        m_logPipeline->setCensorFilter(m_censorFilter);
+    }
 }
 
 QString LaunchTask::censorPrivateInfo(QString in)
 {
-    auto iter = m_censorFilter.begin();
-    while (iter != m_censorFilter.end())
-    {
-        in.replace(iter.key(), iter.value());
-        iter++;
-    }
-    return in;
+    return m_censorFilter.censor(in);
 }
 
 void LaunchTask::proceed()
 {
-    if(state != LaunchTask::Waiting)
+    if(state != LaunchTask::Waiting || m_waitingStep < 0)
     {
         return;
     }
-    m_steps[currentStep]->proceed();
+    m_steps[m_waitingStep]->proceed();
 }
 
 bool LaunchTask::canAbort() const
@@ -163,8 +302,15 @@ bool LaunchTask::canAbort() const
         case LaunchTask::Running:
         case LaunchTask::Waiting:
         {
-            auto step = m_steps[currentStep];
-            return step->canAbort();
+            // all the steps that are running have to stop
+            for(int i = 0; i < m_steps.size(); i++)
+            {
+                if(m_stepStates[i] == StepState::Running && !m_steps[i]->canAbort())
+                {
+                    return false;
+                }
+            }
+            return true;
         }
     }
     return false;
@@ -187,16 +333,20 @@ bool LaunchTask::abort()
         case LaunchTask::Running:
         case LaunchTask::Waiting:
         {
-            auto step = m_steps[currentStep];
-            if(!step->canAbort())
+            if(!canAbort())
             {
                 return false;
             }
-            if(step->abort())
+            state = LaunchTask::Aborted;
+            bool aborted = true;
+            for(int i = m_steps.size() - 1; i >= 0; i--)
             {
-                state = LaunchTask::Aborted;
-                return true;
+                if(m_stepStates[i] == StepState::Running && !m_steps[i]->abort())
+                {
+                    aborted = false;
+                }
             }
+            return aborted;
         }
         default:
             break;
@@ -211,42 +361,80 @@ shared_qobject_ptr<LogModel> LaunchTask::getLogModel()
         m_logModel.reset(new LogModel());
         m_logModel->setMaxLines(m_instance->getConsoleMaxLines());
         m_logModel->setStopOnOverflow(m_instance->shouldStopOnConsoleOverflow());
+        // the line limit is then only about memory, and the overflow settings only matter if there is no file for the log
+        m_logModel->setSpillToDisk(true);
         // FIXME: should this really be here?
         m_logModel->setOverflowMessage(tr("MultiMC stopped watching the game log because the log length surpassed %1 lines.\n"
             "You may have to fix your mods because the game is still logging to files and"
             " likely wasting harddrive space at an alarming rate!").arg(m_logModel->getMaxLines()));
+        m_logPipeline.reset(new LogPipeline(m_logModel.get()));
+        auto instance = m_instance;
+        m_logPipeline->setLevelGuesser([instance](const QString &line, MessageLevel::Enum level)
+        {
+            return instance->guessLevel(line, level);
+        });
+        m_logPipeline->setCensorFilter(m_censorFilter);
     }
     return m_logModel;
 }
 
+LogPipeline &LaunchTask::logPipeline()
+{
+    getLogModel();
+    return *m_logPipeline;
+}
+
 void LaunchTask::onLogLines(const QStringList &lines, MessageLevel::Enum defaultLevel)
 {
-    for (auto & line: lines)
+    auto step = stepIndex(sender());
+    if(holdsBackLogs(step))
     {
-        onLogLine(line, defaultLevel);
+        for (auto & line: lines)
+        {
+            logLine(step, line, defaultLevel);
+        }
+        return;
     }
+    logPipeline().append(lines, defaultLevel);
 }
 
 void LaunchTask::onLogLine(QString line, MessageLevel::Enum level)
 {
-    // if the launcher part set a log level, use it
-    auto innerLevel = MessageLevel::fromLine(line);
-    if(innerLevel != MessageLevel::Unknown)
+    logLine(stepIndex(sender()), line, level);
+}
+
+void LaunchTask::flushLogs(bool all)
+{
+    for(; m_logStep < m_steps.size(); m_logStep++)
     {
-        level = innerLevel;
+        auto pending = m_pendingLogs[m_logStep];
+        m_pendingLogs[m_logStep].clear();
+        for(auto &entry: pending)
+        {
+            logLine(m_logStep, entry.first, entry.second);
+        }
+        if(!all && m_stepStates[m_logStep] != StepState::Done)
+        {
+            break;
+        }
     }
+}
 
-    // If the level is still undetermined, guess level
-    if (level == MessageLevel::StdErr || level == MessageLevel::StdOut || level == MessageLevel::Unknown)
+void LaunchTask::logLine(int step, QString line, MessageLevel::Enum level)
+{
+    if(holdsBackLogs(step))
     {
-        level = m_instance->guessLevel(line, level);
+        m_pendingLogs[step].append(qMakePair(line, level));
+        return;
     }
+    logPipeline().append(line, level);
+}
 
-    // censor private user info
-    line = censorPrivateInfo(line);
-
-    auto &model = *getLogModel();
-    model.append(level, line);
+bool LaunchTask::holdsBackLogs(int step) const
+{
+    // keep the lines of each step together, in the order the steps were added. Steps that run alongside the game would
+    // only be heard from once it exits.
+    return step > m_logStep && step < m_pendingLogs.size() && !m_steps[step]->runsAlongside();
 }
 
 void LaunchTask::emitSucceeded()
@@ -17,12 +17,16 @@
 
 #pragma once
 #include <QProcess>
+#include <QVector>
 #include <QObjectPtr.h>
 #include "LogModel.h"
 #include "BaseInstance.h"
 #include "MessageLevel.h"
 #include "LoggedProcess.h"
 #include "LaunchStep.h"
+#include "CensorFilter.h"
+#include "LogPipeline.h"
+#include "tasks/Tracer.h"
 
 class LaunchTask: public Task
 {
@@ -50,16 +54,19 @@ public: /* methods */
     void prependStep(shared_qobject_ptr<LaunchStep> step);
     void setCensorFilter(QMap<QString, QString> filter);
 
-    InstancePtr instance()
+    /// record a timeline of the launch in the file, in the Chrome trace event format. It ends when the game has started.
+    void setTraceFile(const QString &path)
     {
-        return m_instance;
+        m_traceFile = path;
     }
 
-    void setPid(qint64 pid)
+    InstancePtr instance()
     {
-        m_pid = pid;
+        return m_instance;
     }
 
+    void setPid(qint64 pid);
+
     qint64 pid()
     {
         return m_pid;
@@ -103,21 +110,52 @@ signals:
     void requestLogging();
 
 public slots:
+    void start() override;
     void onLogLines(const QStringList& lines, MessageLevel::Enum defaultLevel = MessageLevel::Launcher);
     void onLogLine(QString line, MessageLevel::Enum defaultLevel = MessageLevel::Launcher);
     void onReadyForLaunch();
     void onStepFinished();
     void onProgressReportingRequested();
 
+private: /* types */
+    enum class StepState
+    {
+        Pending,
+        Running,
+        Done
+    };
+
 private: /*methods */
+    void startReadySteps();
     void finalizeSteps(bool successful, const QString & error);
+    int stepIndex(QObject *step) const;
+    void logLine(int step, QString line, MessageLevel::Enum level);
+    bool holdsBackLogs(int step) const;
+    LogPipeline &logPipeline();
+    void flushLogs(bool all);
+    void closeTrace();
 
 protected: /* data */
     InstancePtr m_instance;
     shared_qobject_ptr<LogModel> m_logModel;
+    /// gets the lines into m_logModel
+    std::unique_ptr<LogPipeline> m_logPipeline;
     QList <shared_qobject_ptr<LaunchStep>> m_steps;
-    QMap<QString, QString> m_censorFilter;
-    int currentStep = -1;
+    CensorFilter m_censorFilter;
+    /// for each step, the steps it waits for
+    QVector<QList<int>> m_dependencies;
+    QVector<StepState> m_stepStates;
+    /// lines of steps that run alongside earlier ones, held back until the earlier ones are done
+    QVector<QList<QPair<QString, MessageLevel::Enum>>> m_pendingLogs;
+    /// the steps before this one are done and their lines are in the log
+    int m_logStep = 0;
+    /// the step that is ready for launch
+    int m_waitingStep = -1;
+    bool m_failed = false;
+    bool m_finalized = false;
+    QString m_failReason;
+    QString m_traceFile;
+    std::unique_ptr<Tracer::Session> m_trace;
     State state = NotStarted;
     qint64 m_pid = -1;
 };
@@ -0,0 +1,253 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include "launch/LaunchTask.h"
+#include "launch/LaunchStep.h"
+#include "settings/INISettingsObject.h"
+#include "FileSystem.h"
+#include "NullInstance.h"
+
+/*
+ * A step that does nothing on its own, the test says when it logs something and how it ends.
+ */
+class FakeStep : public LaunchStep
+{
+    Q_OBJECT
+public:
+    FakeStep(LaunchTask *parent, const QString &name, QStringList &events) : LaunchStep(parent), m_name(name), m_events(events)
+    {
+    }
+
+    void executeTask() override
+    {
+        m_events.append(m_name + " started");
+    }
+    void finalize() override
+    {
+        m_events.append(m_name + " finalized");
+    }
+    bool canAbort() const override
+    {
+        return m_abortable;
+    }
+    bool abort() override
+    {
+        m_events.append(m_name + " aborted");
+        emitFailed(m_name + " was aborted");
+        return true;
+    }
+
+    void log(const QString &line)
+    {
+        emit logLine(line, MessageLevel::Launcher);
+    }
+    void succeed()
+    {
+        emitSucceeded();
+    }
+    void fail()
+    {
+        emitFailed(m_name + " failed");
+    }
+    void setAbortable(bool abortable)
+    {
+        m_abortable = abortable;
+    }
+
+private:
+    QString m_name;
+    QStringList &m_events;
+    bool m_abortable = true;
+};
+
+class LaunchTaskTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+    SettingsObjectPtr m_globalSettings;
+    InstancePtr m_instance;
+    QStringList m_events;
+
+    shared_qobject_ptr<LaunchTask> m_task;
+
+    FakeStep *addStep(const QString &name)
+    {
+        auto step = new FakeStep(m_task.get(), name, m_events);
+        m_task->appendStep(step);
+        return step;
+    }
+
+    QStringList logged()
+    {
+        QStringList out;
+        auto model = m_task->getLogModel();
+        for(int i = 0; i < model->rowCount(); i++)
+        {
+            out.append(model->data(model->index(i), Qt::DisplayRole).toString());
+        }
+        return out;
+    }
+
+private
+slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        m_globalSettings.reset(new INISettingsObject(FS::PathCombine(m_dir.path(), "launcher.cfg")));
+        for(auto id: {"PreLaunchCommand", "WrapperCommand", "PostExitCommand"})
+        {
+            m_globalSettings->registerSetting(id, "");
+        }
+        for(auto id: {"ShowConsole", "AutoCloseConsole", "ShowConsoleOnError", "LogPrePostOutput"})
+        {
+            m_globalSettings->registerSetting(id, false);
+        }
+        m_globalSettings->registerSetting("ConsoleMaxLines", 100000);
+        m_globalSettings->registerSetting("ConsoleOverflowStop", true);
+        SettingsObjectPtr settings(new INISettingsObject(FS::PathCombine(m_dir.path(), "instance.cfg")));
+        m_instance.reset(new NullInstance(m_globalSettings, settings, m_dir.path()));
+    }
+
+    void init()
+    {
+        m_events.clear();
+        m_task = LaunchTask::create(m_instance);
+    }
+
+    void cleanup()
+    {
+        m_task.reset();
+    }
+
+    void test_independentStepsStartTogether()
+    {
+        auto first = addStep("first");
+        auto left = addStep("left");
+        left->setDependencies({first});
+        auto right = addStep("right");
+        right->setDependencies({first});
+        // no dependencies given, so it waits for everything before it
+        auto last = addStep("last");
+        QSignalSpy succeeded(m_task.get(), &Task::succeeded);
+
+        m_task->start();
+        QCOMPARE(m_events, QStringList({"first started"}));
+
+        first->succeed();
+        QCOMPARE(m_events, QStringList({"first started", "left started", "right started"}));
+
+        right->succeed();
+        QVERIFY(!m_events.contains("last started"));
+        left->succeed();
+        QCOMPARE(m_events.last(), QString("last started"));
+        QCOMPARE(succeeded.size(), 0);
+
+        last->succeed();
+        QCOMPARE(succeeded.size(), 1);
+        // cleaned up in reverse
+        QCOMPARE(m_events.mid(m_events.size() - 4),
+                 QStringList({"last finalized", "right finalized", "left finalized", "first finalized"}));
+    }
+
+    void test_logsStayInStepOrder()
+    {
+        auto first = addStep("first");
+        auto second = addStep("second");
+        second->setDependencies({});
+        auto third = addStep("third");
+        third->setDependencies({});
+
+        m_task->start();
+        QCOMPARE(m_events, QStringList({"first started", "second started", "third started"}));
+
+        third->log("third 1");
+        second->log("second 1");
+        first->log("first 1");
+        third->succeed();
+        second->log("second 2");
+        first->log("first 2");
+        first->succeed();
+        second->log("second 3");
+        second->succeed();
+
+        QVERIFY(m_task->wasSuccessful());
+        QCOMPARE(logged(), QStringList({"first 1", "first 2", "second 1", "second 2", "second 3", "third 1"}));
+    }
+
+    void test_alongsideLogsRightAway()
+    {
+        auto game = addStep("game");
+        auto alongside = addStep("alongside");
+        alongside->setDependencies({});
+        alongside->setRunsAlongside(true);
+
+        m_task->start();
+        game->log("game 1");
+        alongside->log("alongside 1");
+        game->log("game 2");
+        QCOMPARE(logged(), QStringList({"game 1", "alongside 1", "game 2"}));
+
+        game->succeed();
+        alongside->succeed();
+        QVERIFY(m_task->wasSuccessful());
+    }
+
+    void test_failureLetsRunningStepsFinish()
+    {
+        auto first = addStep("first");
+        auto sideways = addStep("sideways");
+        sideways->setDependencies({});
+        auto after = addStep("after");
+        after->setDependencies({first});
+        QSignalSpy failed(m_task.get(), &Task::failed);
+
+        m_task->start();
+        first->log("first is failing");
+        first->fail();
+        // the one that runs alongside isn't stopped, and the launch waits for it
+        QCOMPARE(failed.size(), 0);
+        QVERIFY(!m_events.contains("after started"));
+        sideways->log("sideways is done");
+        sideways->succeed();
+
+        QCOMPARE(failed.size(), 1);
+        QCOMPARE(failed.first().first().toString(), QString("first failed"));
+        QVERIFY(!m_events.contains("after started"));
+        QVERIFY(!m_events.contains("after finalized"));
+        QVERIFY(m_events.contains("first finalized"));
+        QVERIFY(m_events.contains("sideways finalized"));
+        QCOMPARE(logged(), QStringList({"first is failing", "sideways is done"}));
+    }
+
+    void test_abort()
+    {
+        auto first = addStep("first");
+        auto sideways = addStep("sideways");
+        sideways->setDependencies({});
+        auto after = addStep("after");
+        QSignalSpy failed(m_task.get(), &Task::failed);
+
+        m_task->start();
+        sideways->setAbortable(false);
+        QVERIFY(!m_task->canAbort());
+        QVERIFY(!m_task->abort());
+        QCOMPARE(failed.size(), 0);
+
+        sideways->setAbortable(true);
+        QVERIFY(m_task->canAbort());
+        QVERIFY(m_task->abort());
+        QCOMPARE(failed.size(), 1);
+        // later steps are aborted first, nothing new is started
+        QVERIFY(m_events.indexOf("sideways aborted") < m_events.indexOf("first aborted"));
+        QVERIFY(!m_events.contains("after started"));
+        QVERIFY(m_events.contains("first finalized"));
+        QVERIFY(!m_task->canAbort());
+        Q_UNUSED(after);
+    }
+};
+
+QTEST_GUILESS_MAIN(LaunchTaskTest)
+
+#include "LaunchTask_test.moc"
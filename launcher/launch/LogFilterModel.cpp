@@ -0,0 +1,197 @@
+#include "LogFilterModel.h"
+
+LogFilterModel::LogFilterModel(QObject *parent) : QAbstractProxyModel(parent)
+{
+}
+
+void LogFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    beginResetModel();
+    if(m_log)
+    {
+        disconnect(m_log, nullptr, this, nullptr);
+    }
+    m_log = qobject_cast<LogModel *>(sourceModel);
+    QAbstractProxyModel::setSourceModel(m_log);
+    if(m_log)
+    {
+        connect(m_log, &LogModel::rowsAboutToBeInserted, this, &LogFilterModel::sourceRowsAboutToBeInserted);
+        connect(m_log, &LogModel::rowsInserted, this, &LogFilterModel::sourceRowsInserted);
+        connect(m_log, &LogModel::rowsAboutToBeRemoved, this, &LogFilterModel::sourceRowsAboutToBeRemoved);
+        connect(m_log, &LogModel::rowsRemoved, this, &LogFilterModel::sourceRowsRemoved);
+        connect(m_log, &LogModel::modelAboutToBeReset, this, &LogFilterModel::sourceAboutToBeReset);
+        connect(m_log, &LogModel::modelReset, this, &LogFilterModel::sourceReset);
+        connect(m_log, &LogModel::destroyed, this, [this]()
+        {
+            beginResetModel();
+            m_log = nullptr;
+            m_count = 0;
+            endResetModel();
+        });
+    }
+    m_count = m_log ? m_log->lineIndex().count(m_minimumLevel) : 0;
+    endResetModel();
+}
+
+void LogFilterModel::setMinimumLevel(MessageLevel::Enum level)
+{
+    if(level == m_minimumLevel)
+    {
+        return;
+    }
+    beginResetModel();
+    m_minimumLevel = level;
+    m_count = m_log ? m_log->lineIndex().count(m_minimumLevel) : 0;
+    endResetModel();
+}
+
+MessageLevel::Enum LogFilterModel::minimumLevel() const
+{
+    return m_minimumLevel;
+}
+
+bool LogFilterModel::filters() const
+{
+    return LogIndex::isListed(m_minimumLevel);
+}
+
+int LogFilterModel::rowFor(int sourceRow) const
+{
+    if(!m_log)
+    {
+        return -1;
+    }
+    return qMin(m_log->lineIndex().position(m_minimumLevel, sourceRow), m_count);
+}
+
+QModelIndex LogFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if(!m_log || !proxyIndex.isValid() || proxyIndex.row() >= m_count)
+    {
+        return QModelIndex();
+    }
+    return m_log->index(m_log->lineIndex().row(m_minimumLevel, proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex LogFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if(!m_log || !sourceIndex.isValid())
+    {
+        return QModelIndex();
+    }
+    int row = rowFor(sourceIndex.row());
+    if(row >= m_count || m_log->lineIndex().row(m_minimumLevel, row) != sourceIndex.row())
+    {
+        return QModelIndex();
+    }
+    return index(row, sourceIndex.column());
+}
+
+QModelIndex LogFilterModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if(parent.isValid() || row < 0 || row >= m_count || column != 0)
+    {
+        return QModelIndex();
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex LogFilterModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+int LogFilterModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+    {
+        return 0;
+    }
+    return m_count;
+}
+
+int LogFilterModel::columnCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+    {
+        return 0;
+    }
+    return 1;
+}
+
+void LogFilterModel::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    // the rows are only known to be shown once they are there
+    if(!filters())
+    {
+        beginInsertRows(parent, first, last);
+    }
+}
+
+void LogFilterModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+    if(!filters())
+    {
+        m_count = m_log->rowCount();
+        endInsertRows();
+        return;
+    }
+    int count = m_log->lineIndex().count(m_minimumLevel);
+    if(count > m_count)
+    {
+        beginInsertRows(parent, m_count, count - 1);
+        m_count = count;
+        endInsertRows();
+    }
+}
+
+void LogFilterModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if(!filters())
+    {
+        beginRemoveRows(parent, first, last);
+        return;
+    }
+    // the source only removes rows from the front. Views may still look at the rows until they are gone, so work out
+    // which of ours go with them while the index still has them.
+    Q_UNUSED(first)
+    int dropped = qMin(m_log->lineIndex().position(m_minimumLevel, last + 1), m_count);
+    if(dropped > 0)
+    {
+        beginRemoveRows(parent, 0, dropped - 1);
+        m_removing = dropped;
+    }
+}
+
+void LogFilterModel::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+    if(!filters())
+    {
+        m_count = m_log->rowCount();
+        endRemoveRows();
+        return;
+    }
+    Q_UNUSED(parent)
+    if(m_removing)
+    {
+        m_count -= m_removing;
+        m_removing = 0;
+        endRemoveRows();
+    }
+}
+
+void LogFilterModel::sourceAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void LogFilterModel::sourceReset()
+{
+    m_count = m_log->lineIndex().count(m_minimumLevel);
+    endResetModel();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QAbstractProxyModel>
+
+#include "LogModel.h"
+
+/*
+ * The rows of a LogModel at a level or worse, using the lists of its LogIndex, so switching to a filtered view of a
+ * long log doesn't mean going through all of it. With a level that isn't listed, all the rows are there.
+ */
+class LogFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+public:
+    explicit LogFilterModel(QObject *parent = nullptr);
+
+    /// only a LogModel will do
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    void setMinimumLevel(MessageLevel::Enum level);
+    MessageLevel::Enum minimumLevel() const;
+
+    /// the row of the source row, or of the first row after it that is shown
+    int rowFor(int sourceRow) const;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+private slots:
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceAboutToBeReset();
+    void sourceReset();
+
+private:
+    bool filters() const;
+
+private:
+    LogModel *m_log = nullptr;
+    MessageLevel::Enum m_minimumLevel = MessageLevel::Unknown;
+    /// the rows the views know about
+    int m_count = 0;
+    /// the rows at the front that are on their way out
+    int m_removing = 0;
+};
@@ -0,0 +1,179 @@
+#include "LogIndex.h"
+
+#include <algorithm>
+
+namespace {
+const int bitsPerBlockLog2 = 16;
+const int wordsPerBlock = (1 << bitsPerBlockLog2) / 64;
+
+inline ushort fold(QChar c)
+{
+    return c.toCaseFolded().unicode();
+}
+
+inline uint gramHash(ushort a, ushort b, ushort c)
+{
+    quint64 key = (quint64(a) << 32) | (quint64(b) << 16) | c;
+    return uint((key * Q_UINT64_C(0x9E3779B97F4A7C15)) >> (64 - bitsPerBlockLog2));
+}
+}
+
+LogIndex::LogIndex(int blockLines) : m_blockLines(qMax(1, blockLines))
+{
+}
+
+void LogIndex::append(MessageLevel::Enum level, const QString &line)
+{
+    if(m_blocks.isEmpty() || m_total % m_blockLines == 0)
+    {
+        m_blocks.append(QVector<quint64>(wordsPerBlock, 0));
+    }
+    auto bits = m_blocks.last().data();
+    auto data = line.constData();
+    if(line.size() >= 3)
+    {
+        ushort a = fold(data[0]);
+        ushort b = fold(data[1]);
+        for(int i = 2; i < line.size(); i++)
+        {
+            ushort c = fold(data[i]);
+            uint hash = gramHash(a, b, c);
+            bits[hash / 64] |= quint64(1) << (hash % 64);
+            a = b;
+            b = c;
+        }
+    }
+
+    if(level == MessageLevel::Warning || level == MessageLevel::Error || level == MessageLevel::Fatal)
+    {
+        m_warnings.rows.append(m_total);
+    }
+    if(level == MessageLevel::Error || level == MessageLevel::Fatal)
+    {
+        m_errors.rows.append(m_total);
+    }
+    m_total++;
+}
+
+void LogIndex::dropFront(int count)
+{
+    m_dropped += qBound(0, count, size());
+    int drop = m_dropped / m_blockLines - m_droppedBlocks;
+    if(drop > 0)
+    {
+        m_blocks.remove(0, drop);
+        m_droppedBlocks += drop;
+    }
+    dropListed(m_warnings);
+    dropListed(m_errors);
+}
+
+void LogIndex::dropListed(Listed &listed)
+{
+    auto &rows = listed.rows;
+    while(listed.first < rows.size() && rows[listed.first] < m_dropped)
+    {
+        listed.first++;
+    }
+    // move the rest to the front once in a while, not for every line
+    if(listed.first > 1024 && listed.first > rows.size() / 2)
+    {
+        rows.remove(0, listed.first);
+        listed.first = 0;
+    }
+}
+
+void LogIndex::clear()
+{
+    m_blocks.clear();
+    m_total = 0;
+    m_dropped = 0;
+    m_droppedBlocks = 0;
+    m_warnings = Listed();
+    m_errors = Listed();
+}
+
+int LogIndex::size() const
+{
+    return m_total - m_dropped;
+}
+
+QVector<uint> LogIndex::grams(const QString &text)
+{
+    QVector<uint> out;
+    for(int i = 2; i < text.size(); i++)
+    {
+        out.append(gramHash(fold(text[i - 2]), fold(text[i - 1]), fold(text[i])));
+    }
+    return out;
+}
+
+bool LogIndex::mayContain(int row, const QVector<uint> &grams) const
+{
+    if(row < 0 || row >= size())
+    {
+        return false;
+    }
+    const auto &bits = m_blocks[(row + m_dropped) / m_blockLines - m_droppedBlocks];
+    for(auto hash: grams)
+    {
+        if(!(bits[hash / 64] & (quint64(1) << (hash % 64))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int LogIndex::blockStart(int row) const
+{
+    int absolute = row + m_dropped;
+    return qMax(0, absolute - absolute % m_blockLines - m_dropped);
+}
+
+int LogIndex::blockEnd(int row) const
+{
+    int absolute = row + m_dropped;
+    return qMin(size(), absolute - absolute % m_blockLines + m_blockLines - m_dropped);
+}
+
+bool LogIndex::isListed(MessageLevel::Enum minimumLevel)
+{
+    return minimumLevel == MessageLevel::Warning || minimumLevel == MessageLevel::Error || minimumLevel == MessageLevel::Fatal;
+}
+
+const LogIndex::Listed &LogIndex::listed(MessageLevel::Enum minimumLevel) const
+{
+    return minimumLevel == MessageLevel::Warning ? m_warnings : m_errors;
+}
+
+int LogIndex::count(MessageLevel::Enum minimumLevel) const
+{
+    if(!isListed(minimumLevel))
+    {
+        return size();
+    }
+    const auto &rows = listed(minimumLevel);
+    return rows.rows.size() - rows.first;
+}
+
+int LogIndex::row(MessageLevel::Enum minimumLevel, int i) const
+{
+    if(!isListed(minimumLevel))
+    {
+        return i;
+    }
+    const auto &rows = listed(minimumLevel);
+    return rows.rows[rows.first + i] - m_dropped;
+}
+
+int LogIndex::position(MessageLevel::Enum minimumLevel, int row) const
+{
+    if(!isListed(minimumLevel))
+    {
+        return qBound(0, row, size());
+    }
+    const auto &rows = listed(minimumLevel);
+    auto first = rows.rows.constBegin() + rows.first;
+    return int(std::lower_bound(first, rows.rows.constEnd(), row + m_dropped) - first);
+}
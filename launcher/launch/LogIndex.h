@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include "MessageLevel.h"
+
+/*
+ * Makes searching and filtering a long log fast, built up as lines are added to it.
+ *
+ * For every block of lines there is a bit set of the three character sequences in them, case folded, so most blocks can
+ * be skipped without looking at their lines when searching for something. The rows with warnings and errors are listed
+ * on the side, so views that only show those don't have to look through the whole log either.
+ */
+class LogIndex
+{
+public:
+    explicit LogIndex(int blockLines = 4096);
+
+    void append(MessageLevel::Enum level, const QString &line);
+    /// forget the oldest lines
+    void dropFront(int count);
+    void clear();
+    int size() const;
+
+    /// what a search for the text looks for in the bit sets
+    static QVector<uint> grams(const QString &text);
+    /// false if no row in the block of the row has all of the grams
+    bool mayContain(int row, const QVector<uint> &grams) const;
+    /// the rows in the same block as the row, the end not included
+    int blockStart(int row) const;
+    int blockEnd(int row) const;
+
+    /// only Warning and Error (with Fatal) are listed, other levels mean all rows
+    static bool isListed(MessageLevel::Enum minimumLevel);
+    /// the rows at the level or worse, in order
+    int count(MessageLevel::Enum minimumLevel) const;
+    int row(MessageLevel::Enum minimumLevel, int i) const;
+    /// where the first of the listed rows at or after the row is
+    int position(MessageLevel::Enum minimumLevel, int row) const;
+
+private:
+    struct Listed
+    {
+        /// absolute row numbers
+        QVector<int> rows;
+        /// the ones before this were dropped
+        int first = 0;
+    };
+
+    const Listed &listed(MessageLevel::Enum minimumLevel) const;
+    void dropListed(Listed &listed);
+
+private:
+    int m_blockLines;
+    /// one bit set of bitsPerBlock bits per block
+    QVector<QVector<quint64>> m_blocks;
+    int m_total = 0;
+    int m_dropped = 0;
+    int m_droppedBlocks = 0;
+    Listed m_warnings;
+    Listed m_errors;
+};
@@ -0,0 +1,225 @@
+#include <QTest>
+#include <QSignalSpy>
+
+#include "launch/LogFilterModel.h"
+#include "launch/LogIndex.h"
+#include "launch/LogModel.h"
+
+namespace {
+QString lineFor(int i)
+{
+    if(i % 5003 == 17)
+    {
+        return QString("[12:01:%1] [Render thread/ERROR]: java.lang.IllegalStateException: block %2").arg(i % 60).arg(i);
+    }
+    if(i % 61 == 3)
+    {
+        return QString("[12:01:%1] [Worker-Main-2/WARN]: Missing model for variant %2").arg(i % 60).arg(i);
+    }
+    return QString("[12:01:%1] [Render thread/INFO]: Loaded %2 recipes").arg(i % 60).arg(i);
+}
+
+MessageLevel::Enum levelFor(int i)
+{
+    if(i % 5003 == 17)
+        return MessageLevel::Error;
+    if(i % 61 == 3)
+        return MessageLevel::Warning;
+    return MessageLevel::Message;
+}
+
+void fill(LogModel &model, int lines)
+{
+    QVector<LogModel::entry> entries;
+    for(int i = 0; i < lines; i++)
+    {
+        entries.append({levelFor(i), lineFor(i)});
+    }
+    model.append(entries);
+}
+
+int linearFind(LogModel &model, const QString &what, int from, bool reverse)
+{
+    for(int row = from; row >= 0 && row < model.rowCount(); row += reverse ? -1 : 1)
+    {
+        if(model.data(model.index(row), Qt::DisplayRole).toString().contains(what, Qt::CaseInsensitive))
+        {
+            return row;
+        }
+    }
+    return -1;
+}
+}
+
+class LogIndexTest : public QObject
+{
+    Q_OBJECT
+
+private
+slots:
+    void test_noFalseNegatives()
+    {
+        LogIndex index(64);
+        QStringList lines;
+        for(int i = 0; i < 1000; i++)
+        {
+            lines << lineFor(i * 7);
+            index.append(levelFor(i * 7), lines.last());
+        }
+        for(int row = 0; row < lines.size(); row++)
+        {
+            auto &line = lines[row];
+            for(int start = 0; start + 3 <= line.size(); start += 5)
+            {
+                auto part = line.mid(start, 3 + start % 11);
+                QVERIFY(index.mayContain(row, LogIndex::grams(part)));
+                QVERIFY(index.mayContain(row, LogIndex::grams(part.toUpper())));
+            }
+        }
+        QVERIFY(index.mayContain(0, LogIndex::grams("ab")));
+        QVERIFY(!index.mayContain(1000, LogIndex::grams("ab")));
+    }
+
+    void test_blocks()
+    {
+        LogIndex index(10);
+        for(int i = 0; i < 35; i++)
+        {
+            index.append(MessageLevel::Message, lineFor(i));
+        }
+        QCOMPARE(index.blockStart(13), 10);
+        QCOMPARE(index.blockEnd(13), 20);
+        QCOMPARE(index.blockEnd(31), 35);
+        index.dropFront(4);
+        QCOMPARE(index.size(), 31);
+        QCOMPARE(index.blockStart(3), 0);
+        QCOMPARE(index.blockEnd(3), 6);
+        QCOMPARE(index.blockStart(6), 6);
+    }
+
+    void test_find()
+    {
+        LogModel model;
+        model.setMaxLines(100000);
+        fill(model, 60000);
+        for(auto what: {"IllegalStateException", "illegalstateexception", "variant 3", "recipes", "not in the log", "er"})
+        {
+            for(int from: {-1, 0, 17, 18, 5000, 30000, 59999, 60000})
+            {
+                QCOMPARE(model.find(what, from, false), linearFind(model, what, qMax(from, 0), false));
+                QCOMPARE(model.find(what, from, true), linearFind(model, what, qMin(from, 59999), true));
+            }
+        }
+    }
+
+    void test_findAtLevel()
+    {
+        LogModel model;
+        model.setMaxLines(100000);
+        fill(model, 20000);
+        // both are in lines of all levels, only some of them count
+        QCOMPARE(model.find("Render", 0, false, MessageLevel::Error), 17);
+        QCOMPARE(model.find("Render", 18, false, MessageLevel::Error), 5020);
+        QCOMPARE(model.find("Render", 5019, true, MessageLevel::Error), 17);
+        QCOMPARE(model.find("12:01", 4, false, MessageLevel::Warning), 17);
+        QCOMPARE(model.find("12:01", 18, false, MessageLevel::Warning), 64);
+        QCOMPARE(model.find("Render", 19999, false, MessageLevel::Error), -1);
+        QCOMPARE(model.find("Render", 16, true, MessageLevel::Error), -1);
+    }
+
+    void test_filterModel()
+    {
+        LogModel model;
+        model.setMaxLines(100000);
+        LogFilterModel filter;
+        filter.setSourceModel(&model);
+        QCOMPARE(filter.rowCount(), 0);
+
+        fill(model, 1000);
+        QCOMPARE(filter.rowCount(), 1000);
+
+        filter.setMinimumLevel(MessageLevel::Warning);
+        QCOMPARE(filter.rowCount(), 18);
+        QCOMPARE(filter.data(filter.index(0, 0), Qt::DisplayRole).toString(), lineFor(3));
+        QCOMPARE(filter.data(filter.index(1, 0), Qt::DisplayRole).toString(), lineFor(17));
+        QCOMPARE(filter.mapToSource(filter.index(2, 0)).row(), 64);
+        QCOMPARE(filter.mapFromSource(model.index(64)).row(), 2);
+        QVERIFY(!filter.mapFromSource(model.index(65)).isValid());
+        QCOMPARE(filter.rowFor(65), 3);
+
+        QSignalSpy inserts(&filter, &LogFilterModel::rowsInserted);
+        model.append(MessageLevel::Message, "nothing to see");
+        QCOMPARE(inserts.size(), 0);
+        model.append(MessageLevel::Fatal, "overwriting existing");
+        QCOMPARE(inserts.size(), 1);
+        QCOMPARE(filter.rowCount(), 19);
+        QCOMPARE(filter.data(filter.index(18, 0), Qt::DisplayRole).toString(), QString("overwriting existing"));
+
+        filter.setMinimumLevel(MessageLevel::Error);
+        QCOMPARE(filter.rowCount(), 2);
+
+        model.clear();
+        QCOMPARE(filter.rowCount(), 0);
+    }
+
+    void test_filterModelDropsFront()
+    {
+        LogModel model;
+        model.setMaxLines(100);
+        LogFilterModel filter;
+        filter.setSourceModel(&model);
+        filter.setMinimumLevel(MessageLevel::Warning);
+        fill(model, 100);
+        QCOMPARE(filter.rowCount(), 3);
+
+        QSignalSpy removals(&filter, &LogFilterModel::rowsRemoved);
+        // the rows are still there to look at until they are removed
+        QStringList leaving;
+        connect(&filter, &LogFilterModel::rowsAboutToBeRemoved, this, [&](const QModelIndex &, int first, int last)
+        {
+            for(int row = first; row <= last; row++)
+            {
+                leaving.append(filter.data(filter.index(row, 0), Qt::DisplayRole).toString());
+            }
+        });
+        for(int i = 100; i < 150; i++)
+        {
+            model.append(levelFor(i), lineFor(i));
+        }
+        // 3 and 17 fell off the front, 64 and 125 are left
+        QCOMPARE(removals.size(), 2);
+        QCOMPARE(leaving, QStringList({lineFor(3), lineFor(17)}));
+        QCOMPARE(filter.rowCount(), 2);
+        QCOMPARE(filter.data(filter.index(0, 0), Qt::DisplayRole).toString(), lineFor(64));
+        QCOMPARE(filter.mapToSource(filter.index(1, 0)).row(), 125 - 50);
+        QCOMPARE(model.find("variant", 0, false, MessageLevel::Warning), 64 - 50);
+    }
+
+    void bench_linearFind()
+    {
+        LogModel model;
+        model.setMaxLines(500000);
+        fill(model, 500000);
+        QBENCHMARK
+        {
+            linearFind(model, "Exception", 0, false);
+            linearFind(model, "Exception", 5021, false);
+        }
+    }
+
+    void bench_indexedFind()
+    {
+        LogModel model;
+        model.setMaxLines(500000);
+        fill(model, 500000);
+        QBENCHMARK
+        {
+            model.find("Exception", 0, false);
+            model.find("Exception", 5021, false);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(LogIndexTest)
+
+#include "LogIndex_test.moc"
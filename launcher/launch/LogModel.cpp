@@ -2,7 +2,6 @@
 
 LogModel::LogModel(QObject *parent):QAbstractListModel(parent)
 {
-    m_content.resize(m_maxLines);
 }
 
 int LogModel::rowCount(const QModelIndex &parent) const
@@ -10,23 +9,22 @@ int LogModel::rowCount(const QModelIndex &parent) const
     if (parent.isValid())
         return 0;
 
-    return m_numLines;
+    return m_store.size();
 }
 
 QVariant LogModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() < 0 || index.row() >= m_numLines)
+    if (index.row() < 0 || index.row() >= m_store.size())
         return QVariant();
 
     auto row = index.row();
-    auto realRow = (row + m_firstLine) % m_maxLines;
     if (role == Qt::DisplayRole || role == Qt::EditRole)
     {
-        return m_content[realRow].line;
+        return m_store.line(row);
     }
     if(role == LevelRole)
     {
-        return m_content[realRow].level;
+        return m_store.level(row);
     }
 
     return QVariant();
@@ -34,33 +32,61 @@ QVariant LogModel::data(const QModelIndex &index, int role) const
 
 void LogModel::append(MessageLevel::Enum level, QString line)
 {
-    if(m_suspended)
+    append(QVector<entry>({{level, line}}));
+}
+
+void LogModel::append(const QVector<entry> &lines)
+{
+    if(m_suspended || lines.isEmpty())
     {
         return;
     }
-    int lineNum = (m_firstLine + m_numLines) % m_maxLines;
-    // overflow
-    if(m_numLines == m_maxLines)
+    int first = 0;
+    int count = lines.size();
+    int numLines = m_store.size();
+    // with a file to put them in, all the lines are kept
+    bool limited = !m_store.isSpilling();
+    if(limited && m_stopOnOverflow)
     {
-        if(m_stopOnOverflow)
+        // whatever doesn't fit is dropped
+        count = qMin(count, m_maxLines - numLines);
+        if(count <= 0)
         {
-            // nothing more to do, the buffer is full
             return;
         }
-        beginRemoveRows(QModelIndex(), 0, 0);
-        m_firstLine = (m_firstLine + 1) % m_maxLines;
-        m_numLines --;
-        endRemoveRows();
     }
-    else if (m_numLines == m_maxLines - 1 && m_stopOnOverflow)
+    else if(limited)
     {
-        level = MessageLevel::Fatal;
-        line = m_overflowMessage;
+        // lines that would be pushed out again by the rest of the same batch are never shown
+        if(count > m_maxLines)
+        {
+            first = count - m_maxLines;
+            count = m_maxLines;
+        }
+        int overflow = numLines + count - m_maxLines;
+        if(overflow > 0)
+        {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            m_store.dropFront(overflow);
+            m_index.dropFront(overflow);
+            endRemoveRows();
+            numLines -= overflow;
+        }
+    }
+    beginInsertRows(QModelIndex(), numLines, numLines + count - 1);
+    for(int i = first; i < first + count; i++)
+    {
+        if (limited && m_stopOnOverflow && m_store.size() == m_maxLines - 1)
+        {
+            m_store.append(MessageLevel::Fatal, m_overflowMessage);
+            m_index.append(MessageLevel::Fatal, m_overflowMessage);
+        }
+        else
+        {
+            m_store.append(lines[i].level, lines[i].line);
+            m_index.append(lines[i].level, lines[i].line);
+        }
     }
-    beginInsertRows(QModelIndex(), m_numLines, m_numLines);
-    m_numLines ++;
-    m_content[lineNum].level = level;
-    m_content[lineNum].line = line;
     endInsertRows();
 }
 
@@ -77,65 +103,126 @@ bool LogModel::suspended()
 void LogModel::clear()
 {
     beginResetModel();
-    m_firstLine = 0;
-    m_numLines = 0;
+    m_store.clear();
+    m_index.clear();
     endResetModel();
 }
 
 QString LogModel::toPlainText()
 {
     QString out;
-    out.reserve(m_numLines * 80);
-    for(int i = 0; i < m_numLines; i++)
+    int numLines = m_store.size();
+    out.reserve(numLines * 80);
+    for(int i = 0; i < numLines; i++)
     {
-        QString & line = m_content[(m_firstLine + i) % m_maxLines].line;
-        out.append(line + '\n');
+        out.append(m_store.line(i) + '\n');
     }
     out.squeeze();
     return out;
 }
 
-void LogModel::setMaxLines(int maxLines)
+int LogModel::find(const QString &what, int from, bool reverse, MessageLevel::Enum minimumLevel) const
 {
-    // no-op
-    if(maxLines == m_maxLines)
+    int rows = m_store.size();
+    if(what.isEmpty() || rows == 0)
     {
-        return;
+        return -1;
     }
-    // if it all still fits in the buffer, just resize it
-    if(m_firstLine + m_numLines < m_maxLines)
+    auto matches = [&](int row)
     {
-        m_maxLines = maxLines;
-        m_content.resize(maxLines);
-        return;
-    }
-    // otherwise, we need to reorganize the data because it crosses the wrap boundary
-    QVector<entry> newContent;
-    newContent.resize(maxLines);
-    if(m_numLines <= maxLines)
+        return m_store.line(row).contains(what, Qt::CaseInsensitive);
+    };
+
+    if(LogIndex::isListed(minimumLevel))
     {
-        // if it all fits in the new buffer, just copy it over
-        for(int i = 0; i < m_numLines; i++)
+        // only the few rows at the level need a look
+        int count = m_index.count(minimumLevel);
+        int i = m_index.position(minimumLevel, from);
+        if(reverse)
         {
-            newContent[i] = m_content[(m_firstLine + i) % m_maxLines];
+            if(i == count || m_index.row(minimumLevel, i) > from)
+            {
+                i--;
+            }
+            for(; i >= 0; i--)
+            {
+                if(matches(m_index.row(minimumLevel, i)))
+                    return m_index.row(minimumLevel, i);
+            }
         }
-        m_content.swap(newContent);
+        else
+        {
+            for(; i < count; i++)
+            {
+                if(matches(m_index.row(minimumLevel, i)))
+                    return m_index.row(minimumLevel, i);
+            }
+        }
+        return -1;
     }
-    else
+
+    // skip the blocks that can't have it
+    auto grams = LogIndex::grams(what);
+    int row = reverse ? qMin(from, rows - 1) : qMax(from, 0);
+    while(row >= 0 && row < rows)
     {
-        // if it doesn't fit, part of the data needs to be thrown away (the oldest log messages)
-        int lead = m_numLines - maxLines;
-        beginRemoveRows(QModelIndex(), 0, lead - 1);
-        for(int i = 0; i < maxLines; i++)
+        if(!m_index.mayContain(row, grams))
         {
-            newContent[i] = m_content[(m_firstLine + lead + i) % m_maxLines];
+            row = reverse ? m_index.blockStart(row) - 1 : m_index.blockEnd(row);
+            continue;
         }
-        m_numLines = m_maxLines;
-        m_content.swap(newContent);
-        endRemoveRows();
+        if(matches(row))
+        {
+            return row;
+        }
+        row += reverse ? -1 : 1;
     }
-    m_firstLine = 0;
+    return -1;
+}
+
+const LogIndex &LogModel::lineIndex() const
+{
+    return m_index;
+}
+
+void LogModel::setMaxLines(int maxLines)
+{
     m_maxLines = maxLines;
+    if(m_store.isSpilling())
+    {
+        m_store.setSpilling(true, m_maxLines);
+        return;
+    }
+    // the oldest log messages go
+    int lead = m_store.size() - maxLines;
+    if(lead > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, lead - 1);
+        m_store.dropFront(lead);
+        m_index.dropFront(lead);
+        endRemoveRows();
+    }
+}
+
+void LogModel::setSpillToDisk(bool spill)
+{
+    if(spill == m_store.isSpilling())
+    {
+        return;
+    }
+    if(!spill)
+    {
+        // back to keeping only the last lines
+        m_store.setSpilling(false, m_maxLines);
+        setMaxLines(m_maxLines);
+        return;
+    }
+    m_store.setSpilling(true, m_maxLines);
+}
+
+bool LogModel::spillsToDisk() const
+{
+    return m_store.isSpilling();
 }
 
 int LogModel::getMaxLines()
@@ -2,7 +2,10 @@
 
 #include <QAbstractListModel>
 #include <QString>
+#include <QVector>
 #include "MessageLevel.h"
+#include "LogStore.h"
+#include "LogIndex.h"
 
 class LogModel : public QAbstractListModel
 {
@@ -13,7 +16,15 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role) const;
 
+    struct entry
+    {
+        MessageLevel::Enum level;
+        QString line;
+    };
+
     void append(MessageLevel::Enum, QString line);
+    /// the same as appending the lines one by one, but the views get told about all of them at once
+    void append(const QVector<entry> &lines);
     void clear();
 
     void suspend(bool suspend);
@@ -21,8 +32,19 @@ public:
 
     QString toPlainText();
 
+    /**
+     * The first row from the given one on (or back) with the text in it, case insensitive, -1 if there is none.
+     * Only rows at minimumLevel or worse are looked at, if it is a level LogIndex lists.
+     */
+    int find(const QString &what, int from, bool reverse, MessageLevel::Enum minimumLevel = MessageLevel::Unknown) const;
+    const LogIndex &lineIndex() const;
+
     int getMaxLines();
+    /// lines kept in memory when spilling to disk, all the lines kept otherwise
     void setMaxLines(int maxLines);
+    /// keep all of the log, putting what doesn't fit into memory into a temporary file
+    void setSpillToDisk(bool spill);
+    bool spillsToDisk() const;
     void setStopOnOverflow(bool stop);
     void setOverflowMessage(const QString & overflowMessage);
 
@@ -34,20 +56,10 @@ public:
         LevelRole = Qt::UserRole
     };
 
-private /* types */:
-    struct entry
-    {
-        MessageLevel::Enum level;
-        QString line;
-    };
-
 private: /* data */
-    QVector <entry> m_content;
+    LogStore m_store;
+    LogIndex m_index;
     int m_maxLines = 1000;
-    // first line in the circular buffer
-    int m_firstLine = 0;
-    // number of lines occupied in the circular buffer
-    int m_numLines = 0;
     bool m_stopOnOverflow = false;
     QString m_overflowMessage = "OVERFLOW";
     bool m_suspended = false;
@@ -0,0 +1,132 @@
+#include "LogPipeline.h"
+
+#include <QtConcurrentRun>
+
+namespace {
+// about one frame of a 60 Hz screen
+const int frameInterval = 16;
+}
+
+LogPipeline::LogPipeline(LogModel *model, QObject *parent) : QObject(parent), m_model(model)
+{
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(frameInterval);
+    connect(&m_frameTimer, &QTimer::timeout, this, &LogPipeline::startBatch);
+    connect(&m_watcher, &QFutureWatcher<QVector<LogModel::entry>>::finished, this, &LogPipeline::batchFinished);
+}
+
+LogPipeline::~LogPipeline()
+{
+    m_watcher.waitForFinished();
+}
+
+void LogPipeline::setLevelGuesser(LevelGuesser guesser)
+{
+    m_guesser = guesser;
+}
+
+void LogPipeline::setCensorFilter(const CensorFilter &filter)
+{
+    m_censorFilter = filter;
+}
+
+void LogPipeline::append(const QString &line, MessageLevel::Enum level)
+{
+    m_queue.append({level, line});
+    schedule();
+}
+
+void LogPipeline::append(const QStringList &lines, MessageLevel::Enum level)
+{
+    m_queue.reserve(m_queue.size() + lines.size());
+    for(auto &line: lines)
+    {
+        m_queue.append({level, line});
+    }
+    schedule();
+}
+
+int LogPipeline::pending() const
+{
+    return m_batchSize + m_queue.size();
+}
+
+QVector<LogModel::entry> LogPipeline::process(QVector<LogModel::entry> lines, LevelGuesser guesser, CensorFilter filter)
+{
+    for(auto &entry: lines)
+    {
+        // if the launcher part set a log level, use it
+        auto innerLevel = MessageLevel::fromLine(entry.line);
+        if(innerLevel != MessageLevel::Unknown)
+        {
+            entry.level = innerLevel;
+        }
+
+        // If the level is still undetermined, guess level
+        auto level = entry.level;
+        if(guesser && (level == MessageLevel::StdErr || level == MessageLevel::StdOut || level == MessageLevel::Unknown))
+        {
+            entry.level = guesser(entry.line, level);
+        }
+
+        // censor private user info
+        entry.line = filter.censor(entry.line);
+    }
+    return lines;
+}
+
+void LogPipeline::schedule()
+{
+    // while a batch is worked on, more lines pile up for the next one
+    if(!m_busy && !m_frameTimer.isActive())
+    {
+        m_frameTimer.start();
+    }
+}
+
+void LogPipeline::startBatch()
+{
+    if(m_busy || m_queue.isEmpty())
+    {
+        return;
+    }
+    QVector<LogModel::entry> batch;
+    batch.swap(m_queue);
+    m_batchSize = batch.size();
+    m_busy = true;
+    m_watcher.setFuture(QtConcurrent::run(&LogPipeline::process, batch, m_guesser, m_censorFilter));
+}
+
+void LogPipeline::batchFinished()
+{
+    // flush() may have taken the result already
+    if(!m_busy)
+    {
+        return;
+    }
+    m_busy = false;
+    m_batchSize = 0;
+    m_model->append(m_watcher.result());
+    if(!m_queue.isEmpty())
+    {
+        m_frameTimer.start();
+    }
+}
+
+void LogPipeline::flush()
+{
+    m_frameTimer.stop();
+    if(m_busy)
+    {
+        m_watcher.waitForFinished();
+        m_busy = false;
+        m_batchSize = 0;
+        m_model->append(m_watcher.result());
+    }
+    if(!m_queue.isEmpty())
+    {
+        QVector<LogModel::entry> batch;
+        batch.swap(m_queue);
+        m_model->append(process(batch, m_guesser, m_censorFilter));
+    }
+}
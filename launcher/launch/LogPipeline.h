@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <functional>
+
+#include "CensorFilter.h"
+#include "LogModel.h"
+#include "MessageLevel.h"
+
+/*
+ * Gets the lines of a launch into its log model without holding up the UI when the game logs a lot.
+ *
+ * Lines are queued as they come. Once per frame, everything queued is handed to a worker thread that picks the levels
+ * and censors the lines, and what comes back is put into the model in one go, so the views see one range of new rows
+ * per frame no matter how many lines there were. The order of the lines is kept.
+ */
+class LogPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    /// called on the worker thread, so it must not touch anything the UI thread changes
+    using LevelGuesser = std::function<MessageLevel::Enum(const QString &line, MessageLevel::Enum level)>;
+
+    explicit LogPipeline(LogModel *model, QObject *parent = nullptr);
+    virtual ~LogPipeline();
+
+    void setLevelGuesser(LevelGuesser guesser);
+    void setCensorFilter(const CensorFilter &filter);
+
+    void append(const QString &line, MessageLevel::Enum level);
+    void append(const QStringList &lines, MessageLevel::Enum level);
+
+    /// puts all the lines appended so far into the model right away
+    void flush();
+
+    /// lines appended, but not in the model yet
+    int pending() const;
+
+    /// the level and censoring of lines as they are put into the model
+    static QVector<LogModel::entry> process(QVector<LogModel::entry> lines, LevelGuesser guesser, CensorFilter filter);
+
+private slots:
+    void startBatch();
+    void batchFinished();
+
+private:
+    void schedule();
+
+private:
+    LogModel *m_model;
+    LevelGuesser m_guesser;
+    CensorFilter m_censorFilter;
+    QVector<LogModel::entry> m_queue;
+    /// the lines being worked on
+    int m_batchSize = 0;
+    bool m_busy = false;
+    QTimer m_frameTimer;
+    QFutureWatcher<QVector<LogModel::entry>> m_watcher;
+};
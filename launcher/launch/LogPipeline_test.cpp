@@ -0,0 +1,203 @@
+#include <QTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <cstdio>
+#include <cstdlib>
+
+#include "launch/LogPipeline.h"
+#include "minecraft/LogClassifier.h"
+#include "LoggedProcess.h"
+
+namespace {
+MessageLevel::Enum classify(const QString &line, MessageLevel::Enum level)
+{
+    return LogClassifier::classify(line, level).level;
+}
+
+// logs like a busy modded game, as fast as it can
+int spew(int lines)
+{
+    setvbuf(stdout, nullptr, _IOFBF, 1 << 16);
+    for(int i = 0; i < lines; i++)
+    {
+        if(i % 10 == 9)
+        {
+            printf("[12:01:%02d] [Worker-Main-%d/WARN]: Missing model for variant: 'mod:block_%d#facing=north'\n", i % 60, i % 8, i);
+        }
+        else
+        {
+            printf("[12:01:%02d] [Render thread/INFO]: Loaded %d recipes from mod %d\n", i % 60, i, i % 97);
+        }
+    }
+    fflush(stdout);
+    return 0;
+}
+
+QStringList linesOf(const LogModel &model)
+{
+    QStringList lines;
+    for(int i = 0; i < model.rowCount(); i++)
+    {
+        lines << model.data(model.index(i), Qt::DisplayRole).toString();
+    }
+    return lines;
+}
+}
+
+class LogPipelineTest : public QObject
+{
+    Q_OBJECT
+
+private
+slots:
+    void test_levelsAndCensoring()
+    {
+        LogModel model;
+        LogPipeline pipeline(&model);
+        pipeline.setLevelGuesser(classify);
+        pipeline.setCensorFilter(CensorFilter({{"5d2f0e1a", "<CLIENT TOKEN>"}}));
+        pipeline.append(QStringList({"[12:01:48] [main/WARN]: token 5d2f0e1a", "plain"}), MessageLevel::StdOut);
+        pipeline.append("!![Launcher]!Launcher part line", MessageLevel::StdOut);
+        pipeline.append("Java line", MessageLevel::Launcher);
+        pipeline.flush();
+
+        QCOMPARE(pipeline.pending(), 0);
+        QCOMPARE(linesOf(model), QStringList({"[12:01:48] [main/WARN]: token <CLIENT TOKEN>", "plain", "Launcher part line", "Java line"}));
+        QCOMPARE(model.data(model.index(0), LogModel::LevelRole).toInt(), int(MessageLevel::Warning));
+        QCOMPARE(model.data(model.index(1), LogModel::LevelRole).toInt(), int(MessageLevel::StdOut));
+        QCOMPARE(model.data(model.index(2), LogModel::LevelRole).toInt(), int(MessageLevel::Launcher));
+        QCOMPARE(model.data(model.index(3), LogModel::LevelRole).toInt(), int(MessageLevel::Launcher));
+    }
+
+    void test_oneInsertPerFrame()
+    {
+        LogModel model;
+        model.setMaxLines(10000);
+        LogPipeline pipeline(&model);
+        QSignalSpy inserts(&model, &LogModel::rowsInserted);
+        for(int i = 0; i < 1000; i++)
+        {
+            pipeline.append(QStringList({QString::number(i), QString::number(i)}), MessageLevel::StdOut);
+        }
+        QCOMPARE(model.rowCount(), 0);
+        QTRY_COMPARE(model.rowCount(), 2000);
+        QCOMPARE(inserts.size(), 1);
+        QCOMPARE(model.data(model.index(1999), Qt::DisplayRole).toString(), QString("999"));
+    }
+
+    void test_orderAcrossBatches()
+    {
+        LogModel model;
+        model.setMaxLines(10000);
+        LogPipeline pipeline(&model);
+        QStringList expected;
+        for(int i = 0; i < 5000; i++)
+        {
+            expected << QString::number(i);
+            pipeline.append(expected.last(), MessageLevel::StdOut);
+            if(i % 500 == 0)
+            {
+                // let some batches go through while more lines come in
+                QTest::qWait(5);
+            }
+        }
+        QTRY_COMPARE(pipeline.pending(), 0);
+        QCOMPARE(linesOf(model), expected);
+    }
+
+    void test_batchedRingBuffer()
+    {
+        LogModel batched;
+        LogModel oneByOne;
+        batched.setMaxLines(10);
+        oneByOne.setMaxLines(10);
+        int next = 0;
+        for(int count: {3, 4, 5, 25, 1})
+        {
+            QVector<LogModel::entry> lines;
+            for(int i = 0; i < count; i++, next++)
+            {
+                lines.append({MessageLevel::Message, QString::number(next)});
+                oneByOne.append(MessageLevel::Message, QString::number(next));
+            }
+            batched.append(lines);
+            QCOMPARE(linesOf(batched), linesOf(oneByOne));
+        }
+        QCOMPARE(batched.rowCount(), 10);
+    }
+
+    void test_batchedStopOnOverflow()
+    {
+        LogModel batched;
+        LogModel oneByOne;
+        for(auto model: {&batched, &oneByOne})
+        {
+            model->setMaxLines(10);
+            model->setStopOnOverflow(true);
+            model->setOverflowMessage("full");
+        }
+        int next = 0;
+        for(int count: {4, 8, 3})
+        {
+            QVector<LogModel::entry> lines;
+            for(int i = 0; i < count; i++, next++)
+            {
+                lines.append({MessageLevel::Message, QString::number(next)});
+                oneByOne.append(MessageLevel::Message, QString::number(next));
+            }
+            batched.append(lines);
+            QCOMPARE(linesOf(batched), linesOf(oneByOne));
+        }
+        QCOMPARE(linesOf(batched).last(), QString("full"));
+        QCOMPARE(batched.data(batched.index(9), LogModel::LevelRole).toInt(), int(MessageLevel::Fatal));
+    }
+
+    // how many lines per second make it from a process into the model
+    void bench_spewingProcess()
+    {
+        const int lines = 200000;
+        LogModel model;
+        model.setMaxLines(lines + 10);
+        LogPipeline pipeline(&model);
+        pipeline.setLevelGuesser(classify);
+        int inserts = 0;
+        connect(&model, &LogModel::rowsInserted, [&inserts]() { inserts++; });
+
+        LoggedProcess process;
+        connect(&process, &LoggedProcess::log, &pipeline, [&pipeline](QStringList lines, MessageLevel::Enum level)
+        {
+            pipeline.append(lines, level);
+        });
+        QElapsedTimer timer;
+        QBENCHMARK_ONCE
+        {
+            timer.start();
+            process.start(QCoreApplication::applicationFilePath(), {"--spew", QString::number(lines)});
+            QTRY_COMPARE_WITH_TIMEOUT(int(process.state()), int(LoggedProcess::Finished), 120000);
+            pipeline.flush();
+        }
+        auto elapsed = qMax<qint64>(timer.elapsed(), 1);
+
+        // and the line saying how the process exited
+        QCOMPARE(model.rowCount(), lines + 1);
+        QCOMPARE(model.data(model.index(9), LogModel::LevelRole).toInt(), int(MessageLevel::Warning));
+        QVERIFY(inserts < lines / 10);
+        qDebug() << lines * 1000 / elapsed << "lines per second," << inserts << "inserts into the model";
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    // the benchmark starts the test itself with this, as the process that logs
+    if(argc == 3 && qstrcmp(argv[1], "--spew") == 0)
+    {
+        return spew(atoi(argv[2]));
+    }
+    QCoreApplication app(argc, argv);
+    LogPipelineTest test;
+    QTEST_SET_MAIN_SOURCE_PATH
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "LogPipeline_test.moc"
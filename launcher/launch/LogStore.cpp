@@ -0,0 +1,237 @@
+#include "LogStore.h"
+
+#include <QDebug>
+#include <climits>
+#include <cstring>
+
+LogStore::LogStore(int chunkLines) : m_chunkLines(qMax(1, chunkLines))
+{
+}
+
+LogStore::~LogStore()
+{
+}
+
+bool LogStore::setSpilling(bool spill, int memoryLines)
+{
+    if(!spill)
+    {
+        // everything comes back into memory
+        m_cachedChunks = INT_MAX;
+        for(int i = 0; i < m_chunks.size(); i++)
+        {
+            load(i);
+            m_chunks[i].filePos = -1;
+        }
+        m_recent.clear();
+        m_file.reset();
+        m_fileEnd = 0;
+        m_cachedChunks = 0;
+        return true;
+    }
+
+    m_cachedChunks = qMax(1, memoryLines / m_chunkLines);
+    if(!m_file)
+    {
+        std::unique_ptr<QTemporaryFile> file(new QTemporaryFile());
+        if(!file->open())
+        {
+            qWarning() << "Can't open a file for the log, keeping all of it in memory:" << file->errorString();
+            return false;
+        }
+        m_file = std::move(file);
+        m_fileEnd = 0;
+    }
+    for(int i = 0; i < m_chunks.size(); i++)
+    {
+        if(m_chunks[i].filePos < 0 && m_chunks[i].levels.size() == m_chunkLines)
+        {
+            spill(i);
+        }
+    }
+    // with fewer chunks to keep, some may have to go
+    if(!m_recent.isEmpty())
+    {
+        touch(m_recent.last());
+    }
+    return true;
+}
+
+bool LogStore::isSpilling() const
+{
+    return m_file != nullptr;
+}
+
+int LogStore::size() const
+{
+    return m_total - m_dropped;
+}
+
+void LogStore::append(MessageLevel::Enum level, const QString &line)
+{
+    if(m_chunks.isEmpty() || m_chunks.last().levels.size() == m_chunkLines)
+    {
+        m_chunks.append(Chunk());
+    }
+    auto &chunk = m_chunks.last();
+    chunk.text.append(line.toUtf8());
+    chunk.ends.append(chunk.text.size());
+    chunk.levels.append(char(level));
+    m_total++;
+    if(m_file && chunk.levels.size() == m_chunkLines)
+    {
+        spill(m_chunks.size() - 1);
+    }
+}
+
+const LogStore::Chunk *LogStore::chunkFor(int index, int &line) const
+{
+    if(index < 0 || index >= size())
+    {
+        return nullptr;
+    }
+    int absolute = index + m_dropped;
+    int chunk = absolute / m_chunkLines - m_droppedChunks;
+    line = absolute % m_chunkLines;
+    return &m_chunks[chunk];
+}
+
+QString LogStore::line(int index) const
+{
+    int line;
+    auto chunk = chunkFor(index, line);
+    if(!chunk || !load(int(chunk - m_chunks.constData())))
+    {
+        return QString();
+    }
+    int start = line ? chunk->ends[line - 1] : 0;
+    return QString::fromUtf8(chunk->text.constData() + start, chunk->ends[line] - start);
+}
+
+MessageLevel::Enum LogStore::level(int index) const
+{
+    int line;
+    auto chunk = chunkFor(index, line);
+    if(!chunk)
+    {
+        return MessageLevel::Unknown;
+    }
+    return MessageLevel::Enum(chunk->levels[line]);
+}
+
+void LogStore::spill(int chunk)
+{
+    auto &spilled = m_chunks[chunk];
+    int count = spilled.ends.size();
+    QByteArray raw;
+    raw.reserve(int(sizeof(int)) * (count + 1) + spilled.text.size());
+    raw.append(reinterpret_cast<const char *>(&count), sizeof(int));
+    raw.append(reinterpret_cast<const char *>(spilled.ends.constData()), int(sizeof(int)) * count);
+    raw.append(spilled.text);
+    // logs compress well even at the fastest level, and this runs while the game logs
+    auto compressed = qCompress(raw, 1);
+    if(!m_file->seek(m_fileEnd) || m_file->write(compressed) != compressed.size())
+    {
+        qWarning() << "Can't write the log to" << m_file->fileName() << "keeping it in memory:" << m_file->errorString();
+        return;
+    }
+    spilled.filePos = m_fileEnd;
+    spilled.fileSize = compressed.size();
+    m_fileEnd += compressed.size();
+    touch(chunk + m_droppedChunks);
+}
+
+bool LogStore::load(int chunk) const
+{
+    auto &loaded = m_chunks[chunk];
+    if(loaded.filePos < 0)
+    {
+        return true;
+    }
+    if(!loaded.ends.isEmpty())
+    {
+        touch(chunk + m_droppedChunks);
+        return true;
+    }
+    QByteArray raw;
+    if(m_file->seek(loaded.filePos))
+    {
+        raw = qUncompress(m_file->read(loaded.fileSize));
+    }
+    int count = 0;
+    if(raw.size() >= int(sizeof(int)))
+    {
+        memcpy(&count, raw.constData(), sizeof(int));
+    }
+    int textStart = int(sizeof(int)) * (count + 1);
+    if(count != loaded.levels.size() || raw.size() < textStart)
+    {
+        qWarning() << "Can't read the log back from" << m_file->fileName();
+        return false;
+    }
+    loaded.ends.resize(count);
+    memcpy(loaded.ends.data(), raw.constData() + sizeof(int), sizeof(int) * count);
+    loaded.text = raw.mid(textStart);
+    touch(chunk + m_droppedChunks);
+    return true;
+}
+
+void LogStore::touch(int chunk) const
+{
+    m_recent.removeOne(chunk);
+    m_recent.append(chunk);
+    while(m_recent.size() > m_cachedChunks)
+    {
+        auto &evicted = m_chunks[m_recent.takeFirst() - m_droppedChunks];
+        evicted.text = QByteArray();
+        evicted.ends = QVector<int>();
+    }
+}
+
+void LogStore::dropFront(int count)
+{
+    m_dropped += qBound(0, count, size());
+    int drop = m_dropped / m_chunkLines - m_droppedChunks;
+    if(drop <= 0)
+    {
+        return;
+    }
+    m_chunks.remove(0, drop);
+    m_droppedChunks += drop;
+    // the list is in the order of use, the dropped chunks can be anywhere in it
+    for(auto iter = m_recent.begin(); iter != m_recent.end();)
+    {
+        if(*iter < m_droppedChunks)
+        {
+            iter = m_recent.erase(iter);
+        }
+        else
+        {
+            iter++;
+        }
+    }
+}
+
+void LogStore::clear()
+{
+    m_chunks.clear();
+    m_recent.clear();
+    m_total = 0;
+    m_dropped = 0;
+    m_droppedChunks = 0;
+    if(m_file)
+    {
+        m_file->resize(0);
+        m_fileEnd = 0;
+    }
+}
+
+qint64 LogStore::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for(auto &chunk: m_chunks)
+    {
+        bytes += chunk.text.size() + qint64(sizeof(int)) * chunk.ends.size() + chunk.levels.size();
+    }
+    return bytes;
+}
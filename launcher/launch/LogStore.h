@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QTemporaryFile>
+#include <QVector>
+#include <memory>
+
+#include "MessageLevel.h"
+
+/*
+ * The lines of a log, with as many of them as needed and a bounded amount of memory.
+ *
+ * Lines are kept in chunks, as UTF-8 one after another in one buffer per chunk. When spilling is on, every chunk that
+ * fills up is compressed into a temporary file, and only the newest chunks and the ones read recently stay in memory.
+ * The others are read back from the file when one of their lines is asked for. The level of every line stays in memory,
+ * one byte each.
+ */
+class LogStore
+{
+public:
+    explicit LogStore(int chunkLines = 4096);
+    ~LogStore();
+
+    /// put the older lines into a file, keeping about memoryLines of them in memory. False if there is no file to use.
+    bool setSpilling(bool spill, int memoryLines);
+    bool isSpilling() const;
+
+    int size() const;
+    void append(MessageLevel::Enum level, const QString &line);
+    QString line(int index) const;
+    MessageLevel::Enum level(int index) const;
+
+    /// forget the oldest lines
+    void dropFront(int count);
+    void clear();
+
+    /// bytes held in memory for the lines, not counting what is in the file
+    qint64 memoryUsage() const;
+
+private:
+    struct Chunk
+    {
+        /// the lines, UTF-8, one after another. Empty if the chunk is only in the file.
+        QByteArray text;
+        /// where each line ends in text
+        QVector<int> ends;
+        /// one MessageLevel::Enum per line, always here
+        QByteArray levels;
+        /// where the chunk is in the file, -1 if it isn't
+        qint64 filePos = -1;
+        int fileSize = 0;
+    };
+
+    const Chunk *chunkFor(int index, int &line) const;
+    bool load(int chunk) const;
+    void spill(int chunk);
+    void touch(int chunk) const;
+
+private:
+    int m_chunkLines;
+    /// chunks in memory besides the one lines are added to
+    int m_cachedChunks = 0;
+    mutable QVector<Chunk> m_chunks;
+    /// lines ever added, and lines dropped from the front since
+    int m_total = 0;
+    int m_dropped = 0;
+    /// chunks dropped from the front of m_chunks
+    int m_droppedChunks = 0;
+    /// chunks that are in the file and in memory, most recently used last
+    mutable QList<int> m_recent;
+    std::unique_ptr<QTemporaryFile> m_file;
+    qint64 m_fileEnd = 0;
+
+private:
+    Q_DISABLE_COPY(LogStore)
+};
@@ -0,0 +1,194 @@
+#include <QTest>
+
+#include "launch/LogStore.h"
+#include "launch/LogModel.h"
+
+namespace {
+QString lineFor(int i)
+{
+    return QString("[12:01:%1] [Render thread/INFO]: line %2 é世").arg(i % 60).arg(i);
+}
+
+MessageLevel::Enum levelFor(int i)
+{
+    return i % 7 ? MessageLevel::Message : MessageLevel::Warning;
+}
+}
+
+class LogStoreTest : public QObject
+{
+    Q_OBJECT
+
+private
+slots:
+    void test_inMemory()
+    {
+        LogStore store(16);
+        for(int i = 0; i < 100; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        QVERIFY(!store.isSpilling());
+        QCOMPARE(store.size(), 100);
+        for(int i = 0; i < 100; i++)
+        {
+            QCOMPARE(store.line(i), lineFor(i));
+            QCOMPARE(store.level(i), levelFor(i));
+        }
+        QCOMPARE(store.line(100), QString());
+        QCOMPARE(store.line(-1), QString());
+    }
+
+    void test_spilling()
+    {
+        LogStore store(100);
+        QVERIFY(store.setSpilling(true, 300));
+        const int lines = 20000;
+        for(int i = 0; i < lines; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        QCOMPARE(store.size(), lines);
+        // three chunks and the one lines are added to, and a byte per line for the levels
+        auto bound = 4 * 100 * (lineFor(lines).toUtf8().size() + 4) + lines;
+        QVERIFY(store.memoryUsage() <= bound);
+
+        // read back out of order, so chunks come and go
+        for(int i = 0; i < lines; i += 97)
+        {
+            QCOMPARE(store.line(lines - 1 - i), lineFor(lines - 1 - i));
+            QCOMPARE(store.line(i), lineFor(i));
+            QCOMPARE(store.level(i), levelFor(i));
+        }
+        QVERIFY(store.memoryUsage() <= bound);
+    }
+
+    void test_spillingLater()
+    {
+        LogStore store(10);
+        for(int i = 0; i < 95; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        auto before = store.memoryUsage();
+        QVERIFY(store.setSpilling(true, 10));
+        QVERIFY(store.memoryUsage() < before);
+        for(int i = 0; i < 95; i++)
+        {
+            QCOMPARE(store.line(i), lineFor(i));
+        }
+
+        // and back into memory
+        QVERIFY(store.setSpilling(false, 10));
+        QVERIFY(!store.isSpilling());
+        for(int i = 0; i < 95; i++)
+        {
+            QCOMPARE(store.line(i), lineFor(i));
+        }
+    }
+
+    void test_dropFront()
+    {
+        LogStore store(10);
+        for(int i = 0; i < 35; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        store.dropFront(3);
+        QCOMPARE(store.size(), 32);
+        QCOMPARE(store.line(0), lineFor(3));
+        store.dropFront(20);
+        QCOMPARE(store.size(), 12);
+        QCOMPARE(store.line(0), lineFor(23));
+        QCOMPARE(store.line(11), lineFor(34));
+        for(int i = 35; i < 50; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        QCOMPARE(store.size(), 27);
+        QCOMPARE(store.line(26), lineFor(49));
+        QCOMPARE(store.level(4), levelFor(27));
+    }
+
+    void test_dropFrontSpilling()
+    {
+        LogStore store(10);
+        QVERIFY(store.setSpilling(true, 30));
+        for(int i = 0; i < 100; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        // an old chunk read recently sits behind newer ones in the cache
+        QCOMPARE(store.line(5), lineFor(5));
+        store.dropFront(25);
+        QCOMPARE(store.size(), 75);
+
+        // reading the rest pushes everything out of the cache, the dropped chunk too
+        for(int i = 0; i < 75; i++)
+        {
+            QCOMPARE(store.line(i), lineFor(i + 25));
+            QCOMPARE(store.level(i), levelFor(i + 25));
+        }
+        auto bound = 4 * 10 * (lineFor(100).toUtf8().size() + 4) + 100;
+        QVERIFY(store.memoryUsage() <= bound);
+    }
+
+    void test_clear()
+    {
+        LogStore store(10);
+        QVERIFY(store.setSpilling(true, 10));
+        for(int i = 0; i < 50; i++)
+        {
+            store.append(levelFor(i), lineFor(i));
+        }
+        store.clear();
+        QCOMPARE(store.size(), 0);
+        QVERIFY(store.isSpilling());
+        for(int i = 0; i < 25; i++)
+        {
+            store.append(levelFor(i), lineFor(i + 1000));
+        }
+        QCOMPARE(store.line(0), lineFor(1000));
+        QCOMPARE(store.line(24), lineFor(1024));
+    }
+
+    void test_modelKeepsEverything()
+    {
+        LogModel model;
+        model.setMaxLines(100);
+        model.setStopOnOverflow(true);
+        model.setSpillToDisk(true);
+        QVERIFY(model.spillsToDisk());
+        for(int i = 0; i < 5000; i++)
+        {
+            model.append(levelFor(i), lineFor(i));
+        }
+        // no overflow message, nothing dropped
+        QCOMPARE(model.rowCount(), 5000);
+        QCOMPARE(model.data(model.index(0), Qt::DisplayRole).toString(), lineFor(0));
+        QCOMPARE(model.data(model.index(4999), Qt::DisplayRole).toString(), lineFor(4999));
+        QCOMPARE(model.data(model.index(7), LogModel::LevelRole).toInt(), int(MessageLevel::Warning));
+
+        // without the file, it goes back to a limited log
+        model.setSpillToDisk(false);
+        QCOMPARE(model.rowCount(), 100);
+        QCOMPARE(model.data(model.index(0), Qt::DisplayRole).toString(), lineFor(4900));
+    }
+
+    void bench_appendSpilling()
+    {
+        QBENCHMARK
+        {
+            LogStore store;
+            store.setSpilling(true, 10000);
+            for(int i = 0; i < 100000; i++)
+            {
+                store.append(MessageLevel::Message, lineFor(i));
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(LogStoreTest)
+
+#include "LogStore_test.moc"
@@ -0,0 +1,178 @@
+#include "AssetsLedger.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QDebug>
+
+#include "AssetsUtils.h"
+#include "FileSystem.h"
+
+namespace {
+const quint32 ledgerMagic = 0x4D4D4341; // "MMCA"
+const quint32 ledgerVersion = 1;
+
+// a folder changed this recently might still change without its time moving on (coarse timestamps), don't rely on it
+const qint64 racyWindowMsecs = 2000;
+
+qint64 folderTime(const QString &path)
+{
+    QFileInfo info(path);
+    if(!info.isDir())
+    {
+        return -1;
+    }
+    return info.lastModified().toMSecsSinceEpoch();
+}
+}
+
+AssetsLedger::AssetsLedger(QString objectsDir, QString path)
+    : m_objects_dir(objectsDir), m_path(path)
+{
+}
+
+bool AssetsLedger::load()
+{
+    m_folders.clear();
+    QFile file(m_path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+    quint32 magic = 0, version = 0, folderCount = 0;
+    in >> magic >> version >> folderCount;
+    if(magic != ledgerMagic || version != ledgerVersion)
+    {
+        qWarning() << "Ignoring unknown assets ledger" << m_path;
+        return false;
+    }
+    QHash<QString, Folder> folders;
+    for(quint32 i = 0; i < folderCount && in.status() == QDataStream::Ok; i++)
+    {
+        QString prefix;
+        Folder folder;
+        quint32 objectCount = 0;
+        in >> prefix >> folder.mtime >> objectCount;
+        for(quint32 j = 0; j < objectCount && in.status() == QDataStream::Ok; j++)
+        {
+            QByteArray rawHash;
+            qint64 size = 0;
+            in >> rawHash >> size;
+            folder.objects.insert(QString::fromLatin1(rawHash.toHex()), size);
+        }
+        folders.insert(prefix, folder);
+    }
+    if(in.status() != QDataStream::Ok)
+    {
+        qWarning() << "Ignoring broken assets ledger" << m_path;
+        return false;
+    }
+    m_folders = folders;
+    m_dirty = false;
+    return true;
+}
+
+bool AssetsLedger::save()
+{
+    if(!m_dirty)
+    {
+        return true;
+    }
+    QByteArray data;
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream out(&buffer);
+        out.setVersion(QDataStream::Qt_5_6);
+        out << ledgerMagic << ledgerVersion << quint32(m_folders.size());
+        for(auto iter = m_folders.begin(); iter != m_folders.end(); iter++)
+        {
+            auto &folder = iter.value();
+            out << iter.key() << folder.mtime << quint32(folder.objects.size());
+            for(auto object = folder.objects.begin(); object != folder.objects.end(); object++)
+            {
+                out << QByteArray::fromHex(object.key().toLatin1()) << object.value();
+            }
+        }
+    }
+    try
+    {
+        FS::write(m_path, data);
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << e.what();
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
+
+bool AssetsLedger::objectIsIntact(const QString &hash, qint64 size) const
+{
+    QFileInfo objectFile(FS::PathCombine(m_objects_dir, hash.left(2), hash));
+    return objectFile.isFile() && objectFile.size() == size;
+}
+
+QSet<QString> AssetsLedger::check(const AssetsIndex &index)
+{
+    m_checked_files = 0;
+    m_checked_folders = 0;
+
+    // the same object can be there under many names
+    QHash<QString, QHash<QString, qint64>> byFolder;
+    for(int i = 0; i < index.size(); i++)
+    {
+        auto object = index.object(i);
+        byFolder[object.hash.left(2)].insert(object.hash, object.size);
+    }
+
+    QSet<QString> missing;
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    for(auto iter = byFolder.begin(); iter != byFolder.end(); iter++)
+    {
+        auto &prefix = iter.key();
+        // read the time before looking inside, so anything that happens while we look makes it differ next time
+        auto mtime = folderTime(FS::PathCombine(m_objects_dir, prefix));
+        m_checked_folders++;
+        if(mtime < 0 || now - mtime < racyWindowMsecs)
+        {
+            mtime = -1;
+        }
+        auto &folder = m_folders[prefix];
+        if(folder.mtime != mtime)
+        {
+            // something was added or removed, what we knew about the folder is worthless
+            folder.objects.clear();
+            folder.mtime = mtime;
+            m_dirty = true;
+        }
+        auto &wanted = iter.value();
+        for(auto object = wanted.begin(); object != wanted.end(); object++)
+        {
+            auto known = folder.objects.find(object.key());
+            if(known != folder.objects.end() && known.value() == object.value())
+            {
+                continue;
+            }
+            m_checked_files++;
+            if(objectIsIntact(object.key(), object.value()))
+            {
+                if(mtime >= 0)
+                {
+                    folder.objects.insert(object.key(), object.value());
+                    m_dirty = true;
+                }
+            }
+            else
+            {
+                missing.insert(object.key());
+            }
+        }
+    }
+    return missing;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+
+struct AssetsIndex;
+
+/*
+ * Remembers which asset objects were found intact, so a launch doesn't have to look at each of the thousands of them.
+ *
+ * Objects are recorded along with the modification time of their 'objects/xx' folder at the time they were checked.
+ * Adding, removing or renaming an object changes that time, so as long as a folder stays the same, the objects recorded
+ * in it are still there and only the folder itself has to be looked at. Objects changed in place are not noticed, that's
+ * what the deep verification of AssetUpdateTask is for.
+ */
+class AssetsLedger
+{
+public: /* con/des */
+    explicit AssetsLedger(QString objectsDir, QString path);
+
+public: /* methods */
+    bool load();
+    bool save();
+
+    /// look at the objects that aren't known to be there. Returns the hashes of the ones that are missing or incomplete.
+    QSet<QString> check(const AssetsIndex &index);
+
+    /// objects that had to be looked at individually by the last check
+    int checkedFiles() const
+    {
+        return m_checked_files;
+    }
+    int checkedFolders() const
+    {
+        return m_checked_folders;
+    }
+
+private: /* types */
+    struct Folder
+    {
+        /// modification time when the objects were checked, -1 if it can't be trusted
+        qint64 mtime = -1;
+        /// verified objects: hash -> size
+        QHash<QString, qint64> objects;
+    };
+
+private: /* methods */
+    bool objectIsIntact(const QString &hash, qint64 size) const;
+
+private: /* data */
+    QString m_objects_dir;
+    QString m_path;
+    QHash<QString, Folder> m_folders;
+    bool m_dirty = false;
+    int m_checked_files = 0;
+    int m_checked_folders = 0;
+};
@@ -0,0 +1,121 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+
+#include "TestUtil.h"
+
+#include "minecraft/AssetsLedger.h"
+#include "minecraft/AssetsUtils.h"
+#include "FileSystem.h"
+
+#ifndef Q_OS_WIN
+#include <utime.h>
+#endif
+
+class AssetsLedgerTest : public QObject
+{
+    Q_OBJECT
+
+    AssetsIndex m_objects;
+
+    // a made up SHA-1 in the given folder
+    static QString fakeHash(const QString &folder, int number)
+    {
+        return folder + QString::number(number).rightJustified(38, '0');
+    }
+
+    void addObject(const QString &objectsDir, const QString &name, const QString &hash, const QByteArray &content,
+                   bool write = true, qint64 size = -1)
+    {
+        QVERIFY(m_objects.addObject(name, hash.toLatin1(), size < 0 ? content.size() : size));
+        if(!write)
+        {
+            return;
+        }
+        auto path = FS::PathCombine(objectsDir, hash.left(2), hash);
+        QVERIFY(FS::ensureFilePathExists(path));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    }
+
+#ifndef Q_OS_WIN
+    // pretend nothing happened in the folders for a while
+    void ageFolders(const QString &objectsDir)
+    {
+        auto past = QDateTime::currentDateTime().addSecs(-3600).toTime_t();
+        for(auto &folder: QDir(objectsDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        {
+            utimbuf times;
+            times.actime = past;
+            times.modtime = past;
+            QCOMPARE(utime(QFile::encodeName(FS::PathCombine(objectsDir, folder)).constData(), &times), 0);
+        }
+    }
+#endif
+
+private
+slots:
+    void init()
+    {
+        m_objects = AssetsIndex();
+    }
+
+    void test_findsMissing()
+    {
+        QTemporaryDir dir;
+        auto objectsDir = FS::PathCombine(dir.path(), "objects");
+        addObject(objectsDir, "a.png", fakeHash("aa", 1), "aaaa");
+        addObject(objectsDir, "b.png", fakeHash("aa", 2), "bbbb");
+        addObject(objectsDir, "c.ogg", fakeHash("bb", 1), "cccc", false);
+        // there, but cut short
+        addObject(objectsDir, "d.json", fakeHash("cc", 1), "dddd", true, 10);
+
+        AssetsLedger ledger(objectsDir, FS::PathCombine(dir.path(), "ledger.dat"));
+        ledger.load();
+        auto missing = ledger.check(m_objects);
+        QCOMPARE(missing, QSet<QString>({fakeHash("bb", 1), fakeHash("cc", 1)}));
+        QCOMPARE(ledger.checkedFiles(), 4);
+    }
+
+#ifndef Q_OS_WIN
+    void test_unchangedFolders()
+    {
+        QTemporaryDir dir;
+        auto objectsDir = FS::PathCombine(dir.path(), "objects");
+        auto ledgerPath = FS::PathCombine(dir.path(), "ledger.dat");
+        addObject(objectsDir, "a.png", fakeHash("aa", 1), "aaaa");
+        addObject(objectsDir, "b.png", fakeHash("aa", 2), "bbbb");
+        addObject(objectsDir, "c.ogg", fakeHash("bb", 1), "cccc");
+        ageFolders(objectsDir);
+        {
+            AssetsLedger ledger(objectsDir, ledgerPath);
+            ledger.load();
+            QVERIFY(ledger.check(m_objects).isEmpty());
+            QCOMPARE(ledger.checkedFiles(), 3);
+            QVERIFY(ledger.save());
+        }
+        {
+            // nothing changed, only the folders are looked at
+            AssetsLedger ledger(objectsDir, ledgerPath);
+            QVERIFY(ledger.load());
+            QVERIFY(ledger.check(m_objects).isEmpty());
+            QCOMPARE(ledger.checkedFiles(), 0);
+            QCOMPARE(ledger.checkedFolders(), 2);
+        }
+
+        // removing an object changes its folder, which is looked at again
+        QVERIFY(QFile::remove(FS::PathCombine(objectsDir, "aa", fakeHash("aa", 2))));
+        AssetsLedger ledger(objectsDir, ledgerPath);
+        QVERIFY(ledger.load());
+        QCOMPARE(ledger.check(m_objects), QSet<QString>({fakeHash("aa", 2)}));
+        QCOMPARE(ledger.checkedFiles(), 2);
+    }
+#endif
+};
+
+QTEST_GUILESS_MAIN(AssetsLedgerTest)
+
+#include "AssetsLedger_test.moc"
@@ -17,22 +17,28 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QCryptographicHash>
-#include <QJsonParseError>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QVariant>
+#include <QDateTime>
+#include <QMutex>
 #include <QDebug>
 
+#include <cctype>
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
 #include "AssetsUtils.h"
+#include "AssetsLedger.h"
 #include "FileSystem.h"
 #include "net/Download.h"
 #include "net/ChecksumValidator.h"
 #include "BuildConfig.h"
+#include "tasks/Tracer.h"
 
 #include "Application.h"
 
 namespace {
-QSet<QString> collectPathsFromDir(QString dirPath)
+// files in the folder and its subfolders, with their sizes
+QHash<QString, qint64> collectPathsFromDir(QString dirPath)
 {
     QFileInfo dirInfo(dirPath);
 
@@ -41,21 +47,423 @@ QSet<QString> collectPathsFromDir(QString dirPath)
         return {};
     }
 
-    QSet<QString> out;
+    QHash<QString, qint64> out;
 
-    QDirIterator iter(dirPath, QDirIterator::Subdirectories);
+    QDirIterator iter(dirPath, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
     while (iter.hasNext())
     {
-        QString value = iter.next();
-        QFileInfo info(value);
-        if(info.isFile())
-        {
-            out.insert(value);
-            qDebug() << value;
-        }
+        iter.next();
+        out.insert(QDir::cleanPath(iter.filePath()), iter.fileInfo().size());
     }
     return out;
 }
+
+// remove the folders below dirPath that became empty
+void removeEmptyFolders(const QString &dirPath)
+{
+    QStringList folders;
+    QDirIterator iter(dirPath, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden, QDirIterator::Subdirectories);
+    while (iter.hasNext())
+    {
+        folders.append(iter.next());
+    }
+    // children are longer than their parents, so they go first
+    std::sort(folders.begin(), folders.end(), [](const QString &a, const QString &b)
+    {
+        return a.size() > b.size();
+    });
+    for(auto &folder: folders)
+    {
+        // fails for folders that still have something in them, which is fine
+        QDir().rmdir(folder);
+    }
+}
+
+struct AssetPlacement
+{
+    QString source;
+    QString target;
+    bool allowHardlink;
+    QString hash;
+    /// there is an outdated file in the way
+    bool replace;
+};
+
+FS::CloneMethod placeAsset(const AssetPlacement &placement)
+{
+    if(placement.replace)
+    {
+        QFile::remove(placement.target);
+    }
+    return FS::cloneFile(placement.source, placement.target, placement.allowHardlink);
+}
+
+int hexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/*
+ * Reads an assets index in one pass over the file, straight into the index.
+ *
+ * Going through QJsonDocument and QVariantMap builds a tree of thousands of small maps only to copy two values out of
+ * each. This only understands as much JSON as it needs to skip what it doesn't care about.
+ */
+class IndexParser
+{
+public:
+    IndexParser(const char *data, qint64 size, AssetsIndex &index)
+        : m_begin(data), m_pos(data), m_end(data + size), m_index(index)
+    {
+    }
+
+    bool parse()
+    {
+        if(!expect('{'))
+        {
+            return false;
+        }
+        bool ok = parseMembers([this](const QByteArray &key) -> bool
+        {
+            if(key == "objects")
+            {
+                return parseObjects();
+            }
+            if(key == "virtual")
+            {
+                return parseBool(m_index.isVirtual);
+            }
+            if(key == "map_to_resources")
+            {
+                return parseBool(m_index.mapToResources);
+            }
+            return skipValue(0);
+        });
+        if(!ok)
+        {
+            return false;
+        }
+        skipSpace();
+        return m_pos == m_end || fail("trailing data");
+    }
+
+    QString error() const
+    {
+        return QString("%1 at offset %2").arg(m_error).arg(m_pos - m_begin);
+    }
+
+private:
+    bool fail(const QString &error)
+    {
+        m_error = error;
+        return false;
+    }
+
+    void skipSpace()
+    {
+        while(m_pos != m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t'))
+        {
+            m_pos++;
+        }
+    }
+
+    char peek()
+    {
+        skipSpace();
+        return m_pos == m_end ? 0 : *m_pos;
+    }
+
+    bool expect(char c)
+    {
+        if(peek() != c)
+        {
+            return fail(QString("expected '%1'").arg(c));
+        }
+        m_pos++;
+        return true;
+    }
+
+    // members of an object, after its '{'. Calls member for each key, with the position at its value.
+    template <typename Member>
+    bool parseMembers(Member member)
+    {
+        if(peek() == '}')
+        {
+            m_pos++;
+            return true;
+        }
+        while(true)
+        {
+            QByteArray key;
+            if(!parseString(key) || !expect(':') || !member(key))
+            {
+                return false;
+            }
+            auto next = peek();
+            m_pos++;
+            if(next == '}')
+            {
+                return true;
+            }
+            if(next != ',')
+            {
+                m_pos--;
+                return fail("expected ',' or '}'");
+            }
+        }
+    }
+
+    // the string in UTF-8. Without escapes, it points right into the file
+    bool parseString(QByteArray &out)
+    {
+        if(!expect('"'))
+        {
+            return false;
+        }
+        auto start = m_pos;
+        while(m_pos != m_end && *m_pos != '"' && *m_pos != '\\')
+        {
+            m_pos++;
+        }
+        if(m_pos == m_end)
+        {
+            return fail("unterminated string");
+        }
+        if(*m_pos == '"')
+        {
+            out = QByteArray::fromRawData(start, m_pos - start);
+            m_pos++;
+            return true;
+        }
+        // the slow way, for strings with escapes
+        out = QByteArray(start, m_pos - start);
+        while(m_pos != m_end && *m_pos != '"')
+        {
+            if(*m_pos != '\\')
+            {
+                out.append(*m_pos++);
+                continue;
+            }
+            if(++m_pos == m_end)
+            {
+                break;
+            }
+            switch(*m_pos++)
+            {
+                case '"': out.append('"'); break;
+                case '\\': out.append('\\'); break;
+                case '/': out.append('/'); break;
+                case 'b': out.append('\b'); break;
+                case 'f': out.append('\f'); break;
+                case 'n': out.append('\n'); break;
+                case 'r': out.append('\r'); break;
+                case 't': out.append('\t'); break;
+                case 'u':
+                {
+                    ushort unit = 0;
+                    if(!parseUnicodeEscape(unit))
+                    {
+                        return false;
+                    }
+                    QString decoded(QChar(unit));
+                    // the other half of a surrogate pair
+                    if(QChar::isHighSurrogate(unit) && m_end - m_pos >= 6 && m_pos[0] == '\\' && m_pos[1] == 'u')
+                    {
+                        m_pos += 2;
+                        ushort low = 0;
+                        if(!parseUnicodeEscape(low))
+                        {
+                            return false;
+                        }
+                        decoded.append(QChar(low));
+                    }
+                    out.append(decoded.toUtf8());
+                    break;
+                }
+                default:
+                    m_pos--;
+                    return fail("invalid escape");
+            }
+        }
+        if(m_pos == m_end)
+        {
+            return fail("unterminated string");
+        }
+        m_pos++;
+        return true;
+    }
+
+    bool parseUnicodeEscape(ushort &unit)
+    {
+        if(m_end - m_pos < 4)
+        {
+            return fail("invalid escape");
+        }
+        unit = 0;
+        for(int i = 0; i < 4; i++)
+        {
+            auto digit = hexValue(*m_pos++);
+            if(digit < 0)
+            {
+                return fail("invalid escape");
+            }
+            unit = (unit << 4) | digit;
+        }
+        return true;
+    }
+
+    bool parseNumber(double &out)
+    {
+        skipSpace();
+        auto start = m_pos;
+        while(m_pos != m_end && (isdigit(uchar(*m_pos)) || *m_pos == '-' || *m_pos == '+' || *m_pos == '.' || *m_pos == 'e' || *m_pos == 'E'))
+        {
+            m_pos++;
+        }
+        bool ok = false;
+        out = QByteArray::fromRawData(start, m_pos - start).toDouble(&ok);
+        return ok || fail("invalid number");
+    }
+
+    bool parseLiteral(const char *literal)
+    {
+        auto length = qstrlen(literal);
+        if(m_end - m_pos < qint64(length) || qstrncmp(m_pos, literal, length) != 0)
+        {
+            return fail("invalid value");
+        }
+        m_pos += length;
+        return true;
+    }
+
+    // anything that isn't 'true' counts as false
+    bool parseBool(bool &out)
+    {
+        out = peek() == 't';
+        return skipValue(0);
+    }
+
+    bool skipValue(int depth)
+    {
+        if(depth > 64)
+        {
+            return fail("too deeply nested");
+        }
+        QByteArray dummy;
+        switch(peek())
+        {
+            case '{':
+                m_pos++;
+                return parseMembers([this, depth](const QByteArray &) -> bool
+                {
+                    return skipValue(depth + 1);
+                });
+            case '[':
+            {
+                m_pos++;
+                if(peek() == ']')
+                {
+                    m_pos++;
+                    return true;
+                }
+                while(true)
+                {
+                    if(!skipValue(depth + 1))
+                    {
+                        return false;
+                    }
+                    auto next = peek();
+                    m_pos++;
+                    if(next == ']')
+                    {
+                        return true;
+                    }
+                    if(next != ',')
+                    {
+                        m_pos--;
+                        return fail("expected ',' or ']'");
+                    }
+                }
+            }
+            case '"':
+                return parseString(dummy);
+            case 't':
+                return parseLiteral("true");
+            case 'f':
+                return parseLiteral("false");
+            case 'n':
+                return parseLiteral("null");
+            default:
+            {
+                double number;
+                return parseNumber(number);
+            }
+        }
+    }
+
+    bool parseObjects()
+    {
+        if(!expect('{'))
+        {
+            return false;
+        }
+        return parseMembers([this](const QByteArray &name) -> bool
+        {
+            QByteArray hash;
+            double size = 0;
+            if(peek() != '{')
+            {
+                return fail("object is not an object");
+            }
+            m_pos++;
+            bool ok = parseMembers([&](const QByteArray &key) -> bool
+            {
+                if(key == "hash" && peek() == '"')
+                {
+                    return parseString(hash);
+                }
+                if(key == "size" && peek() != '"')
+                {
+                    return parseNumber(size);
+                }
+                return skipValue(0);
+            });
+            if(!ok)
+            {
+                return false;
+            }
+            auto objectName = QString::fromUtf8(name);
+            if(!m_index.addObject(objectName, hash, qint64(size)))
+            {
+                return fail(QString("invalid hash of object %1").arg(objectName));
+            }
+            return true;
+        });
+    }
+
+private:
+    const char *m_begin;
+    const char *m_pos;
+    const char *m_end;
+    AssetsIndex &m_index;
+    QString m_error;
+};
+
+// indexes parsed before, by assets ID
+struct CachedIndex
+{
+    QDateTime modified;
+    qint64 size = 0;
+    std::shared_ptr<const AssetsIndex> index;
+};
+QMutex indexCacheMutex;
+QHash<QString, CachedIndex> indexCache;
 }
 
 
@@ -90,77 +498,55 @@ bool loadAssetsIndexJson(const QString &assetsId, const QString &path, AssetsInd
         qCritical() << "Failed to read assets index file" << path;
         return false;
     }
+    index = AssetsIndex();
     index.id = assetsId;
 
-    // Read the file and close it.
-    QByteArray jsonData = file.readAll();
-    file.close();
-
-    QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonData, &parseError);
-
-    // Fail if the JSON is invalid.
-    if (parseError.error != QJsonParseError::NoError)
+    // parse the file where it is if we can, instead of copying it
+    QByteArray contents;
+    const char *data = reinterpret_cast<const char *>(file.size() ? file.map(0, file.size()) : nullptr);
+    qint64 size = file.size();
+    if(!data)
     {
-        qCritical() << "Failed to parse assets index file:" << parseError.errorString()
-                     << "at offset " << QString::number(parseError.offset);
-        return false;
+        contents = file.readAll();
+        data = contents.constData();
+        size = contents.size();
     }
 
-    // Make sure the root is an object.
-    if (!jsonDoc.isObject())
+    IndexParser parser(data, size, index);
+    if (!parser.parse())
     {
-        qCritical() << "Invalid assets index JSON: Root should be an array.";
+        qCritical() << "Failed to parse assets index file:" << parser.error();
         return false;
     }
+    return true;
+}
 
-    QJsonObject root = jsonDoc.object();
-
-    QJsonValue isVirtual = root.value("virtual");
-    if (!isVirtual.isUndefined())
+std::shared_ptr<const AssetsIndex> loadAssetsIndex(const QString &assetsId)
+{
+    QString indexPath = FS::PathCombine("assets/indexes", assetsId + ".json");
+    QFileInfo info(indexPath);
+    if (!info.isFile())
     {
-        index.isVirtual = isVirtual.toBool(false);
+        return nullptr;
     }
 
-    QJsonValue mapToResources = root.value("map_to_resources");
-    if (!mapToResources.isUndefined())
+    QMutexLocker locker(&indexCacheMutex);
+    auto cached = indexCache.value(assetsId);
+    if(cached.index && cached.modified == info.lastModified() && cached.size == info.size())
     {
-        index.mapToResources = mapToResources.toBool(false);
+        return cached.index;
     }
-
-    QJsonValue objects = root.value("objects");
-    QVariantMap map = objects.toVariant().toMap();
-
-    for (QVariantMap::const_iterator iter = map.begin(); iter != map.end(); ++iter)
+    auto index = std::make_shared<AssetsIndex>();
+    if(!loadAssetsIndexJson(assetsId, indexPath, *index))
     {
-        // qDebug() << iter.key();
-
-        QVariant variant = iter.value();
-        QVariantMap nested_objects = variant.toMap();
-
-        AssetObject object;
-
-        for (QVariantMap::const_iterator nested_iter = nested_objects.begin();
-             nested_iter != nested_objects.end(); ++nested_iter)
-        {
-            // qDebug() << nested_iter.key() << nested_iter.value().toString();
-            QString key = nested_iter.key();
-            QVariant value = nested_iter.value();
-
-            if (key == "hash")
-            {
-                object.hash = value.toString();
-            }
-            else if (key == "size")
-            {
-                object.size = value.toDouble();
-            }
-        }
-
-        index.objects.insert(iter.key(), object);
+        indexCache.remove(assetsId);
+        return nullptr;
     }
-
-    return true;
+    cached.modified = info.lastModified();
+    cached.size = info.size();
+    cached.index = index;
+    indexCache.insert(assetsId, cached);
+    return index;
 }
 
 // FIXME: ugly code duplication
@@ -181,19 +567,19 @@ QDir getAssetsDir(const QString &assetsId, const QString &resourcesFolder)
         return virtualRoot;
     }
 
-    AssetsIndex index;
-    if(!AssetsUtils::loadAssetsIndexJson(assetsId, indexPath, index))
+    auto index = loadAssetsIndex(assetsId);
+    if(!index)
     {
         qCritical() << "Failed to load asset index file" << indexPath << "; can't determine assets path!";
         return virtualRoot;
     }
 
     QString targetPath;
-    if(index.isVirtual)
+    if(index->isVirtual)
     {
         return virtualRoot;
     }
-    else if(index.mapToResources)
+    else if(index->mapToResources)
     {
         return QDir(resourcesFolder);
     }
@@ -203,6 +589,7 @@ QDir getAssetsDir(const QString &assetsId, const QString &resourcesFolder)
 // FIXME: ugly code duplication
 bool reconstructAssets(QString assetsId, QString resourcesFolder)
 {
+    Tracer::Scope scope("reconstructAssets", "launch");
     QDir assetsDir = QDir("assets/");
     QDir indexDir = QDir(FS::PathCombine(assetsDir.path(), "indexes"));
     QDir objectDir = QDir(FS::PathCombine(assetsDir.path(), "objects"));
@@ -220,8 +607,8 @@ bool reconstructAssets(QString assetsId, QString resourcesFolder)
 
     qDebug() << "reconstructAssets" << assetsDir.path() << indexDir.path() << objectDir.path() << virtualDir.path() << virtualRoot.path();
 
-    AssetsIndex index;
-    if(!AssetsUtils::loadAssetsIndexJson(assetsId, indexPath, index))
+    auto index = loadAssetsIndex(assetsId);
+    if(!index)
     {
         qCritical() << "Failed to load asset index file" << indexPath << "; can't reconstruct assets!";
         return false;
@@ -229,64 +616,137 @@ bool reconstructAssets(QString assetsId, QString resourcesFolder)
 
     QString targetPath;
     bool removeLeftovers = false;
-    if(index.isVirtual)
+    if(index->isVirtual)
     {
         targetPath = virtualRoot.path();
         removeLeftovers = true;
         qDebug() << "Reconstructing virtual assets folder at" << targetPath;
     }
-    else if(index.mapToResources)
+    else if(index->mapToResources)
     {
         targetPath = resourcesFolder;
         qDebug() << "Reconstructing resources folder at" << targetPath;
     }
 
-    if (!targetPath.isNull())
+    if (targetPath.isNull())
     {
-        auto presentFiles = collectPathsFromDir(targetPath);
-        for (QString map : index.objects.keys())
-        {
-            AssetObject asset_object = index.objects.value(map);
-            QString target_path = FS::PathCombine(targetPath, map);
-            QFile target(target_path);
+        return true;
+    }
 
-            QString tlk = asset_object.hash.left(2);
+    auto presentFiles = collectPathsFromDir(targetPath);
+    QList<AssetPlacement> placements;
+    QSet<QString> targetFolders;
+    int upToDate = 0;
+    for (int i = 0; i < index->size(); i++)
+    {
+        AssetObject asset_object = index->object(i);
+        QString target_path = QDir::cleanPath(FS::PathCombine(targetPath, index->name(i)));
+        QString original_path = FS::PathCombine(objectDir.path(), asset_object.hash.left(2), asset_object.hash);
 
-            QString original_path = FS::PathCombine(objectDir.path(), tlk, asset_object.hash);
-            QFile original(original_path);
-            if (!original.exists())
+        bool replace = false;
+        auto present = presentFiles.find(target_path);
+        if (present != presentFiles.end())
+        {
+            bool same = present.value() == asset_object.size;
+            presentFiles.erase(present);
+            // objects are never changed in place, a file of the right size is the right file. Files in the resources
+            // folder are left alone, whatever they are.
+            if (same || !index->isVirtual)
+            {
+                upToDate++;
                 continue;
+            }
+            replace = true;
+        }
+        // the virtual folder is ours and nothing changes the files in it, so they can share the data of the objects.
+        // the resources folder of old instances is the game's to do with as it likes, so it gets real copies.
+        placements.append({original_path, target_path, index->isVirtual, asset_object.hash, replace});
+    }
 
-            presentFiles.remove(target_path);
-
-            if (!target.exists())
+    if (!placements.isEmpty())
+    {
+        // the ledger knows which objects are there without looking at each of them. Missing ones are left out.
+        AssetsLedger ledger("assets/objects", "assets/ledger.dat");
+        ledger.load();
+        auto missing = ledger.check(*index);
+        ledger.save();
+        QList<AssetPlacement> available;
+        for (auto &placement: placements)
+        {
+            if (missing.contains(placement.hash))
             {
-                QFileInfo info(target_path);
-                QDir target_dir = info.dir();
-
-                qDebug() << target_dir.path();
-                FS::ensureFolderPathExists(target_dir.path());
-
-                bool couldCopy = original.copy(target_path);
-                qDebug() << " Copying" << original_path << "to" << target_path << QString::number(couldCopy);
+                continue;
             }
+            targetFolders.insert(QFileInfo(placement.target).path());
+            available.append(placement);
         }
+        placements = available;
+    }
 
-        // TODO: Write last used time to virtualRoot/.lastused
-        if(removeLeftovers)
+    for (auto &folder: targetFolders)
+    {
+        FS::ensureFolderPathExists(folder);
+    }
+
+    auto methods = QtConcurrent::blockingMapped<QList<FS::CloneMethod>>(placements, placeAsset);
+    QMap<FS::CloneMethod, int> counts;
+    for (auto method: methods)
+    {
+        counts[method]++;
+    }
+
+    int removed = 0;
+    if (removeLeftovers)
+    {
+        for (auto iter = presentFiles.begin(); iter != presentFiles.end(); iter++)
         {
-            for(auto & file: presentFiles)
+            if (QFile::remove(iter.key()))
             {
-                qDebug() << "Would remove" << file;
+                removed++;
+            }
+            else
+            {
+                qWarning() << "Could not remove leftover asset" << iter.key();
             }
         }
+        removeEmptyFolders(targetPath);
+    }
+
+    // TODO: Write last used time to virtualRoot/.lastused
+    qDebug() << "Assets" << assetsId << ":" << upToDate << "up to date," << counts[FS::CloneMethod::Reflink] << "cloned,"
+             << counts[FS::CloneMethod::Hardlink] << "linked," << counts[FS::CloneMethod::Copy] << "copied,"
+             << removed << "leftovers removed";
+    if (counts[FS::CloneMethod::Failed])
+    {
+        qCritical() << "Failed to place" << counts[FS::CloneMethod::Failed] << "assets into" << targetPath;
+        return false;
     }
     return true;
 }
 
+bool verifyObject(const AssetObject &object)
+{
+    QFile file(FS::PathCombine("assets/objects", object.hash.left(2), object.hash));
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        // missing, the normal check takes care of it
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    bool readAll = hash.addData(&file);
+    file.close();
+    if(readAll && file.size() == object.size && hash.result().toHex() == object.hash.toLower().toLatin1())
+    {
+        return true;
+    }
+    qWarning() << "Asset object" << object.hash << "is broken, removing it";
+    file.remove();
+    return false;
+}
+
 }
 
-NetAction::Ptr AssetObject::getDownloadAction()
+NetAction::Ptr AssetObject::getDownloadAction() const
 {
     QFileInfo objectFile(getLocalPath());
     if ((!objectFile.isFile()) || (objectFile.size() != size))
@@ -298,34 +758,50 @@ NetAction::Ptr AssetObject::getDownloadAction()
             objectDL->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, rawHash));
         }
         objectDL->m_total_progress = size;
+        objectDL->m_expected_size = size;
         return objectDL;
     }
     return nullptr;
 }
 
-QString AssetObject::getLocalPath()
+QString AssetObject::getLocalPath() const
 {
     return "assets/objects/" + getRelPath();
 }
 
-QUrl AssetObject::getUrl()
+QUrl AssetObject::getUrl() const
 {
     return BuildConfig.RESOURCE_BASE + getRelPath();
 }
 
-QString AssetObject::getRelPath()
+QString AssetObject::getRelPath() const
 {
     return hash.left(2) + "/" + hash;
 }
 
-NetJob::Ptr AssetsIndex::getDownloadJob()
+NetJob::Ptr AssetsIndex::getDownloadJob() const
 {
     auto job = new NetJob(QObject::tr("Assets for %1").arg(id), APPLICATION->network());
-    for (auto &object : objects.values())
+    // the few big files would otherwise trail behind the thousands of small ones
+    job->setSchedulingPolicy(NetJob::SchedulingPolicy::LargestFirst);
+    auto missing = findMissingObjects();
+    for (int i = 0; i < size(); i++)
     {
+        auto object = this->object(i);
+        // objects used under several names only need to be downloaded once
+        if(!missing.remove(object.hash))
+        {
+            continue;
+        }
         auto dl = object.getDownloadAction();
         if(dl)
         {
+            // the game starts fine without its sounds and music, get everything else first
+            auto name = this->name(i);
+            if(name.contains("sounds/") || name.contains("music/") || name.contains("records/"))
+            {
+                dl->m_priority = NetPriority::Background;
+            }
             job->addNetAction(dl);
         }
     }
@@ -333,3 +809,70 @@ NetJob::Ptr AssetsIndex::getDownloadJob()
         return job;
     return nullptr;
 }
+
+QSet<QString> AssetsIndex::findMissingObjects() const
+{
+    AssetsLedger ledger("assets/objects", "assets/ledger.dat");
+    ledger.load();
+    auto missing = ledger.check(*this);
+    ledger.save();
+    qDebug() << "Assets" << id << ":" << missing.size() << "missing objects, looked at" << ledger.checkedFiles()
+             << "files in" << ledger.checkedFolders() << "folders";
+    return missing;
+}
+
+QString AssetsIndex::name(int index) const
+{
+    auto &entry = m_entries[index];
+    auto fileName = m_names.mid(entry.nameOffset, entry.nameLength);
+    auto &folder = m_folders[entry.folder];
+    if(folder.isEmpty())
+    {
+        return fileName;
+    }
+    return folder + '/' + fileName;
+}
+
+AssetObject AssetsIndex::object(int index) const
+{
+    auto &entry = m_entries[index];
+    AssetObject object;
+    object.hash = QString::fromLatin1(QByteArray::fromRawData(reinterpret_cast<const char *>(entry.hash), 20).toHex());
+    object.size = entry.size;
+    return object;
+}
+
+bool AssetsIndex::addObject(const QString &name, const QByteArray &hash, qint64 size)
+{
+    Entry entry;
+    if(hash.size() != 40)
+    {
+        return false;
+    }
+    for(int i = 0; i < 20; i++)
+    {
+        auto high = hexValue(hash[2 * i]);
+        auto low = hexValue(hash[2 * i + 1]);
+        if(high < 0 || low < 0)
+        {
+            return false;
+        }
+        entry.hash[i] = quint8((high << 4) | low);
+    }
+    entry.size = size;
+
+    auto slash = name.lastIndexOf('/');
+    auto folder = slash < 0 ? QString() : name.left(slash);
+    auto folderIter = m_folder_ids.find(folder);
+    if(folderIter == m_folder_ids.end())
+    {
+        folderIter = m_folder_ids.insert(folder, quint32(m_folders.size()));
+        m_folders.append(folder);
+    }
+    entry.folder = folderIter.value();
+    entry.nameOffset = quint32(m_names.size());
+    entry.nameLength = quint32(name.size() - slash - 1);
+    m_names.append(name.midRef(slash + 1));
+    m_entries.append(entry);
+    return true;
+}
@@ -16,29 +16,65 @@
 #pragma once
 
 #include <QString>
-#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <memory>
 #include "net/NetAction.h"
 #include "net/NetJob.h"
 
 struct AssetObject
 {
-    QString getRelPath();
-    QUrl getUrl();
-    QString getLocalPath();
-    NetAction::Ptr getDownloadAction();
+    QString getRelPath() const;
+    QUrl getUrl() const;
+    QString getLocalPath() const;
+    NetAction::Ptr getDownloadAction() const;
 
     QString hash;
-    qint64 size;
+    qint64 size = 0;
 };
 
+/*
+ * Contents of an assets index (assets/indexes/<id>.json).
+ *
+ * Indexes list thousands of objects, so they are kept compact: hashes are packed into 20 bytes, the folders of the
+ * object names are stored once and the file names share one buffer.
+ */
 struct AssetsIndex
 {
-    NetJob::Ptr getDownloadJob();
+    NetJob::Ptr getDownloadJob() const;
+    /// hashes of the objects that need to be downloaded. Objects the ledger knows to be there are not looked at.
+    QSet<QString> findMissingObjects() const;
+
+    int size() const
+    {
+        return m_entries.size();
+    }
+    /// path of the object in the virtual assets or resources folder
+    QString name(int index) const;
+    AssetObject object(int index) const;
+
+    /// hash is the SHA-1 in hex. Returns false if it isn't one.
+    bool addObject(const QString &name, const QByteArray &hash, qint64 size);
 
     QString id;
-    QMap<QString, AssetObject> objects;
     bool isVirtual = false;
     bool mapToResources = false;
+
+private:
+    struct Entry
+    {
+        quint8 hash[20];
+        qint64 size;
+        quint32 folder;
+        quint32 nameOffset;
+        quint32 nameLength;
+    };
+    QVector<Entry> m_entries;
+    QStringList m_folders;
+    QHash<QString, quint32> m_folder_ids;
+    QString m_names;
 };
 
 /// FIXME: this is absolutely horrendous. REDO!!!!
@@ -46,8 +82,18 @@ namespace AssetsUtils
 {
 bool loadAssetsIndexJson(const QString &id, const QString &file, AssetsIndex& index);
 
+/// the index of the given id from assets/indexes. Reuses the last result as long as the file doesn't change.
+/// Returns nullptr if it can't be loaded.
+std::shared_ptr<const AssetsIndex> loadAssetsIndex(const QString &assetsId);
+
 QDir getAssetsDir(const QString &assetsId, const QString &resourcesFolder);
 
 /// Reconstruct a virtual assets folder for the given assets ID and return the folder
+/// Files are cloned or linked where possible, on the global thread pool, and leftovers in the virtual folder are removed.
+/// Blocks until done, so keep it off the GUI thread.
 bool reconstructAssets(QString assetsId, QString resourcesFolder);
+
+/// hash the object, and remove it if it doesn't match so it gets downloaded again. Returns true if it is intact.
+/// Safe to call from worker threads.
+bool verifyObject(const AssetObject &object);
 }
@@ -0,0 +1,152 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCryptographicHash>
+
+#include "TestUtil.h"
+
+#include "minecraft/AssetsUtils.h"
+#include "FileSystem.h"
+
+class AssetsUtilsTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+
+    QString writeIndex(const QString &name, const QByteArray &data)
+    {
+        auto path = FS::PathCombine(m_dir.path(), name);
+        QFile file(path);
+        file.open(QIODevice::WriteOnly);
+        file.write(data);
+        return path;
+    }
+
+    // shaped like the index of 1.20: a few thousand objects, most of them sounds
+    QByteArray makeBigIndex()
+    {
+        QJsonObject objects;
+        for(int i = 0; i < 4000; i++)
+        {
+            QString name;
+            if(i % 10 == 0)
+                name = QString("minecraft/lang/lang_%1.json").arg(i);
+            else
+                name = QString("minecraft/sounds/mob/creature_%1/say%2.ogg").arg(i / 8).arg(i % 8);
+            QJsonObject object;
+            object.insert("hash", QString(QCryptographicHash::hash(name.toUtf8(), QCryptographicHash::Sha1).toHex()));
+            object.insert("size", 1000 + i * 37);
+            objects.insert(name, object);
+        }
+        QJsonObject root;
+        root.insert("objects", objects);
+        return QJsonDocument(root).toJson();
+    }
+
+    // what loadAssetsIndexJson used to do
+    static QMap<QString, QPair<QString, qint64>> loadWithVariants(const QByteArray &data)
+    {
+        QMap<QString, QPair<QString, qint64>> out;
+        auto map = QJsonDocument::fromJson(data).object().value("objects").toVariant().toMap();
+        for(auto iter = map.begin(); iter != map.end(); iter++)
+        {
+            auto nested = iter.value().toMap();
+            out.insert(iter.key(), qMakePair(nested.value("hash").toString(), qint64(nested.value("size").toDouble())));
+        }
+        return out;
+    }
+
+private
+slots:
+    void test_parse()
+    {
+        auto path = writeIndex("small.json",
+            "{\n"
+            "  \"comment\": [1, 2.5e3, {\"nested\": [true, false, null]}, \"\\\"quoted\\\"\"],\n"
+            "  \"virtual\": true,\n"
+            "  \"objects\": {\n"
+            "    \"icons/icon_16x16.png\": {\"hash\": \"bdf48ef6b5d0d23bbb02e17d04865216179f510a\", \"size\": 3665},\n"
+            "    \"lang/caf\\u00e9 \\ud83d\\ude00.json\": {\"extra\": {}, \"size\": 12, \"hash\": \"BDF48EF6B5D0D23BBB02E17D04865216179F510B\"},\n"
+            "    \"pack.mcmeta\": {\"hash\": \"0000000000000000000000000000000000000001\", \"size\": 0}\n"
+            "  }\n"
+            "}\n");
+        AssetsIndex index;
+        QVERIFY(AssetsUtils::loadAssetsIndexJson("small", path, index));
+        QCOMPARE(index.id, QString("small"));
+        QVERIFY(index.isVirtual);
+        QVERIFY(!index.mapToResources);
+        QCOMPARE(index.size(), 3);
+        QCOMPARE(index.name(0), QString("icons/icon_16x16.png"));
+        QCOMPARE(index.object(0).hash, QString("bdf48ef6b5d0d23bbb02e17d04865216179f510a"));
+        QCOMPARE(index.object(0).size, qint64(3665));
+        QCOMPARE(index.name(1), QString::fromUtf8("lang/caf\xc3\xa9 \xf0\x9f\x98\x80.json"));
+        QCOMPARE(index.object(1).hash, QString("bdf48ef6b5d0d23bbb02e17d04865216179f510b"));
+        QCOMPARE(index.object(1).size, qint64(12));
+        QCOMPARE(index.name(2), QString("pack.mcmeta"));
+    }
+
+    void test_parseBroken_data()
+    {
+        QTest::addColumn<QByteArray>("data");
+        QTest::newRow("empty") << QByteArray();
+        QTest::newRow("cut short") << QByteArray("{\"objects\": {\"a\": {\"hash\": \"bdf48ef6b5d0d23bbb02e17d04865216179f510a\"");
+        QTest::newRow("bad hash") << QByteArray("{\"objects\": {\"a\": {\"hash\": \"not a hash\", \"size\": 1}}}");
+        QTest::newRow("trailing") << QByteArray("{\"objects\": {}} {}");
+        QTest::newRow("array") << QByteArray("[]");
+    }
+
+    void test_parseBroken()
+    {
+        QFETCH(QByteArray, data);
+        auto path = writeIndex("broken.json", data);
+        AssetsIndex index;
+        QVERIFY(!AssetsUtils::loadAssetsIndexJson("broken", path, index));
+    }
+
+    void test_sameAsJson()
+    {
+        auto data = makeBigIndex();
+        auto path = writeIndex("big.json", data);
+        AssetsIndex index;
+        QVERIFY(AssetsUtils::loadAssetsIndexJson("big", path, index));
+        auto expected = loadWithVariants(data);
+        QCOMPARE(index.size(), expected.size());
+        for(int i = 0; i < index.size(); i++)
+        {
+            auto name = index.name(i);
+            QVERIFY(expected.contains(name));
+            QCOMPARE(index.object(i).hash, expected[name].first);
+            QCOMPARE(index.object(i).size, expected[name].second);
+        }
+    }
+
+    void bench_loadWithVariants()
+    {
+        auto path = writeIndex("bench.json", makeBigIndex());
+        QBENCHMARK
+        {
+            QFile file(path);
+            file.open(QIODevice::ReadOnly);
+            auto objects = loadWithVariants(file.readAll());
+            QCOMPARE(objects.size(), 4000);
+        }
+    }
+
+    void bench_loadStreaming()
+    {
+        auto path = writeIndex("bench.json", makeBigIndex());
+        QBENCHMARK
+        {
+            AssetsIndex index;
+            QVERIFY(AssetsUtils::loadAssetsIndexJson("bench", path, index));
+            QCOMPARE(index.size(), 4000);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(AssetsUtilsTest)
+
+#include "AssetsUtils_test.moc"
@@ -0,0 +1,122 @@
+#include "ClassDataArchive.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#include "FileSystem.h"
+
+namespace {
+// bump this when the arguments used to record archives change, so old archives are recorded again
+const char *archiveVersion = "1";
+
+const char *archiveSuffix = ".jsa";
+
+QString recordingPath(const QString &archive)
+{
+    return archive + ".part";
+}
+
+void addFile(QCryptographicHash &key, const QFileInfo &info)
+{
+    key.addData(QString("%1 %2 %3\n")
+        .arg(info.absoluteFilePath())
+        .arg(info.size())
+        .arg(info.lastModified().toMSecsSinceEpoch()).toUtf8());
+}
+}
+
+namespace ClassDataArchive
+{
+
+bool isSupported(int javaMajor)
+{
+    // -XX:ArchiveClassesAtExit came with Java 13
+    return javaMajor >= 13;
+}
+
+QString key(const QString &java, const QStringList &files)
+{
+    QCryptographicHash key(QCryptographicHash::Sha1);
+    key.addData(archiveVersion);
+    key.addData(java.toUtf8());
+    key.addData("\n");
+    // the size and modification time tell whether a file changed, reading all of them would take longer than it saves
+    for(auto &file: files)
+    {
+        QFileInfo info(file);
+        if(!info.isDir())
+        {
+            addFile(key, info);
+            continue;
+        }
+        QStringList contents;
+        QDirIterator iter(file, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+        while(iter.hasNext())
+        {
+            contents.append(iter.next());
+        }
+        contents.sort();
+        for(auto &path: contents)
+        {
+            addFile(key, QFileInfo(path));
+        }
+    }
+    return QString::fromLatin1(key.result().toHex().left(20));
+}
+
+QString pathFor(const QString &folder, const QString &key)
+{
+    return FS::PathCombine(folder, key + archiveSuffix);
+}
+
+QStringList arguments(const QString &archive)
+{
+    if(exists(archive))
+    {
+        return {"-XX:SharedArchiveFile=" + archive};
+    }
+    // Java doesn't create the folder, it only complains about it when it exits
+    FS::ensureFilePathExists(archive);
+    return {"-XX:ArchiveClassesAtExit=" + recordingPath(archive)};
+}
+
+bool exists(const QString &archive)
+{
+    return QFileInfo(archive).isFile();
+}
+
+bool keep(const QString &archive)
+{
+    auto recording = recordingPath(archive);
+    if(!QFileInfo(recording).isFile())
+    {
+        return false;
+    }
+    QFileInfo info(archive);
+    for(auto &old: info.dir().entryInfoList({QString("*") + archiveSuffix}, QDir::Files))
+    {
+        if(!QFile::remove(old.absoluteFilePath()))
+        {
+            qWarning() << "Couldn't remove the outdated class data archive" << old.absoluteFilePath();
+        }
+    }
+    if(!QFile::rename(recording, archive))
+    {
+        qWarning() << "Couldn't move the class data archive to" << archive;
+        QFile::remove(recording);
+        return false;
+    }
+    return true;
+}
+
+void discard(const QString &archive)
+{
+    QFile::remove(recordingPath(archive));
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/*
+ * Class data sharing archives, recorded for each instance.
+ *
+ * Java 13 and newer can write the classes an application loaded to an archive when it exits, and map them from there
+ * on the next start instead of loading, verifying and parsing them again. An archive only fits the Java, classpath and
+ * mods it was recorded with, so it is named after a key made from those. When any of them changes, the key changes and
+ * a new archive is recorded, replacing the old one.
+ *
+ * Archives are recorded under a temporary name and only kept once the game ran successfully with them.
+ */
+namespace ClassDataArchive
+{
+/// whether Java with this major version can record and use the archives
+bool isSupported(int javaMajor);
+
+/// key for the Java and the files classes are loaded from. Folders stand for all the files in them.
+QString key(const QString &java, const QStringList &files);
+
+/// the archive for the key, in the folder
+QString pathFor(const QString &folder, const QString &key);
+
+/// Java arguments that use the archive if it exists and record it otherwise
+QStringList arguments(const QString &archive);
+
+/// whether the archive exists, rather than being recorded by the launch
+bool exists(const QString &archive);
+
+/// keep the archive recorded by a successful launch and remove the ones that don't fit anymore. Returns false if nothing was recorded.
+bool keep(const QString &archive);
+
+/// throw away what a launch that didn't go well recorded
+void discard(const QString &archive);
+}
@@ -0,0 +1,97 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+
+#include "TestUtil.h"
+
+#include "minecraft/ClassDataArchive.h"
+#include "FileSystem.h"
+
+class ClassDataArchiveTest : public QObject
+{
+    Q_OBJECT
+
+    static void writeFile(const QString &path, const QByteArray &content)
+    {
+        QVERIFY(FS::ensureFilePathExists(path));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    }
+
+private
+slots:
+    void test_supported()
+    {
+        QVERIFY(!ClassDataArchive::isSupported(8));
+        QVERIFY(!ClassDataArchive::isSupported(11));
+        QVERIFY(ClassDataArchive::isSupported(17));
+    }
+
+    void test_key()
+    {
+        QTemporaryDir dir;
+        auto jar = FS::PathCombine(dir.path(), "libraries", "a.jar");
+        auto mods = FS::PathCombine(dir.path(), "mods");
+        writeFile(jar, "aaaa");
+        writeFile(FS::PathCombine(mods, "first.jar"), "1");
+
+        auto key = ClassDataArchive::key("java 17", {jar, mods});
+        QCOMPARE(ClassDataArchive::key("java 17", {jar, mods}), key);
+        QVERIFY(ClassDataArchive::key("java 21", {jar, mods}) != key);
+        QVERIFY(ClassDataArchive::key("java 17", {mods, jar}) != key);
+
+        // a changed jar
+        writeFile(jar, "aaaaaaaa");
+        auto changedJar = ClassDataArchive::key("java 17", {jar, mods});
+        QVERIFY(changedJar != key);
+
+        // another mod, also in a subfolder
+        writeFile(FS::PathCombine(mods, "1.20.1", "second.jar"), "2");
+        QVERIFY(ClassDataArchive::key("java 17", {jar, mods}) != changedJar);
+    }
+
+    void test_recordAndKeep()
+    {
+        QTemporaryDir dir;
+        auto folder = FS::PathCombine(dir.path(), "cds");
+        auto old = ClassDataArchive::pathFor(folder, "old");
+        writeFile(old, "old");
+
+        auto archive = ClassDataArchive::pathFor(folder, "new");
+        QVERIFY(!ClassDataArchive::exists(archive));
+        auto args = ClassDataArchive::arguments(archive);
+        QCOMPARE(args.size(), 1);
+        QVERIFY(args[0].startsWith("-XX:ArchiveClassesAtExit="));
+
+        // nothing was recorded, the old archive stays
+        QVERIFY(!ClassDataArchive::keep(archive));
+        QVERIFY(ClassDataArchive::exists(old));
+
+        // what Java does when it exits
+        writeFile(args[0].section('=', 1), "classes");
+        QVERIFY(ClassDataArchive::keep(archive));
+        QVERIFY(ClassDataArchive::exists(archive));
+        QVERIFY(!ClassDataArchive::exists(old));
+        QCOMPARE(QDir(folder).entryList(QDir::Files), QStringList({"new.jsa"}));
+
+        args = ClassDataArchive::arguments(archive);
+        QCOMPARE(args, QStringList({"-XX:SharedArchiveFile=" + archive}));
+    }
+
+    void test_discard()
+    {
+        QTemporaryDir dir;
+        auto archive = ClassDataArchive::pathFor(dir.path(), "key");
+        auto args = ClassDataArchive::arguments(archive);
+        writeFile(args[0].section('=', 1), "half done");
+        ClassDataArchive::discard(archive);
+        QVERIFY(!ClassDataArchive::keep(archive));
+        QVERIFY(QDir(dir.path()).entryList(QDir::Files).isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(ClassDataArchiveTest)
+
+#include "ClassDataArchive_test.moc"
@@ -11,9 +11,13 @@ void LaunchProfile::clear()
     m_mainClass.clear();
     m_appletClass.clear();
     m_libraries.clear();
+    m_nativeLibraries.clear();
+    m_libraryIndex.clear();
+    m_nativeLibraryIndex.clear();
     m_mavenFiles.clear();
     m_traits.clear();
     m_jarMods.clear();
+    m_mods.clear();
     m_mainJar.reset();
     m_problemSeverity = ProblemSeverity::None;
 }
@@ -126,6 +130,12 @@ void LaunchProfile::applyMods(const QList<LibraryPtr>& mods)
     }
 }
 
+static QString libraryKey(const GradleSpecifier &name)
+{
+    // everything matchName() looks at
+    return name.artifactPrefix() + ':' + name.classifier();
+}
+
 void LaunchProfile::applyLibrary(LibraryPtr library)
 {
     if(!library->isActive())
@@ -134,18 +144,22 @@ void LaunchProfile::applyLibrary(LibraryPtr library)
     }
 
     QList<LibraryPtr> * list = &m_libraries;
+    QHash<QString, int> * listIndex = &m_libraryIndex;
     if(library->isNative())
     {
         list = &m_nativeLibraries;
+        listIndex = &m_nativeLibraryIndex;
     }
 
     auto libraryCopy = Library::limitedCopy(library);
 
-    // find the library by name.
-    const int index = findLibraryByName(list, library->rawName());
+    // find the library by name. Libraries are only added when no other has the name, so there is at most one.
+    const auto key = libraryKey(library->rawName());
+    const int index = listIndex->value(key, -1);
     // library not found? just add it.
     if (index < 0)
     {
+        listIndex->insert(key, list->size());
         list->append(libraryCopy);
         return;
     }
@@ -260,6 +274,11 @@ const QList<LibraryPtr> & LaunchProfile::getJarMods() const
     return m_jarMods;
 }
 
+const QList<LibraryPtr> & LaunchProfile::getMods() const
+{
+    return m_mods;
+}
+
 const QList<LibraryPtr> & LaunchProfile::getLibraries() const
 {
     return m_libraries;
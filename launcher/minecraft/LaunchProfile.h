@@ -1,5 +1,6 @@
 #pragma once
 #include <QString>
+#include <QHash>
 #include "Library.h"
 #include <ProblemProvider.h>
 #include <sys.h>
@@ -37,6 +38,7 @@ public: /* getters for profile variables */
     const QSet<QString> & getTraits() const;
     const QStringList & getTweakers() const;
     const QList<LibraryPtr> & getJarMods() const;
+    const QList<LibraryPtr> & getMods() const;
     const QList<LibraryPtr> & getLibraries() const;
     const QList<LibraryPtr> & getNativeLibraries() const;
     const QList<LibraryPtr> & getMavenFiles() const;
@@ -91,6 +93,10 @@ private:
     /// the list of native libraries
     QList<LibraryPtr> m_nativeLibraries;
 
+    /// positions in m_libraries and m_nativeLibraries, by group, artifact and classifier
+    QHash<QString, int> m_libraryIndex;
+    QHash<QString, int> m_nativeLibraryIndex;
+
     /// traits, collected from all the version files (version files can only add)
     QSet<QString> m_traits;
 
@@ -0,0 +1,98 @@
+#include "LaunchProfileCache.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+#include "LaunchProfile.h"
+#include "VersionFile.h"
+#include "OneSixVersionFormat.h"
+#include "FileSystem.h"
+
+namespace {
+// bump this when what goes into a profile changes, so old ones aren't used anymore
+const int cacheVersion = 1;
+
+VersionFilePtr toVersionFile(const LaunchProfile &profile)
+{
+    auto file = std::make_shared<VersionFile>();
+    // only Minecraft itself may set the version, its type and the assets
+    file->uid = "net.minecraft";
+    file->version = profile.getMinecraftVersion();
+    file->type = profile.getMinecraftVersionType();
+    auto assets = profile.getMinecraftAssets();
+    file->assets = assets->id;
+    file->mojangAssetIndex = assets;
+    file->mainClass = profile.getMainClass();
+    file->appletClass = profile.getAppletClass();
+    file->minecraftArguments = profile.getMinecraftArguments();
+    file->addTweakers = profile.getTweakers();
+    file->traits = profile.getTraits();
+    file->mainJar = profile.getMainJar();
+    file->jarMods = profile.getJarMods();
+    file->mods = profile.getMods();
+    // natives are told apart from the rest again when they are applied
+    file->libraries = profile.getLibraries() + profile.getNativeLibraries();
+    file->mavenFiles = profile.getMavenFiles();
+    return file;
+}
+}
+
+namespace LaunchProfileCache
+{
+
+std::shared_ptr<LaunchProfile> load(const QString &path, const QByteArray &key)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return nullptr;
+    }
+    auto root = QJsonDocument::fromJson(file.readAll()).object();
+    if(root.value("cacheVersion").toInt() != cacheVersion || root.value("key").toString().toLatin1() != key)
+    {
+        return nullptr;
+    }
+    try
+    {
+        auto versionFile = OneSixVersionFormat::versionFileFromJson(QJsonDocument(root.value("profile").toObject()), path, false);
+        if(versionFile->getProblemSeverity() != ProblemSeverity::None)
+        {
+            return nullptr;
+        }
+        auto profile = std::make_shared<LaunchProfile>();
+        versionFile->applyTo(profile.get());
+        return profile;
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << "Couldn't read cached launch profile" << path << ":" << e.cause();
+        return nullptr;
+    }
+}
+
+bool save(const QString &path, const QByteArray &key, const LaunchProfile &profile)
+{
+    if(profile.getProblemSeverity() != ProblemSeverity::None)
+    {
+        QFile::remove(path);
+        return false;
+    }
+    QJsonObject root;
+    root.insert("cacheVersion", cacheVersion);
+    root.insert("key", QString::fromLatin1(key));
+    root.insert("profile", OneSixVersionFormat::versionFileToJson(toVersionFile(profile)).object());
+    try
+    {
+        FS::write(path, QJsonDocument(root).toJson(QJsonDocument::Compact));
+        return true;
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << e.what();
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <memory>
+
+class LaunchProfile;
+
+/*
+ * A resolved launch profile, kept in a file so it doesn't have to be put together from all the components again.
+ *
+ * The profile is stored as a single version file, which gives back the same profile when applied to an empty one. The
+ * key says what the profile was made from, a stored profile is only used if the key is the same.
+ */
+namespace LaunchProfileCache
+{
+/// the profile stored under the key, nullptr if there is none or it can't be read
+std::shared_ptr<LaunchProfile> load(const QString &path, const QByteArray &key);
+
+/// store the profile under the key. Profiles with problems are not stored.
+bool save(const QString &path, const QByteArray &key, const LaunchProfile &profile);
+}
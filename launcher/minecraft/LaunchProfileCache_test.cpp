@@ -0,0 +1,120 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+
+#include "TestUtil.h"
+
+#include "minecraft/LaunchProfile.h"
+#include "minecraft/LaunchProfileCache.h"
+#include "minecraft/OneSixVersionFormat.h"
+#include "minecraft/VersionFile.h"
+#include "minecraft/OpSys.h"
+#include "FileSystem.h"
+
+class LaunchProfileCacheTest : public QObject
+{
+    Q_OBJECT
+
+    static VersionFilePtr versionFile(const QByteArray &json)
+    {
+        return OneSixVersionFormat::versionFileFromJson(QJsonDocument::fromJson(json), "test.json", false);
+    }
+
+    static QStringList names(const QList<LibraryPtr> &libraries)
+    {
+        QStringList out;
+        for(auto &library: libraries)
+        {
+            out.append(library->rawName().serialize());
+        }
+        return out;
+    }
+
+    std::shared_ptr<LaunchProfile> makeProfile()
+    {
+        auto profile = std::make_shared<LaunchProfile>();
+        versionFile(
+            "{\"formatVersion\": 1, \"uid\": \"net.minecraft\", \"version\": \"1.12.2\", \"type\": \"release\","
+            " \"mainClass\": \"net.minecraft.client.main.Main\","
+            " \"minecraftArguments\": \"--username ${auth_player_name}\","
+            " \"assetIndex\": {\"id\": \"1.12\", \"sha1\": \"1584b57c1d0b7e8d3ad6e8ad2c6a4f4a5a1fd1e2\", \"size\": 169014,"
+            "   \"totalSize\": 127037390, \"url\": \"https://example.com/1.12.json\"},"
+            " \"+traits\": [\"texturepacks\"],"
+            " \"mainJar\": {\"name\": \"com.mojang:minecraft:1.12.2:client\"},"
+            " \"libraries\": ["
+            "   {\"name\": \"com.mojang:patchy:1.1\"},"
+            "   {\"name\": \"org.lwjgl.lwjgl:lwjgl-platform:2.9.4\", \"natives\": {\"linux\": \"natives-linux\","
+            "     \"osx\": \"natives-osx\", \"windows\": \"natives-windows\"}, \"extract\": {\"exclude\": [\"META-INF/\"]}},"
+            "   {\"name\": \"org.ow2.asm:asm:5.0.3\"}"
+            " ]}")->applyTo(profile.get());
+        versionFile(
+            "{\"formatVersion\": 1, \"uid\": \"net.minecraftforge\", \"version\": \"14.23.5.2855\","
+            " \"mainClass\": \"net.minecraft.launchwrapper.Launch\","
+            " \"+tweakers\": [\"net.minecraftforge.fml.common.launcher.FMLTweaker\"],"
+            " \"libraries\": ["
+            "   {\"name\": \"net.minecraft:launchwrapper:1.12\"},"
+            "   {\"name\": \"org.ow2.asm:asm:5.2\"},"
+            "   {\"name\": \"org.ow2.asm:asm:4.1\"}"
+            " ],"
+            " \"jarMods\": [{\"name\": \"org.multimc.jarmods:1234:1\", \"MMC-hint\": \"local\", \"MMC-filename\": \"1234.jar\","
+            "   \"MMC-displayname\": \"OptiFine\"}]"
+            "}")->applyTo(profile.get());
+        return profile;
+    }
+
+private
+slots:
+    void test_applyLibrary()
+    {
+        auto profile = makeProfile();
+        // newer versions replace the old one where it is, older ones are ignored
+        QCOMPARE(names(profile->getLibraries()), QStringList({
+            "com.mojang:patchy:1.1",
+            "org.ow2.asm:asm:5.2",
+            "net.minecraft:launchwrapper:1.12"
+        }));
+        QCOMPARE(names(profile->getNativeLibraries()), QStringList({"org.lwjgl.lwjgl:lwjgl-platform:2.9.4"}));
+    }
+
+    void test_roundTrip()
+    {
+        QTemporaryDir dir;
+        auto path = FS::PathCombine(dir.path(), "launch-profile.json");
+        auto original = makeProfile();
+        QVERIFY(LaunchProfileCache::save(path, "somekey", *original));
+
+        QVERIFY(!LaunchProfileCache::load(path, "otherkey"));
+        auto cached = LaunchProfileCache::load(path, "somekey");
+        QVERIFY(cached);
+        QCOMPARE(cached->getMinecraftVersion(), original->getMinecraftVersion());
+        QCOMPARE(cached->getMinecraftVersionType(), original->getMinecraftVersionType());
+        QCOMPARE(cached->getMainClass(), QString("net.minecraft.launchwrapper.Launch"));
+        QCOMPARE(cached->getAppletClass(), original->getAppletClass());
+        QCOMPARE(cached->getMinecraftArguments(), original->getMinecraftArguments());
+        QCOMPARE(cached->getTweakers(), original->getTweakers());
+        QCOMPARE(cached->getTraits(), original->getTraits());
+        QCOMPARE(cached->getMinecraftAssets()->id, QString("1.12"));
+        QCOMPARE(cached->getMinecraftAssets()->sha1, original->getMinecraftAssets()->sha1);
+        QCOMPARE(cached->getMainJar()->rawName().serialize(), original->getMainJar()->rawName().serialize());
+        QCOMPARE(names(cached->getLibraries()), names(original->getLibraries()));
+        QCOMPARE(names(cached->getNativeLibraries()), names(original->getNativeLibraries()));
+        QVERIFY(cached->getNativeLibraries()[0]->isNative());
+        QCOMPARE(cached->getJarMods().size(), 1);
+        QCOMPARE(cached->getJarMods()[0]->displayName(currentSystem), QString("OptiFine"));
+        QCOMPARE(cached->getJarMods()[0]->filename(currentSystem), QString("1234.jar"));
+    }
+
+    void test_problemsAreNotCached()
+    {
+        QTemporaryDir dir;
+        auto path = FS::PathCombine(dir.path(), "launch-profile.json");
+        auto profile = makeProfile();
+        profile->applyProblemSeverity(ProblemSeverity::Error);
+        QVERIFY(!LaunchProfileCache::save(path, "somekey", *profile));
+        QVERIFY(!LaunchProfileCache::load(path, "somekey"));
+    }
+};
+
+QTEST_GUILESS_MAIN(LaunchProfileCacheTest)
+
+#include "LaunchProfileCache_test.moc"
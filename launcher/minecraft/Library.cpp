@@ -69,7 +69,8 @@ QList<NetAction::Ptr> Library::getDownloads(
         return true;
     };
 
-    auto add_download = [&](QString storage, QString url, QString sha1)
+    // size is what the metadata says, -1 if it doesn't
+    auto add_download = [&](QString storage, QString url, QString sha1, qint64 size)
     {
         if(local)
         {
@@ -88,19 +89,19 @@ QList<NetAction::Ptr> Library::getDownloads(
             options |= Net::Download::Option::AcceptLocalFiles;
         }
 
+        auto dl = Net::Download::makeCached(url, entry, options);
+        dl->m_expected_size = size;
         if(sha1.size())
         {
             auto rawSha1 = QByteArray::fromHex(sha1.toLatin1());
-            auto dl = Net::Download::makeCached(url, entry, options);
             dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, rawSha1));
             qDebug() << "Checksummed Download for:" << rawName().serialize() << "storage:" << storage << "url:" << url;
-            out.append(dl);
         }
         else
         {
-            out.append(Net::Download::makeCached(url, entry, options));
             qDebug() << "Download for:" << rawName().serialize() << "storage:" << storage << "url:" << url;
         }
+        out.append(dl);
         return true;
     };
 
@@ -123,14 +124,14 @@ QList<NetAction::Ptr> Library::getDownloads(
                     {
                         auto cooked_storage = raw_storage;
                         cooked_storage.replace("${arch}", "32");
-                        add_download(cooked_storage, nat32info->url, nat32info->sha1);
+                        add_download(cooked_storage, nat32info->url, nat32info->sha1, nat32info->size);
                     }
                     auto nat64info = m_mojangDownloads->getDownloadInfo(nat64Classifier);
                     if(nat64info)
                     {
                         auto cooked_storage = raw_storage;
                         cooked_storage.replace("${arch}", "64");
-                        add_download(cooked_storage, nat64info->url, nat64info->sha1);
+                        add_download(cooked_storage, nat64info->url, nat64info->sha1, nat64info->size);
                     }
                 }
                 else
@@ -138,7 +139,7 @@ QList<NetAction::Ptr> Library::getDownloads(
                     auto info = m_mojangDownloads->getDownloadInfo(nativeClassifier);
                     if(info)
                     {
-                        add_download(raw_storage, info->url, info->sha1);
+                        add_download(raw_storage, info->url, info->sha1, info->size);
                     }
                 }
             }
@@ -152,7 +153,7 @@ QList<NetAction::Ptr> Library::getDownloads(
             if(m_mojangDownloads->artifact)
             {
                 auto artifact = m_mojangDownloads->artifact;
-                add_download(raw_storage, artifact->url, artifact->sha1);
+                add_download(raw_storage, artifact->url, artifact->sha1, artifact->size);
             }
             else
             {
@@ -187,19 +188,35 @@ QList<NetAction::Ptr> Library::getDownloads(
         {
             QString cooked_storage = raw_storage;
             QString cooked_dl = raw_dl;
-            add_download(cooked_storage.replace("${arch}", "32"), cooked_dl.replace("${arch}", "32"), QString());
+            add_download(cooked_storage.replace("${arch}", "32"), cooked_dl.replace("${arch}", "32"), QString(), -1);
             cooked_storage = raw_storage;
             cooked_dl = raw_dl;
-            add_download(cooked_storage.replace("${arch}", "64"), cooked_dl.replace("${arch}", "64"), QString());
+            add_download(cooked_storage.replace("${arch}", "64"), cooked_dl.replace("${arch}", "64"), QString(), -1);
         }
         else
         {
-            add_download(raw_storage, raw_dl, QString());
+            add_download(raw_storage, raw_dl, QString(), -1);
         }
     }
     return out;
 }
 
+QStringList Library::getCachePaths(OpSys system) const
+{
+    if(isLocal())
+    {
+        return {};
+    }
+    QString raw_storage = storageSuffix(system);
+    if (raw_storage.contains("${arch}"))
+    {
+        QString storage32 = raw_storage;
+        QString storage64 = raw_storage;
+        return {storage32.replace("${arch}", "32"), storage64.replace("${arch}", "64")};
+    }
+    return {raw_storage};
+}
+
 bool Library::isActive() const
 {
     bool result = true;
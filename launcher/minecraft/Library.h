@@ -155,6 +155,9 @@ public: /* methods */
     QList<NetAction::Ptr> getDownloads(OpSys system, class HttpMetaCache * cache,
                                      QStringList & failedLocalFiles, const QString & overridePath) const;
 
+    // Get the paths within the 'libraries' cache base that getDownloads() will look at
+    QStringList getCachePaths(OpSys system) const;
+
 private: /* methods */
     /// the default storage prefix used by MultiMC
     static QString defaultStoragePrefix();
@@ -0,0 +1,300 @@
+#include "LogClassifier.h"
+
+namespace {
+inline bool isDigit(ushort c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// [a-zA-Z\d_$]
+inline bool isWordChar(ushort c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || isDigit(c) || c == '_' || c == '$';
+}
+
+// [a-zA-Z_$]
+inline bool isIdentifierStart(ushort c)
+{
+    return isWordChar(c) && !isDigit(c);
+}
+
+// \s, without unicode properties
+inline bool isSpace(ushort c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+class Line
+{
+public:
+    explicit Line(const QString &line) : m_data(line.utf16()), m_length(line.size())
+    {
+    }
+
+    int length() const
+    {
+        return m_length;
+    }
+
+    ushort operator[](int pos) const
+    {
+        return m_data[pos];
+    }
+
+    template<int N>
+    bool startsWith(int pos, const char (&text)[N]) const
+    {
+        if(pos < 0 || pos + N - 1 > m_length)
+        {
+            return false;
+        }
+        for(int i = 0; i < N - 1; i++)
+        {
+            if(m_data[pos + i] != ushort(text[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<int N>
+    bool equals(int pos, int length, const char (&text)[N]) const
+    {
+        return length == N - 1 && startsWith(pos, text);
+    }
+
+private:
+    const ushort *m_data;
+    int m_length;
+};
+
+// '([a-zA-Z_$][a-zA-Z\d_$]*\.)+[a-zA-Z_$][a-zA-Z\d_$]*' starts here
+bool javaSymbolAt(const Line &line, int pos)
+{
+    if(pos >= line.length() || !isIdentifierStart(line[pos]))
+    {
+        return false;
+    }
+    int i = pos + 1;
+    while(i < line.length() && isWordChar(line[i]))
+    {
+        i++;
+    }
+    return i + 1 < line.length() && line[i] == '.' && isIdentifierStart(line[i + 1]);
+}
+
+// '\[(?<timestamp>[0-9:]+)\] \[[^/]+/(?<level>[^\]]+)\]' starts here, at a '['
+bool log4jAt(const Line &line, int pos, int &timestampEnd, int &levelStart, int &levelEnd)
+{
+    int i = pos + 1;
+    while(i < line.length() && (isDigit(line[i]) || line[i] == ':'))
+    {
+        i++;
+    }
+    if(i == pos + 1 || !line.startsWith(i, "] ["))
+    {
+        return false;
+    }
+    int thread = i + 3;
+    int slash = thread;
+    while(slash < line.length() && line[slash] != '/')
+    {
+        slash++;
+    }
+    if(slash == thread || slash == line.length())
+    {
+        return false;
+    }
+    int end = slash + 1;
+    while(end < line.length() && line[end] != ']')
+    {
+        end++;
+    }
+    if(end == slash + 1 || end == line.length())
+    {
+        return false;
+    }
+    timestampEnd = i;
+    levelStart = slash + 1;
+    levelEnd = end;
+    return true;
+}
+
+// the word after a '.' has 'Exception', 'Error' or 'Throwable' in it
+bool throwableAfter(const Line &line, int dot)
+{
+    for(int i = dot + 1; i < line.length() && isWordChar(line[i]); i++)
+    {
+        if(line.startsWith(i, "Exception") || line.startsWith(i, "Error") || line.startsWith(i, "Throwable"))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// '... \d+ more' ends here
+bool moreEndsAt(const Line &line, int end)
+{
+    int digitsEnd = end - 5;
+    if(!line.startsWith(digitsEnd, " more"))
+    {
+        return false;
+    }
+    int digits = digitsEnd;
+    while(digits > 0 && isDigit(line[digits - 1]))
+    {
+        digits--;
+    }
+    int space = digits - 1;
+    if(digits == digitsEnd || space < 3 || line[space] != ' ')
+    {
+        return false;
+    }
+    // '.' doesn't match line breaks
+    for(int i = space - 3; i < space; i++)
+    {
+        if(line[i] == '\n')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// tags of old Forge logs, in the order they used to be looked for. Later ones win.
+enum OldTag
+{
+    OldInfo = 1,
+    OldError = 2,
+    OldWarning = 4,
+    OldDebug = 8
+};
+
+int oldTagAt(const Line &line, int pos)
+{
+    pos++;
+    if(line.startsWith(pos, "INFO]") || line.startsWith(pos, "CONFIG]") || line.startsWith(pos, "FINE]") ||
+        line.startsWith(pos, "FINER]") || line.startsWith(pos, "FINEST]"))
+        return OldInfo;
+    if(line.startsWith(pos, "SEVERE]") || line.startsWith(pos, "STDERR]"))
+        return OldError;
+    if(line.startsWith(pos, "WARNING]"))
+        return OldWarning;
+    if(line.startsWith(pos, "DEBUG]"))
+        return OldDebug;
+    return 0;
+}
+}
+
+namespace LogClassifier
+{
+
+Classification classify(const QString &text, MessageLevel::Enum level)
+{
+    Classification out;
+    Line line(text);
+    int levelStart = -1;
+    int levelEnd = -1;
+    int oldTags = 0;
+    bool overwriting = false;
+    // the run of word characters before the current position has a character that can start an identifier
+    bool identifierBefore = false;
+
+    for(int i = 0; i < line.length(); i++)
+    {
+        auto c = line[i];
+        if(isWordChar(c))
+        {
+            identifierBefore |= isIdentifierStart(c);
+        }
+        else
+        {
+            if(c == '.' && identifierBefore && !out.exception)
+            {
+                out.exception = throwableAfter(line, i);
+            }
+            identifierBefore = false;
+        }
+
+        switch(c)
+        {
+            case '[':
+            {
+                int timestampEnd;
+                if(out.timestampStart < 0 && log4jAt(line, i, timestampEnd, levelStart, levelEnd))
+                {
+                    out.timestampStart = i + 1;
+                    out.timestampLength = timestampEnd - i - 1;
+                }
+                oldTags |= oldTagAt(line, i);
+                break;
+            }
+            case 'C':
+                if(!out.exception && line.startsWith(i, "Caused by: "))
+                {
+                    out.exception = javaSymbolAt(line, i + 11);
+                }
+                break;
+            case 'E':
+                if(!out.exception)
+                {
+                    out.exception = line.startsWith(i, "Exception in thread");
+                }
+                break;
+            case 'o':
+                overwriting |= line.startsWith(i, "overwriting existing");
+                break;
+            default:
+                if(isSpace(c) && !out.exception && line.startsWith(i + 1, "at "))
+                {
+                    out.exception = javaSymbolAt(line, i + 4);
+                }
+                break;
+        }
+    }
+    if(!out.exception)
+    {
+        // '$' also matches before a line break at the end
+        int end = line.length();
+        out.exception = moreEndsAt(line, end) || (end > 0 && line[end - 1] == '\n' && moreEndsAt(line, end - 1));
+    }
+
+    if(out.timestampStart >= 0)
+    {
+        // New style logs from log4j
+        int length = levelEnd - levelStart;
+        if(line.equals(levelStart, length, "INFO"))
+            level = MessageLevel::Message;
+        else if(line.equals(levelStart, length, "WARN"))
+            level = MessageLevel::Warning;
+        else if(line.equals(levelStart, length, "ERROR"))
+            level = MessageLevel::Error;
+        else if(line.equals(levelStart, length, "FATAL"))
+            level = MessageLevel::Fatal;
+        else if(line.equals(levelStart, length, "TRACE") || line.equals(levelStart, length, "DEBUG"))
+            level = MessageLevel::Debug;
+    }
+    else if(oldTags)
+    {
+        // Old style forge logs
+        if(oldTags & OldDebug)
+            level = MessageLevel::Debug;
+        else if(oldTags & OldWarning)
+            level = MessageLevel::Warning;
+        else if(oldTags & OldError)
+            level = MessageLevel::Error;
+        else
+            level = MessageLevel::Message;
+    }
+
+    if(overwriting)
+        level = MessageLevel::Fatal;
+    else if(out.exception)
+        level = MessageLevel::Error;
+    out.level = level;
+    return out;
+}
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QString>
+#include "MessageLevel.h"
+
+/*
+ * Tells the level of a line of game output, for every line the game prints.
+ *
+ * Looks at the line once, for the log4j level and timestamp, the tags of old Forge logs and the signs of Java
+ * exceptions and stack traces. Gives the same levels as the regular expressions used before.
+ */
+namespace LogClassifier
+{
+struct Classification
+{
+    /// the level of the line, or the level it was given when the line doesn't tell
+    MessageLevel::Enum level = MessageLevel::Unknown;
+    /// where the log4j timestamp is in the line, -1 if it isn't a log4j line
+    int timestampStart = -1;
+    int timestampLength = 0;
+    /// part of a Java exception or stack trace
+    bool exception = false;
+};
+
+Classification classify(const QString &line, MessageLevel::Enum level);
+}
@@ -0,0 +1,161 @@
+#include <QTest>
+#include <QRegularExpression>
+
+#include "TestUtil.h"
+
+#include "minecraft/LogClassifier.h"
+
+class LogClassifierTest : public QObject
+{
+    Q_OBJECT
+
+    QStringList m_lines;
+
+    // what MinecraftInstance::guessLevel used to do
+    static MessageLevel::Enum guessLevelWithRegex(const QString &line, MessageLevel::Enum level)
+    {
+        QRegularExpression re("\\[(?<timestamp>[0-9:]+)\\] \\[[^/]+/(?<level>[^\\]]+)\\]");
+        auto match = re.match(line);
+        if(match.hasMatch())
+        {
+            QString levelStr = match.captured("level");
+            if(levelStr == "INFO")
+                level = MessageLevel::Message;
+            if(levelStr == "WARN")
+                level = MessageLevel::Warning;
+            if(levelStr == "ERROR")
+                level = MessageLevel::Error;
+            if(levelStr == "FATAL")
+                level = MessageLevel::Fatal;
+            if(levelStr == "TRACE" || levelStr == "DEBUG")
+                level = MessageLevel::Debug;
+        }
+        else
+        {
+            if (line.contains("[INFO]") || line.contains("[CONFIG]") || line.contains("[FINE]") ||
+                    line.contains("[FINER]") || line.contains("[FINEST]"))
+                level = MessageLevel::Message;
+            if (line.contains("[SEVERE]") || line.contains("[STDERR]"))
+                level = MessageLevel::Error;
+            if (line.contains("[WARNING]"))
+                level = MessageLevel::Warning;
+            if (line.contains("[DEBUG]"))
+                level = MessageLevel::Debug;
+        }
+        if (line.contains("overwriting existing"))
+            return MessageLevel::Fatal;
+        static const QString javaSymbol = "([a-zA-Z_$][a-zA-Z\\d_$]*\\.)+[a-zA-Z_$][a-zA-Z\\d_$]*";
+        if (line.contains("Exception in thread")
+            || line.contains(QRegularExpression("\\s+at " + javaSymbol))
+            || line.contains(QRegularExpression("Caused by: " + javaSymbol))
+            || line.contains(QRegularExpression("([a-zA-Z_$][a-zA-Z\\d_$]*\\.)+[a-zA-Z_$]?[a-zA-Z\\d_$]*(Exception|Error|Throwable)"))
+            || line.contains(QRegularExpression("... \\d+ more$"))
+            )
+            return MessageLevel::Error;
+        return level;
+    }
+
+private
+slots:
+    void initTestCase()
+    {
+        // a game log with the parts of old Forge, Forge 1.12 and Fabric 1.20 logs, stack traces included
+        m_lines = QString::fromUtf8(GET_TEST_FILE("testdata/LogClassifier/latest.log")).split('\n');
+        QVERIFY(m_lines.size() > 50);
+    }
+
+    void test_sameAsRegex_data()
+    {
+        QTest::addColumn<QString>("line");
+        QTest::newRow("empty") << "";
+        QTest::newRow("log4j") << "[12:01:48] [Render thread/INFO]: Setting user: Steve";
+        QTest::newRow("log4j unknown level") << "[12:01:48] [Render thread/NOTICE]: hi";
+        QTest::newRow("log4j level is the whole tag") << "[12:01:48] [main/INFOS]: hi";
+        QTest::newRow("log4j no thread") << "[12:01:48] [/WARN]: hi";
+        QTest::newRow("log4j no level") << "[12:01:48] [main/]: [WARNING]";
+        QTest::newRow("log4j later in the line") << "[x] [1] [main/ERROR] [12:00] [main/INFO]";
+        QTest::newRow("log4j thread with brackets") << "[1:2] [pool-[3]-thread/WARN]";
+        QTest::newRow("log4j slash in level") << "[1:2] [a/b/DEBUG]";
+        QTest::newRow("old tags") << "2013-07-01 [INFO] [STDERR] [WARNING] text";
+        QTest::newRow("old tags nested") << "[[FINE]] [FINER [FINEST]";
+        QTest::newRow("old tag cut short") << "[DEBUG";
+        QTest::newRow("overwriting") << "[1:2] [a/INFO] overwriting existing item";
+        QTest::newRow("exception in thread") << "Exception in thread \"main\"";
+        QTest::newRow("at") << "\tat a.b(c)";
+        QTest::newRow("at without package") << "\tat main(c)";
+        QTest::newRow("at digit") << " at a.1b";
+        QTest::newRow("at start of line") << "at a.b";
+        QTest::newRow("caused by") << "Caused by: java.io.IOException";
+        QTest::newRow("caused by without package") << "Caused by: IOException";
+        QTest::newRow("exception name") << "see foo.bar.BazError for details";
+        QTest::newRow("exception name after digits") << "123.Exception";
+        QTest::newRow("exception name in the word") << "a.xxThrowablexx";
+        QTest::newRow("more") << "\t... 12 more";
+        QTest::newRow("more with a line break") << "xyz 3 more\n";
+        QTest::newRow("more not at the end") << "\t... 12 more lines";
+        QTest::newRow("more too short") << "ab 3 more";
+        QTest::newRow("more over a line break") << "a\nb 3 more";
+        QTest::newRow("unicode") << QString::fromUtf8("[12:00] [Gr\xc3\xbc\xc3\x9f" "e/WARN]: \xce\xa3.Error");
+    }
+
+    void test_sameAsRegex()
+    {
+        QFETCH(QString, line);
+        for(auto level: {MessageLevel::StdOut, MessageLevel::StdErr})
+        {
+            QCOMPARE(int(LogClassifier::classify(line, level).level), int(guessLevelWithRegex(line, level)));
+        }
+    }
+
+    void test_recordedLog()
+    {
+        for(auto &line: m_lines)
+        {
+            auto expected = guessLevelWithRegex(line, MessageLevel::StdOut);
+            if(LogClassifier::classify(line, MessageLevel::StdOut).level != expected)
+            {
+                QFAIL(qPrintable("Different level for: " + line));
+            }
+        }
+    }
+
+    void test_classification()
+    {
+        auto log4j = LogClassifier::classify("[12:01:48] [Render thread/WARN]: Missing sound", MessageLevel::StdOut);
+        QCOMPARE(log4j.level, MessageLevel::Warning);
+        QCOMPARE(log4j.timestampStart, 1);
+        QCOMPARE(log4j.timestampLength, 8);
+        QVERIFY(!log4j.exception);
+
+        auto trace = LogClassifier::classify("\tat net.minecraft.client.main.Main.main(Main.java:211)", MessageLevel::StdErr);
+        QCOMPARE(trace.level, MessageLevel::Error);
+        QCOMPARE(trace.timestampStart, -1);
+        QVERIFY(trace.exception);
+    }
+
+    void bench_regex()
+    {
+        QBENCHMARK
+        {
+            for(auto &line: m_lines)
+            {
+                guessLevelWithRegex(line, MessageLevel::StdOut);
+            }
+        }
+    }
+
+    void bench_classifier()
+    {
+        QBENCHMARK
+        {
+            for(auto &line: m_lines)
+            {
+                LogClassifier::classify(line, MessageLevel::StdOut);
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(LogClassifierTest)
+
+#include "LogClassifier_test.moc"
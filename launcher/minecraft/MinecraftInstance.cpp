@@ -2,6 +2,8 @@
 #include "minecraft/launch/CreateGameFolders.h"
 #include "minecraft/launch/ExtractNatives.h"
 #include "minecraft/launch/PrintInstanceInfo.h"
+#include "minecraft/launch/ClassDataSharing.h"
+#include "minecraft/launch/PrefetchGameFiles.h"
 #include "settings/Setting.h"
 #include "settings/SettingsObject.h"
 #include "Application.h"
@@ -44,6 +46,8 @@
 
 #include "PackProfile.h"
 #include "AssetsUtils.h"
+#include "ClassDataArchive.h"
+#include "LogClassifier.h"
 #include "MinecraftUpdate.h"
 #include "MinecraftLoadAndCheck.h"
 #include "minecraft/gameoptions/GameOptions.h"
@@ -51,6 +55,13 @@
 #include "BuildConfig.h"
 #include "minecraft/VersionFilterData.h"
 
+#ifdef major
+    #undef major
+#endif
+#ifdef minor
+    #undef minor
+#endif
+
 #define IBUS "@im=ibus"
 
 // all of this because keeping things compatible with deprecated old settings
@@ -129,6 +140,9 @@ MinecraftInstance::MinecraftInstance(SettingsObjectPtr globalSettings, SettingsO
     m_settings->registerSetting("JoinSingleplayerWorldOnLaunch", false);
     m_settings->registerSetting("JoinSingleplayerWorldOnLaunchName", "");
 
+    // Record the classes the game loads and share them with later launches, this does not have a global override
+    m_settings->registerSetting("UseClassDataSharing", false);
+
     // DEPRECATED: Read what versions the user configuration thinks should be used
     m_settings->registerSetting({"IntendedVersion", "MinecraftVersion"}, "");
     m_settings->registerSetting("LWJGLVersion", "");
@@ -191,8 +205,26 @@ QString MinecraftInstance::binRoot() const
 
 QString MinecraftInstance::getNativePath() const
 {
-    QDir natives_dir(FS::PathCombine(instanceRoot(), "natives/"));
-    return natives_dir.absolutePath();
+    if(!m_native_path.isEmpty())
+    {
+        return m_native_path;
+    }
+    // shared by all instances with the same natives
+    return NativesStore::folderFor(getNativeJars(), getNativesOptions());
+}
+
+void MinecraftInstance::setNativePath(const QString &path)
+{
+    m_native_path = path;
+}
+
+NativesStore::Options MinecraftInstance::getNativesOptions() const
+{
+    NativesStore::Options options;
+    options.nativeOpenAL = settings()->get("UseNativeOpenAL").toBool();
+    options.nativeGLFW = settings()->get("UseNativeGLFW").toBool();
+    options.jnilibHack = getJavaVersion().major() >= 8;
+    return options;
 }
 
 QString MinecraftInstance::getLocalLibraryPath() const
@@ -374,9 +406,34 @@ QStringList MinecraftInstance::javaArguments() const
 
     args << "-Duser.language=en";
 
+    auto archive = classDataArchive();
+    if(!archive.isEmpty())
+    {
+        args.append(ClassDataArchive::arguments(archive));
+    }
+
     return args;
 }
 
+QString MinecraftInstance::classDataArchive() const
+{
+    if(!settings()->get("UseClassDataSharing").toBool() || !ClassDataArchive::isSupported(getJavaVersion().major()))
+    {
+        return QString();
+    }
+    // the launcher's own jar is on the classpath too, and changes with the launcher
+    auto java = QString("%1 %2 %3 %4 %5").arg(
+        settings()->get("JavaPath").toString(),
+        settings()->get("JavaVersion").toString(),
+        settings()->get("JavaTimestamp").toString(),
+        settings()->get("MCLaunchMethod").toString(),
+        BuildConfig.printableVersionString()
+    );
+    auto files = getClassPath();
+    files << modsRoot() << coreModsDir();
+    return ClassDataArchive::pathFor(FS::PathCombine(instanceRoot(), "cds"), ClassDataArchive::key(java, files));
+}
+
 QMap<QString, QString> MinecraftInstance::getVariables() const
 {
     QMap<QString, QString> out;
@@ -751,49 +808,7 @@ QMap<QString, QString> MinecraftInstance::createCensorFilterFromSession(AuthSess
 
 MessageLevel::Enum MinecraftInstance::guessLevel(const QString &line, MessageLevel::Enum level)
 {
-    QRegularExpression re("\\[(?<timestamp>[0-9:]+)\\] \\[[^/]+/(?<level>[^\\]]+)\\]");
-    auto match = re.match(line);
-    if(match.hasMatch())
-    {
-        // New style logs from log4j
-        QString timestamp = match.captured("timestamp");
-        QString levelStr = match.captured("level");
-        if(levelStr == "INFO")
-            level = MessageLevel::Message;
-        if(levelStr == "WARN")
-            level = MessageLevel::Warning;
-        if(levelStr == "ERROR")
-            level = MessageLevel::Error;
-        if(levelStr == "FATAL")
-            level = MessageLevel::Fatal;
-        if(levelStr == "TRACE" || levelStr == "DEBUG")
-            level = MessageLevel::Debug;
-    }
-    else
-    {
-        // Old style forge logs
-        if (line.contains("[INFO]") || line.contains("[CONFIG]") || line.contains("[FINE]") ||
-                line.contains("[FINER]") || line.contains("[FINEST]"))
-            level = MessageLevel::Message;
-        if (line.contains("[SEVERE]") || line.contains("[STDERR]"))
-            level = MessageLevel::Error;
-        if (line.contains("[WARNING]"))
-            level = MessageLevel::Warning;
-        if (line.contains("[DEBUG]"))
-            level = MessageLevel::Debug;
-    }
-    if (line.contains("overwriting existing"))
-        return MessageLevel::Fatal;
-    //NOTE: this diverges from the real regexp. no unicode, the first section is + instead of *
-    static const QString javaSymbol = "([a-zA-Z_$][a-zA-Z\\d_$]*\\.)+[a-zA-Z_$][a-zA-Z\\d_$]*";
-    if (line.contains("Exception in thread")
-        || line.contains(QRegularExpression("\\s+at " + javaSymbol))
-        || line.contains(QRegularExpression("Caused by: " + javaSymbol))
-        || line.contains(QRegularExpression("([a-zA-Z_$][a-zA-Z\\d_$]*\\.)+[a-zA-Z_$]?[a-zA-Z\\d_$]*(Exception|Error|Throwable)"))
-        || line.contains(QRegularExpression("... \\d+ more$"))
-        )
-        return MessageLevel::Error;
-    return level;
+    return LogClassifier::classify(line, level).level;
 }
 
 IPathMatcher::Ptr MinecraftInstance::getLogFileMatcher()
@@ -856,6 +871,13 @@ Task::Ptr MinecraftInstance::createUpdateTask(Net::Mode mode)
     return nullptr;
 }
 
+Task::Ptr MinecraftInstance::createVerifyTask()
+{
+    auto update = new MinecraftUpdate(this);
+    update->setVerifyAssets(true);
+    return Task::Ptr(update);
+}
+
 shared_qobject_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPtr session, QuickPlayTargetPtr quickPlayTarget)
 {
     // FIXME: get rid of shared_from_this ...
@@ -864,6 +886,12 @@ shared_qobject_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPt
 
     APPLICATION->icons()->saveIcon(iconKey(), FS::PathCombine(gameRoot(), "icon.png"), "PNG");
 
+    // record how long each part of the launch takes, next to the game logs
+    if(APPLICATION->settings()->get("TraceLaunches").toBool())
+    {
+        process->setTraceFile(FS::PathCombine(gameRoot(), "logs", "launch-trace.json"));
+    }
+
     // print a header
     {
         process->appendStep(new TextPrint(pptr, "Minecraft folder is:\n" + gameRoot() + "\n\n", MessageLevel::Launcher));
@@ -902,15 +930,6 @@ shared_qobject_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPt
         }
     }
 
-    if(quickPlayTarget && quickPlayTarget->port == 25565)
-    {
-        // Resolve server address to join on launch
-        auto *step = new LookupServerAddress(pptr);
-        step->setLookupAddress(quickPlayTarget->address);
-        step->setOutputAddressPtr(quickPlayTarget);
-        process->appendStep(step);
-    }
-
     // run pre-launch command if that's needed
     if(getPreLaunchCommand().size())
     {
@@ -920,48 +939,82 @@ shared_qobject_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPt
     }
 
     // if we aren't in offline mode,.
+    LaunchStep *update = nullptr;
     if(session->status != AuthSession::PlayableOffline)
     {
         if(!session->demo) {
             process->appendStep(new ClaimAccount(pptr, session));
         }
-        process->appendStep(new Update(pptr, Net::Mode::Online));
+        update = new Update(pptr, Net::Mode::Online);
     }
     else
     {
-        process->appendStep(new Update(pptr, Net::Mode::Offline));
+        update = new Update(pptr, Net::Mode::Offline);
     }
+    process->appendStep(update);
 
-    // if there are any jar mods
+    // the steps up to the Java check only need what the update got, and run at the same time
+
+    // get the files the game starts with read while everything else is prepared
+    if(APPLICATION->settings()->get("PrefetchGameFiles").toBool())
     {
-        process->appendStep(new ModMinecraftJar(pptr));
+        auto step = new PrefetchGameFiles(pptr);
+        step->setDependencies({update});
+        process->appendStep(step);
     }
 
-    // Scan mods folders for mods
+    // if there are any jar mods
     {
-        process->appendStep(new ScanModFolders(pptr));
+        auto step = new ModMinecraftJar(pptr);
+        step->setDependencies({update});
+        process->appendStep(step);
     }
 
-    // print some instance info here...
+    // Scan mods folders for mods
+    auto scanModFolders = new ScanModFolders(pptr);
+    scanModFolders->setDependencies({update});
+    process->appendStep(scanModFolders);
+
+    // Resolve server address to join on launch, it only needs the network
+    LookupServerAddress *lookupServerAddress = nullptr;
+    if(quickPlayTarget && quickPlayTarget->port == 25565)
     {
-        process->appendStep(new PrintInstanceInfo(pptr, session, quickPlayTarget));
+        lookupServerAddress = new LookupServerAddress(pptr);
+        lookupServerAddress->setLookupAddress(quickPlayTarget->address);
+        lookupServerAddress->setOutputAddressPtr(quickPlayTarget);
+        lookupServerAddress->setDependencies({});
+        process->appendStep(lookupServerAddress);
     }
 
-    // extract native jars if needed
+    // extract native jars if needed, and find out where they are
+    auto extractNatives = new ExtractNatives(pptr);
+    extractNatives->setDependencies({update});
+    process->appendStep(extractNatives);
+
+    // print some instance info here... it lists the mods, the natives and where the game connects to
     {
-        process->appendStep(new ExtractNatives(pptr));
+        auto step = new PrintInstanceInfo(pptr, session, quickPlayTarget);
+        QList<LaunchStep *> dependencies = {scanModFolders, extractNatives};
+        if(lookupServerAddress)
+        {
+            dependencies.append(lookupServerAddress);
+        }
+        step->setDependencies(dependencies);
+        process->appendStep(step);
     }
 
     // reconstruct assets if needed
     {
-        process->appendStep(new ReconstructAssets(pptr));
+        auto step = new ReconstructAssets(pptr);
+        step->setDependencies({update});
+        process->appendStep(step);
     }
 
     // verify that minimum Java requirements are met
-    {
-        process->appendStep(new VerifyJavaInstall(pptr));
-    }
+    auto verifyJava = new VerifyJavaInstall(pptr);
+    process->appendStep(verifyJava);
 
+    LaunchStep *launch = nullptr;
     {
         // actually launch the game
         auto method = launchMethod();
@@ -972,6 +1025,7 @@ shared_qobject_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPt
             step->setAuthSession(session);
             step->setQuickPlayTarget(quickPlayTarget);
             process->appendStep(step);
+            launch = step;
         }
         else if (method == "DirectJava")
         {
@@ -980,9 +1034,19 @@ shared_qobject_ptr<LaunchTask> MinecraftInstance::createLaunchTask(AuthSessionPt
             step->setAuthSession(session);
             step->setQuickPlayTarget(quickPlayTarget);
             process->appendStep(step);
+            launch = step;
         }
     }
 
+    // time the startup and keep the class data archive, this runs along with the game
+    if(launch)
+    {
+        auto step = new ClassDataSharing(pptr, launch);
+        step->setDependencies({verifyJava});
+        step->setRunsAlongside(true);
+        process->appendStep(step);
+    }
+
     // run post-exit command if that's needed
     if(getPostExitCommand().size())
     {
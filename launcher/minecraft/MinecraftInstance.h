@@ -5,6 +5,7 @@
 #include <QProcess>
 #include <QDir>
 #include "minecraft/launch/QuickPlayTarget.h"
+#include "minecraft/NativesStore.h"
 
 class ModFolderModel;
 class WorldList;
@@ -60,6 +61,10 @@ public:
 
     // where to put the natives during/before launch
     QString getNativePath() const;
+    // where the current launch found the natives. Saves getNativePath() from reading the native jars again.
+    void setNativePath(const QString &path);
+    // how the native jars of this instance are extracted
+    NativesStore::Options getNativesOptions() const;
 
     // where the instance-local libraries should be
     QString getLocalLibraryPath() const;
@@ -79,6 +84,8 @@ public:
 
     //////  Launch stuff //////
     Task::Ptr createUpdateTask(Net::Mode mode) override;
+    /// like the online update, but also checks every asset file that is already there
+    Task::Ptr createVerifyTask();
     shared_qobject_ptr<LaunchTask> createLaunchTask(AuthSessionPtr account, QuickPlayTargetPtr quickPlayTarget) override;
     QStringList extraArguments() const override;
     QStringList verboseDescription(AuthSessionPtr session, QuickPlayTargetPtr quickPlayTarget) override;
@@ -86,6 +93,8 @@ public:
     QString createLaunchScript(AuthSessionPtr session, QuickPlayTargetPtr quickPlayTarget);
     /// get arguments passed to java
     QStringList javaArguments() const;
+    /// the class data archive the game uses or records, empty if class data sharing is off or can't be used
+    QString classDataArchive() const;
 
     /// get variables for launch command variable substitution/environment
     QMap<QString, QString> getVariables() const override;
@@ -128,6 +137,7 @@ protected: // data
     mutable std::shared_ptr<ModFolderModel> m_texture_pack_list;
     mutable std::shared_ptr<WorldList> m_world_list;
     mutable std::shared_ptr<GameOptions> m_game_options;
+    QString m_native_path;
 };
 
 typedef std::shared_ptr<MinecraftInstance> MinecraftInstancePtr;
@@ -73,7 +73,7 @@ void MinecraftUpdate::executeTask()
 
     // assets update
     {
-        m_tasks.append(std::make_shared<AssetUpdateTask>(m_inst));
+        m_tasks.append(std::make_shared<AssetUpdateTask>(m_inst, m_verifyAssets));
     }
 
     if(!m_preFailure.isEmpty())
@@ -37,6 +37,12 @@ public:
     void executeTask() override;
     bool canAbort() const override;
 
+    /// hash all assets that are already there, instead of trusting what is known about them
+    void setVerifyAssets(bool verify)
+    {
+        m_verifyAssets = verify;
+    }
+
 private
 slots:
     bool abort() override;
@@ -52,6 +58,7 @@ private:
     QString m_preFailure;
     int m_currentTask = -1;
     bool m_abort = false;
+    bool m_verifyAssets = false;
     bool m_failed_out_of_order = false;
     QString m_fail_reason;
 };
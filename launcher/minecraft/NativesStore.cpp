@@ -0,0 +1,212 @@
+#include "NativesStore.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QDebug>
+
+#include <quazip.h>
+#include "MMCZip.h"
+#include "FileSystem.h"
+#include "FileHashCache.h"
+
+namespace {
+// bump this when the way natives are extracted changes, so old folders aren't used anymore
+const char *storeVersion = "1";
+
+// marks when a folder was last used
+const char *lastUsedName = ".lastused";
+
+QString storeRoot()
+{
+    return QDir("natives").absolutePath();
+}
+
+QDateTime lastUsed(const QFileInfo &folder)
+{
+    // complete folders are marked, leftovers of broken extractions only have their own time
+    QFileInfo marker(FS::PathCombine(folder.absoluteFilePath(), lastUsedName));
+    return marker.exists() ? marker.lastModified() : folder.lastModified();
+}
+
+void markUsed(const QString &folder)
+{
+    auto marker = FS::PathCombine(folder, lastUsedName);
+    QFileInfo info(marker);
+    if(!info.exists())
+    {
+        QFile file(marker);
+        file.open(QIODevice::WriteOnly);
+        return;
+    }
+    // a day is close enough, no need to write something on every launch
+    if(info.lastModified().daysTo(QDateTime::currentDateTime()) >= 1)
+    {
+        FS::updateTimestamp(marker);
+    }
+}
+
+QString hashesPath()
+{
+    return FS::PathCombine(storeRoot(), "hashes.json");
+}
+
+FileHashCache &jarHashes()
+{
+    // made when first needed, from then on the store stays where it is
+    static FileHashCache hashes(hashesPath());
+    return hashes;
+}
+
+QString replaceSuffix (QString target, const QString &suffix, const QString &replacement)
+{
+    if (!target.endsWith(suffix))
+    {
+        return target;
+    }
+    target.resize(target.length() - suffix.length());
+    return target + replacement;
+}
+
+bool unzipNatives(QString source, QString targetFolder, const NativesStore::Options &options)
+{
+    QuaZip zip(source);
+    if(!zip.open(QuaZip::mdUnzip))
+    {
+        return false;
+    }
+    QDir directory(targetFolder);
+    if (!zip.goToFirstFile())
+    {
+        return false;
+    }
+    do
+    {
+        QString name = zip.getCurrentFileName();
+        if (options.nativeGLFW && name.contains("glfw")) {
+            continue;
+        }
+        if (options.nativeOpenAL && name.contains("openal")) {
+            continue;
+        }
+        if(options.jnilibHack)
+        {
+            name = replaceSuffix(name, ".jnilib", ".dylib");
+        }
+        QString absFilePath = directory.absoluteFilePath(name);
+        if (!JlCompress::extractFile(&zip, "", absFilePath))
+        {
+            return false;
+        }
+    } while (zip.goToNextFile());
+    zip.close();
+    if(zip.getZipError()!=0)
+    {
+        return false;
+    }
+    return true;
+}
+}
+
+namespace NativesStore
+{
+
+QString folderFor(const QStringList &jars, const Options &options)
+{
+    QCryptographicHash key(QCryptographicHash::Sha1);
+    key.addData(storeVersion);
+    // later jars overwrite files of earlier ones, so the order matters
+    for(auto &jar: jars)
+    {
+        auto hash = jarHashes().hash(jar);
+        if(hash.isEmpty())
+        {
+            // it can't be extracted anyway, but keep it apart from everything else
+            hash = "missing:" + jar.toUtf8();
+        }
+        key.addData(hash);
+    }
+    key.addData(QString("jnilib=%1 openal=%2 glfw=%3")
+        .arg(int(options.jnilibHack))
+        .arg(int(options.nativeOpenAL))
+        .arg(int(options.nativeGLFW)).toLatin1());
+    jarHashes().save();
+    return FS::PathCombine(storeRoot(), QString::fromLatin1(key.result().toHex().left(20)));
+}
+
+bool prepare(const QStringList &jars, const Options &options, QString &folder, QString &error)
+{
+    folder = folderFor(jars, options);
+    if(QFileInfo(folder).isDir())
+    {
+        markUsed(folder);
+        return true;
+    }
+    if(!FS::ensureFolderPathExists(storeRoot()))
+    {
+        error = QObject::tr("Couldn't create the natives folder '%1'").arg(storeRoot());
+        return false;
+    }
+    // extract next to the real folder, so it appears complete or not at all
+    QTemporaryDir temp(folder + "-XXXXXX");
+    if(!temp.isValid())
+    {
+        error = QObject::tr("Couldn't create a temporary folder for the natives in '%1'").arg(storeRoot());
+        return false;
+    }
+    for(const auto &source: jars)
+    {
+        if(!unzipNatives(source, temp.path(), options))
+        {
+            error = QObject::tr("Couldn't extract native jar '%1' to destination '%2'").arg(source, temp.path());
+            return false;
+        }
+    }
+    markUsed(temp.path());
+    if(!QDir().rename(temp.path(), folder))
+    {
+        // someone else was faster, theirs is just as good
+        if(QFileInfo(folder).isDir())
+        {
+            markUsed(folder);
+            return true;
+        }
+        error = QObject::tr("Couldn't move the natives to '%1'").arg(folder);
+        return false;
+    }
+    qDebug() << "Extracted" << jars.size() << "native jars to" << folder;
+    return true;
+}
+
+int prune(const QString &keep, int maxAgeDays)
+{
+    auto now = QDateTime::currentDateTime();
+    auto kept = QFileInfo(keep).absoluteFilePath();
+    int removed = 0;
+    for(auto &info: QDir(storeRoot()).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        if(info.absoluteFilePath() == kept || lastUsed(info).daysTo(now) < maxAgeDays)
+        {
+            continue;
+        }
+        if(FS::deletePath(info.absoluteFilePath()))
+        {
+            removed++;
+        }
+        else
+        {
+            // maybe a game that is still running has them loaded, try again next time
+            qWarning() << "Couldn't remove unused natives in" << info.absoluteFilePath();
+        }
+    }
+    if(removed)
+    {
+        qDebug() << "Removed" << removed << "natives folders that weren't used for" << maxAgeDays << "days";
+    }
+    return removed;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/*
+ * Natives, extracted once and shared by all instances.
+ *
+ * Every combination of native jars and extraction options gets its own folder in 'natives/', named after a hash of the
+ * jars' contents and the options. Folders are extracted under a temporary name and renamed when complete, so a folder
+ * that exists is ready to use and a warm launch only has to look for it.
+ *
+ * Hashes of the jars are remembered along with their size and modification time, so they are only read again when
+ * they change. Still, working out the folder may have to read the jars, so it is done by the launch on a worker thread.
+ *
+ * Each folder has a '.lastused' file, touched at most once a day when the folder is used. Folders that weren't used for
+ * a while are removed by prune().
+ */
+namespace NativesStore
+{
+struct Options
+{
+    /// rename .jnilib files to .dylib, Java 8+ only loads the latter
+    bool jnilibHack = false;
+    /// leave out OpenAL, the system one is used
+    bool nativeOpenAL = false;
+    /// leave out GLFW, the system one is used
+    bool nativeGLFW = false;
+};
+
+/// the folder for the jars and options, whether it is extracted yet or not
+QString folderFor(const QStringList &jars, const Options &options);
+
+/// extract the jars into their folder, unless that was done before. Sets folder to it, or returns false and sets error.
+bool prepare(const QStringList &jars, const Options &options, QString &folder, QString &error);
+
+/// remove the folders, other than keep, that weren't used for the given number of days. Returns how many were removed.
+int prune(const QString &keep, int maxAgeDays = 30);
+}
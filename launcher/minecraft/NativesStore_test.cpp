@@ -0,0 +1,180 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QMap>
+
+#include <quazip.h>
+#include <quazipfile.h>
+
+#include "minecraft/NativesStore.h"
+#include "FileSystem.h"
+
+#ifndef Q_OS_WIN
+#include <utime.h>
+#endif
+
+class NativesStoreTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+    QString m_oldCurrent;
+
+    QString writeJar(const QString &name, const QMap<QString, QByteArray> &files)
+    {
+        auto path = FS::PathCombine(m_dir.path(), name);
+        QuaZip zip(path);
+        if(!zip.open(QuaZip::mdCreate))
+        {
+            return QString();
+        }
+        for(auto iter = files.begin(); iter != files.end(); iter++)
+        {
+            QuaZipFile file(&zip);
+            if(!file.open(QIODevice::WriteOnly, QuaZipNewInfo(iter.key())))
+            {
+                return QString();
+            }
+            file.write(iter.value());
+            file.close();
+        }
+        zip.close();
+        return path;
+    }
+
+    static QStringList files(const QString &folder)
+    {
+        auto out = QDir(folder).entryList(QDir::Files);
+        out.sort();
+        return out;
+    }
+
+private
+slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        // the store lives in the working directory, like it does in the launcher's data folder
+        m_oldCurrent = QDir::currentPath();
+        QVERIFY(QDir::setCurrent(m_dir.path()));
+    }
+
+    void cleanupTestCase()
+    {
+        QDir::setCurrent(m_oldCurrent);
+    }
+
+    void test_prepare()
+    {
+        auto lwjgl = writeJar("lwjgl-natives.jar", {
+            {"liblwjgl.so", "lwjgl"},
+            {"libopenal.so", "openal"}
+        });
+        auto glfw = writeJar("glfw-natives.jar", {{"libglfw.so", "glfw"}});
+        QVERIFY(!lwjgl.isEmpty() && !glfw.isEmpty());
+
+        NativesStore::Options options;
+        QString folder, error;
+        QVERIFY(NativesStore::prepare({lwjgl, glfw}, options, folder, error));
+        QVERIFY(error.isEmpty());
+        QCOMPARE(folder, NativesStore::folderFor({lwjgl, glfw}, options));
+        QCOMPARE(files(folder), QStringList({"libglfw.so", "liblwjgl.so", "libopenal.so"}));
+        QVERIFY(QFileInfo(FS::PathCombine(folder, ".lastused")).isFile());
+
+        // a folder that is there is used as it is, nothing is extracted again
+        QVERIFY(QFile::remove(FS::PathCombine(folder, "libglfw.so")));
+        QString again;
+        QVERIFY(NativesStore::prepare({lwjgl, glfw}, options, again, error));
+        QCOMPARE(again, folder);
+        QCOMPARE(files(again), QStringList({"liblwjgl.so", "libopenal.so"}));
+    }
+
+    void test_folderFor()
+    {
+        auto first = writeJar("first.jar", {{"libfirst.so", "first"}});
+        auto second = writeJar("second.jar", {{"libsecond.so", "second"}});
+        NativesStore::Options options;
+        auto folder = NativesStore::folderFor({first, second}, options);
+        QCOMPARE(QFileInfo(folder).path(), QDir("natives").absolutePath());
+        QCOMPARE(NativesStore::folderFor({first, second}, options), folder);
+
+        // later jars win, the order matters
+        QVERIFY(NativesStore::folderFor({second, first}, options) != folder);
+
+        auto openAL = options;
+        openAL.nativeOpenAL = true;
+        QVERIFY(NativesStore::folderFor({first, second}, openAL) != folder);
+
+        // the same name with different content is a different set of natives
+        QVERIFY(QFile::remove(second));
+        second = writeJar("second.jar", {{"libsecond.so", "second, but newer"}});
+        QVERIFY(NativesStore::folderFor({first, second}, options) != folder);
+    }
+
+    void test_options()
+    {
+        auto jar = writeJar("options.jar", {
+            {"liblwjgl.jnilib", "lwjgl"},
+            {"libopenal.so", "openal"},
+            {"libglfw.so", "glfw"}
+        });
+        NativesStore::Options options;
+        options.jnilibHack = true;
+        options.nativeOpenAL = true;
+        options.nativeGLFW = true;
+        QString folder, error;
+        QVERIFY(NativesStore::prepare({jar}, options, folder, error));
+        QCOMPARE(files(folder), QStringList({"liblwjgl.dylib"}));
+    }
+
+    void test_brokenJar()
+    {
+        auto broken = FS::PathCombine(m_dir.path(), "broken.jar");
+        FS::write(broken, "not a zip file");
+        QString folder, error;
+        QVERIFY(!NativesStore::prepare({broken}, NativesStore::Options(), folder, error));
+        QVERIFY(!error.isEmpty());
+        // nothing half extracted is left where a good folder would be
+        QVERIFY(!QFileInfo(folder).exists());
+    }
+
+#ifndef Q_OS_WIN
+    void test_prune()
+    {
+        auto used = writeJar("used.jar", {{"libused.so", "used"}});
+        auto unused = writeJar("unused.jar", {{"libunused.so", "unused"}});
+        NativesStore::Options options;
+        QString usedFolder, unusedFolder, error;
+        QVERIFY(NativesStore::prepare({used}, options, usedFolder, error));
+        QVERIFY(NativesStore::prepare({unused}, options, unusedFolder, error));
+
+        // recently used ones stay
+        NativesStore::prune(usedFolder);
+        QVERIFY(QFileInfo(unusedFolder).isDir());
+
+        auto past = QDateTime::currentDateTime().addDays(-40).toTime_t();
+        utimbuf times;
+        times.actime = past;
+        times.modtime = past;
+        for(auto &folder: {usedFolder, unusedFolder})
+        {
+            QCOMPARE(utime(QFile::encodeName(FS::PathCombine(folder, ".lastused")).constData(), &times), 0);
+        }
+        QCOMPARE(NativesStore::prune(usedFolder), 1);
+        QVERIFY(!QFileInfo(unusedFolder).exists());
+        // the one in use stays, however old it looks
+        QVERIFY(QFileInfo(usedFolder).isDir());
+
+        // and using it again marks it as used
+        QString again;
+        QVERIFY(NativesStore::prepare({used}, options, again, error));
+        QVERIFY(QFileInfo(FS::PathCombine(again, ".lastused")).lastModified().daysTo(QDateTime::currentDateTime()) < 1);
+    }
+#endif
+};
+
+QTEST_GUILESS_MAIN(NativesStoreTest)
+
+#include "NativesStore_test.moc"
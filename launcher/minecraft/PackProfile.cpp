@@ -26,8 +26,10 @@
 
 #include "Exception.h"
 #include "minecraft/OneSixVersionFormat.h"
+#include "minecraft/LaunchProfileCache.h"
 #include "FileSystem.h"
 #include "meta/Index.h"
+#include "meta/Version.h"
 #include "minecraft/MinecraftInstance.h"
 #include "Json.h"
 
@@ -256,6 +258,11 @@ QString PackProfile::patchesPattern() const
     return FS::PathCombine(d->m_instance->instanceRoot(), "patches", "%1.json");
 }
 
+QString PackProfile::profileCachePath() const
+{
+    return FS::PathCombine(d->m_instance->instanceRoot(), "launch-profile.json");
+}
+
 QString PackProfile::patchFilePathForUid(const QString& uid) const
 {
     return patchesPattern().arg(uid);
@@ -1151,10 +1158,58 @@ bool PackProfile::installCustomJar_internal(QString filepath)
     return true;
 }
 
+/*
+ * What the launch profile is made from: the enabled components, in order, and the contents of their version files.
+ * Empty if one of the version files isn't there.
+ */
+static QByteArray profileKey(const ComponentContainer &components)
+{
+    QCryptographicHash key(QCryptographicHash::Sha1);
+    for(auto &component: components)
+    {
+        if(!component->isEnabled())
+        {
+            continue;
+        }
+        QString path;
+        if(component->m_metaVersion)
+        {
+            path = QDir("meta").absoluteFilePath(component->m_metaVersion->localFilename());
+        }
+        else if(component->m_file)
+        {
+            path = component->getFilename();
+        }
+        else
+        {
+            return QByteArray();
+        }
+        QFile file(path);
+        QCryptographicHash fileHash(QCryptographicHash::Sha1);
+        if(!file.open(QIODevice::ReadOnly) || !fileHash.addData(&file))
+        {
+            return QByteArray();
+        }
+        key.addData(QString("%1:%2:").arg(component->m_uid, component->m_version).toUtf8());
+        key.addData(fileHash.result());
+    }
+    return key.result().toHex();
+}
+
 std::shared_ptr<LaunchProfile> PackProfile::getProfile() const
 {
     if(!d->m_profile)
     {
+        // unless something changed, the profile from before can be used
+        auto key = profileKey(d->components);
+        if(!key.isEmpty())
+        {
+            d->m_profile = LaunchProfileCache::load(profileCachePath(), key);
+            if(d->m_profile)
+            {
+                return d->m_profile;
+            }
+        }
         try
         {
             auto profile = std::make_shared<LaunchProfile>();
@@ -1164,6 +1219,10 @@ std::shared_ptr<LaunchProfile> PackProfile::getProfile() const
                 file->applyTo(profile.get());
             }
             d->m_profile = profile;
+            if(!key.isEmpty())
+            {
+                LaunchProfileCache::save(profileCachePath(), key, *profile);
+            }
         }
         catch (const Exception &error)
         {
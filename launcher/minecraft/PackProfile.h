@@ -129,6 +129,7 @@ private:
 
     QString componentsFilePath() const;
     QString patchesPattern() const;
+    QString profileCachePath() const;
 
 private slots:
     void save_internal();
@@ -0,0 +1,87 @@
+#include "ClassDataSharing.h"
+#include <launch/LaunchTask.h>
+#include <minecraft/MinecraftInstance.h>
+#include <minecraft/ClassDataArchive.h>
+
+namespace {
+// logged by all the versions since 1.7 once the sounds are loaded, right before the main menu shows up
+const char *mainMenuMarker = "Sound engine started";
+}
+
+ClassDataSharing::ClassDataSharing(LaunchTask *parent, LaunchStep *launch) : LaunchStep(parent), m_launch(launch)
+{
+}
+
+void ClassDataSharing::executeTask()
+{
+    auto instance = std::dynamic_pointer_cast<MinecraftInstance>(m_parent->instance());
+    m_archive = instance->classDataArchive();
+    // the launch step was started first, and chose between using and recording the archive already
+    m_recording = !m_archive.isEmpty() && !ClassDataArchive::exists(m_archive);
+    connect(m_launch, &LaunchStep::logLines, this, &ClassDataSharing::gameLogLines);
+    connect(m_launch, &Task::finished, this, &ClassDataSharing::launchFinished);
+    m_timer.start();
+}
+
+void ClassDataSharing::gameLogLines(const QStringList &lines)
+{
+    if(m_mainMenuTime >= 0)
+    {
+        return;
+    }
+    for(auto &line: lines)
+    {
+        if(line.contains(mainMenuMarker))
+        {
+            m_mainMenuTime = m_timer.elapsed();
+            QString sharing;
+            if(m_archive.isEmpty())
+            {
+                sharing = tr("without class data sharing");
+            }
+            else if(m_recording)
+            {
+                sharing = tr("while recording a class data archive");
+            }
+            else
+            {
+                sharing = tr("with a class data archive");
+            }
+            emit logLine(tr("The main menu showed up %1 seconds after the game was started, %2.")
+                .arg(m_mainMenuTime / 1000.0, 0, 'f', 1).arg(sharing), MessageLevel::Launcher);
+            return;
+        }
+    }
+}
+
+void ClassDataSharing::launchFinished()
+{
+    if(!isRunning())
+    {
+        return;
+    }
+    if(m_recording && m_launch->wasSuccessful())
+    {
+        m_recording = false;
+        if(ClassDataArchive::keep(m_archive))
+        {
+            emit logLine(tr("Kept the class data archive, the next launches will start faster."), MessageLevel::Launcher);
+        }
+    }
+    emitSucceeded();
+}
+
+bool ClassDataSharing::abort()
+{
+    emitAborted();
+    return true;
+}
+
+void ClassDataSharing::finalize()
+{
+    // the game didn't run well, what it left behind may not be complete
+    if(m_recording)
+    {
+        ClassDataArchive::discard(m_archive);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <launch/LaunchStep.h>
+#include <QElapsedTimer>
+
+/*
+ * Runs alongside the game: measures how long it takes to get to the main menu, and keeps the class data archive
+ * recorded during the launch once the game closed without problems.
+ */
+class ClassDataSharing: public LaunchStep
+{
+    Q_OBJECT
+public:
+    /// the game is started by the launch step
+    explicit ClassDataSharing(LaunchTask *parent, LaunchStep *launch);
+    virtual ~ClassDataSharing() {};
+
+    void executeTask() override;
+    bool abort() override;
+    bool canAbort() const override
+    {
+        return true;
+    }
+    void finalize() override;
+
+private slots:
+    void gameLogLines(const QStringList &lines);
+    void launchFinished();
+
+private:
+    LaunchStep *m_launch;
+    /// the archive used or recorded by the launch, empty when class data sharing is off
+    QString m_archive;
+    bool m_recording = false;
+    QElapsedTimer m_timer;
+    qint64 m_mainMenuTime = -1;
+};
@@ -15,69 +15,43 @@
 
 #include "ExtractNatives.h"
 #include <minecraft/MinecraftInstance.h>
+#include <minecraft/NativesStore.h>
 #include <launch/LaunchTask.h>
 
-#include <quazip.h>
-#include <quazipdir.h>
-#include "MMCZip.h"
 #include "FileSystem.h"
+#include "tasks/Tracer.h"
+#include <QAtomicInt>
 #include <QDir>
+#include <QtConcurrentRun>
 
-#ifdef major
-    #undef major
-#endif
-#ifdef minor
-    #undef minor
-#endif
+namespace {
+// old natives are cleaned up by the first launch of a session
+QAtomicInt pruned;
 
-static QString replaceSuffix (QString target, const QString &suffix, const QString &replacement)
+ExtractNatives::Prepared prepareNatives(QStringList jars, NativesStore::Options options)
 {
-    if (!target.endsWith(suffix))
+    Tracer::Scope scope("prepareNatives", "launch");
+    ExtractNatives::Prepared prepared;
+    if(!NativesStore::prepare(jars, options, prepared.folder, prepared.error))
     {
-        return target;
+        return prepared;
     }
-    target.resize(target.length() - suffix.length());
-    return target + replacement;
+    if(pruned.testAndSetRelaxed(0, 1))
+    {
+        NativesStore::prune(prepared.folder);
+    }
+    return prepared;
+}
 }
 
-static bool unzipNatives(QString source, QString targetFolder, bool applyJnilibHack, bool nativeOpenAL, bool nativeGLFW)
+ExtractNatives::ExtractNatives(LaunchTask *parent) : LaunchStep(parent)
 {
-    QuaZip zip(source);
-    if(!zip.open(QuaZip::mdUnzip))
-    {
-        return false;
-    }
-    QDir directory(targetFolder);
-    if (!zip.goToFirstFile())
-    {
-        return false;
-    }
-    do
-    {
-        QString name = zip.getCurrentFileName();
-        auto lowercase = name.toLower();
-        if (nativeGLFW && name.contains("glfw")) {
-            continue;
-        }
-        if (nativeOpenAL && name.contains("openal")) {
-            continue;
-        }
-        if(applyJnilibHack)
-        {
-            name = replaceSuffix(name, ".jnilib", ".dylib");
-        }
-        QString absFilePath = directory.absoluteFilePath(name);
-        if (!JlCompress::extractFile(&zip, "", absFilePath))
-        {
-            return false;
-        }
-    } while (zip.goToNextFile());
-    zip.close();
-    if(zip.getZipError()!=0)
-    {
-        return false;
-    }
-    return true;
+    connect(&m_watcher, &QFutureWatcher<Prepared>::finished, this, &ExtractNatives::extractFinished);
+}
+
+ExtractNatives::~ExtractNatives()
+{
+    m_watcher.waitForFinished();
 }
 
 void ExtractNatives::executeTask()
@@ -87,32 +61,39 @@ void ExtractNatives::executeTask()
     auto toExtract = minecraftInstance->getNativeJars();
     if(toExtract.isEmpty())
     {
+        // nothing to read, it is only a name
+        minecraftInstance->setNativePath(NativesStore::folderFor(toExtract, minecraftInstance->getNativesOptions()));
         emitSucceeded();
         return;
     }
-    auto settings = minecraftInstance->settings();
-    bool nativeOpenAL = settings->get("UseNativeOpenAL").toBool();
-    bool nativeGLFW = settings->get("UseNativeGLFW").toBool();
 
-    auto outputPath  = minecraftInstance->getNativePath();
-    auto javaVersion = minecraftInstance->getJavaVersion();
-    bool jniHackEnabled = javaVersion.major() >= 8;
-    for(const auto &source: toExtract)
+    // usually extracted by an earlier launch already, when it isn't the other steps don't have to wait for it.
+    // working out the folder reads the jars that changed, so that happens in the background as well.
+    m_watcher.setFuture(QtConcurrent::run(prepareNatives, toExtract, minecraftInstance->getNativesOptions()));
+}
+
+void ExtractNatives::extractFinished()
+{
+    auto prepared = m_watcher.result();
+    if(!prepared.error.isEmpty())
     {
-        if(!unzipNatives(source, outputPath, jniHackEnabled, nativeOpenAL, nativeGLFW))
-        {
-            const char *reason = QT_TR_NOOP("Couldn't extract native jar '%1' to destination '%2'");
-            emit logLine(QString(reason).arg(source, outputPath), MessageLevel::Fatal);
-            emitFailed(tr(reason).arg(source, outputPath));
-        }
+        emit logLine(prepared.error, MessageLevel::Fatal);
+        emitFailed(prepared.error);
+        return;
     }
+    auto instance = std::dynamic_pointer_cast<MinecraftInstance>(m_parent->instance());
+    instance->setNativePath(prepared.folder);
     emitSucceeded();
 }
 
 void ExtractNatives::finalize()
 {
+    // natives used to be extracted into the instance for each launch, clean up after older versions
     auto instance = m_parent->instance();
     QString target_dir = FS::PathCombine(instance->instanceRoot(), "natives/");
     QDir dir(target_dir);
-    dir.removeRecursively();
+    if(dir.exists())
+    {
+        dir.removeRecursively();
+    }
 }
@@ -17,6 +17,7 @@
 
 #include <launch/LaunchStep.h>
 #include <memory>
+#include <QFutureWatcher>
 #include "minecraft/auth/AuthSession.h"
 
 // FIXME: temporary wrapper for existing task.
@@ -24,8 +25,16 @@ class ExtractNatives: public LaunchStep
 {
     Q_OBJECT
 public:
-    explicit ExtractNatives(LaunchTask *parent) : LaunchStep(parent){};
-    virtual ~ExtractNatives(){};
+    struct Prepared
+    {
+        QString folder;
+        /// empty if the natives are ready
+        QString error;
+    };
+
+public:
+    explicit ExtractNatives(LaunchTask *parent);
+    virtual ~ExtractNatives();
 
     void executeTask() override;
     bool canAbort() const override
@@ -33,6 +42,12 @@ public:
         return false;
     }
     void finalize() override;
+
+private slots:
+    void extractFinished();
+
+private:
+    QFutureWatcher<Prepared> m_watcher;
 };
 
 
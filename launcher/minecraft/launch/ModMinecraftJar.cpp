@@ -18,8 +18,196 @@
 #include "MMCZip.h"
 #include "minecraft/OpSys.h"
 #include "FileSystem.h"
+#include "FileHashCache.h"
 #include "minecraft/MinecraftInstance.h"
 #include "minecraft/PackProfile.h"
+#include "tasks/Tracer.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDirIterator>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrentRun>
+
+namespace {
+// bump this when the way the jar is put together changes, so old jars aren't used anymore
+const char *jarVersion = "1";
+
+/*
+ * What a modded jar was made from: the cache key and the hashes of the files that went into it.
+ * Kept next to the jar, so the files only have to be hashed again when they change.
+ */
+struct Stamp
+{
+    QByteArray key;
+    QJsonObject files;
+};
+
+QString stampPath(const QString &jarPath)
+{
+    return jarPath + ".json";
+}
+
+Stamp loadStamp(const QString &jarPath)
+{
+    Stamp stamp;
+    QFile file(stampPath(jarPath));
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return stamp;
+    }
+    auto root = QJsonDocument::fromJson(file.readAll()).object();
+    stamp.key = root.value("key").toString().toLatin1();
+    stamp.files = root.value("files").toObject();
+    return stamp;
+}
+
+void saveStamp(const QString &jarPath, const Stamp &stamp)
+{
+    QJsonObject root;
+    root.insert("key", QString::fromLatin1(stamp.key));
+    root.insert("files", stamp.files);
+    try
+    {
+        FS::write(stampPath(jarPath), QJsonDocument(root).toJson(QJsonDocument::Compact));
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << e.what();
+    }
+}
+
+// folder mods are only told apart by the names, sizes and modification times of their files
+QByteArray folderHash(const QString &path)
+{
+    QDir dir(path);
+    QStringList entries;
+    QDirIterator iter(path, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while(iter.hasNext())
+    {
+        iter.next();
+        auto info = iter.fileInfo();
+        entries.append(QString("%1:%2:%3")
+            .arg(dir.relativeFilePath(info.absoluteFilePath()))
+            .arg(info.size())
+            .arg(info.lastModified().toMSecsSinceEpoch()));
+    }
+    entries.sort();
+    return QCryptographicHash::hash(entries.join('\n').toUtf8(), QCryptographicHash::Sha1);
+}
+
+// the key of the jar made from the source jar and the mods, empty if one of them can't be read
+QByteArray jarKey(const QString &sourceJarPath, const QList<Mod> &mods, FileHashCache &hashes)
+{
+    QCryptographicHash key(QCryptographicHash::Sha1);
+    key.addData(jarVersion);
+    auto sourceHash = hashes.hash(sourceJarPath);
+    if(sourceHash.isEmpty())
+    {
+        return QByteArray();
+    }
+    key.addData(sourceHash);
+    // later mods win over earlier ones, so the order matters
+    for(auto &mod: mods)
+    {
+        if(!mod.enabled())
+        {
+            continue;
+        }
+        QByteArray hash;
+        if(mod.type() == Mod::MOD_FOLDER)
+        {
+            hash = folderHash(mod.filename().absoluteFilePath());
+        }
+        else
+        {
+            hash = hashes.hash(mod.filename().absoluteFilePath());
+        }
+        if(hash.isEmpty())
+        {
+            return QByteArray();
+        }
+        key.addData(QString("%1:%2:").arg(int(mod.type())).arg(mod.filename().fileName()).toUtf8());
+        key.addData(hash);
+    }
+    return key.result().toHex();
+}
+
+bool removeJarAt(const QString &jarPath)
+{
+    QFile::remove(stampPath(jarPath));
+    QFile finalJar(jarPath);
+    if(finalJar.exists())
+    {
+        if(!finalJar.remove())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// put the jar together. Returns the error, or nothing.
+QString buildJar(const QString &sourceJarPath, const QString &finalJarPath, const QList<Mod> &jarMods, const Stamp &stamp)
+{
+    // nuke obsolete stripped jar(s) if needed
+    if(!removeJarAt(finalJarPath))
+    {
+        return QObject::tr("Couldn't remove stale jar file: %1").arg(finalJarPath);
+    }
+
+    // put the jar together next to the real one, so a half done jar is never mistaken for a good one
+    auto partJarPath = finalJarPath + ".part";
+    QFile::remove(partJarPath);
+    if(!MMCZip::createModdedJar(sourceJarPath, partJarPath, jarMods))
+    {
+        return QObject::tr("Failed to create the custom Minecraft jar file.");
+    }
+    if(!QFile::rename(partJarPath, finalJarPath))
+    {
+        QFile::remove(partJarPath);
+        return QObject::tr("Couldn't move the custom Minecraft jar file to %1").arg(finalJarPath);
+    }
+    if(!stamp.key.isEmpty())
+    {
+        saveStamp(finalJarPath, stamp);
+    }
+    return QString();
+}
+
+// make the jar, unless the one from the last launch is still good
+ModMinecraftJar::Made makeJar(QString sourceJarPath, QString finalJarPath, QList<Mod> jarMods)
+{
+    Tracer::Scope scope("makeJar", "launch");
+    ModMinecraftJar::Made made;
+    auto oldStamp = loadStamp(finalJarPath);
+    FileHashCache hashes;
+    hashes.fromJson(oldStamp.files);
+    Stamp stamp;
+    stamp.key = jarKey(sourceJarPath, jarMods, hashes);
+    // only the files that went into this jar are worth remembering
+    hashes.forgetUnused();
+    stamp.files = hashes.toJson();
+    if(!stamp.key.isEmpty() && stamp.key == oldStamp.key && QFileInfo(finalJarPath).isFile())
+    {
+        made.reused = true;
+        return made;
+    }
+    made.error = buildJar(sourceJarPath, finalJarPath, jarMods, stamp);
+    return made;
+}
+}
+
+ModMinecraftJar::ModMinecraftJar(LaunchTask *parent) : LaunchStep(parent)
+{
+    connect(&m_watcher, &QFutureWatcher<Made>::finished, this, &ModMinecraftJar::jarFinished);
+}
+
+ModMinecraftJar::~ModMinecraftJar()
+{
+    m_watcher.waitForFinished();
+}
 
 void ModMinecraftJar::executeTask()
 {
@@ -27,56 +215,47 @@ void ModMinecraftJar::executeTask()
 
     if(!m_inst->getJarMods().size())
     {
+        // a jar from back when there were jar mods isn't used anymore
+        removeJar();
         emitSucceeded();
         return;
     }
-    // nuke obsolete stripped jar(s) if needed
     if(!FS::ensureFolderPathExists(m_inst->binRoot()))
     {
         emitFailed(tr("Couldn't create the bin folder for Minecraft.jar"));
+        return;
     }
 
     auto finalJarPath = QDir(m_inst->binRoot()).absoluteFilePath("minecraft.jar");
-    if(!removeJar())
-    {
-        emitFailed(tr("Couldn't remove stale jar file: %1").arg(finalJarPath));
-    }
-
-    // create temporary modded jar, if needed
     auto components = m_inst->getPackProfile();
     auto profile = components->getProfile();
     auto jarMods = m_inst->getJarMods();
-    if(jarMods.size())
-    {
-        auto mainJar = profile->getMainJar();
-        QStringList jars, temp1, temp2, temp3, temp4;
-        mainJar->getApplicableFiles(currentSystem, jars, temp1, temp2, temp3, m_inst->getLocalLibraryPath());
-        auto sourceJarPath = jars[0];
-        if(!MMCZip::createModdedJar(sourceJarPath, finalJarPath, jarMods))
-        {
-            emitFailed(tr("Failed to create the custom Minecraft jar file."));
-            return;
-        }
-    }
-    emitSucceeded();
+    auto mainJar = profile->getMainJar();
+    QStringList jars, temp1, temp2, temp3;
+    mainJar->getApplicableFiles(currentSystem, jars, temp1, temp2, temp3, m_inst->getLocalLibraryPath());
+    auto sourceJarPath = jars[0];
+
+    // hashing and repacking jars takes a while, the other steps don't have to wait for it
+    m_watcher.setFuture(QtConcurrent::run(makeJar, sourceJarPath, finalJarPath, jarMods));
 }
 
-void ModMinecraftJar::finalize()
+void ModMinecraftJar::jarFinished()
 {
-    removeJar();
+    auto made = m_watcher.result();
+    if(!made.error.isEmpty())
+    {
+        emitFailed(made.error);
+        return;
+    }
+    if(made.reused)
+    {
+        emit logLine(tr("Using the custom Minecraft jar from an earlier launch."), MessageLevel::Launcher);
+    }
+    emitSucceeded();
 }
 
 bool ModMinecraftJar::removeJar()
 {
     auto m_inst = std::dynamic_pointer_cast<MinecraftInstance>(m_parent->instance());
-    auto finalJarPath = QDir(m_inst->binRoot()).absoluteFilePath("minecraft.jar");
-    QFile finalJar(finalJarPath);
-    if(finalJar.exists())
-    {
-        if(!finalJar.remove())
-        {
-            return false;
-        }
-    }
-    return true;
+    return removeJarAt(QDir(m_inst->binRoot()).absoluteFilePath("minecraft.jar"));
 }
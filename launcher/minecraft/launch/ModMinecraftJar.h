@@ -17,20 +17,36 @@
 
 #include <launch/LaunchStep.h>
 #include <memory>
+#include <QFutureWatcher>
 
 class ModMinecraftJar: public LaunchStep
 {
     Q_OBJECT
 public:
-    explicit ModMinecraftJar(LaunchTask *parent) : LaunchStep(parent) {};
-    virtual ~ModMinecraftJar(){};
+    struct Made
+    {
+        /// the jar of an earlier launch was still good
+        bool reused = false;
+        /// empty if the jar is ready
+        QString error;
+    };
+
+public:
+    explicit ModMinecraftJar(LaunchTask *parent);
+    virtual ~ModMinecraftJar();
 
     virtual void executeTask() override;
     virtual bool canAbort() const override
     {
         return false;
     }
-    void finalize() override;
+
+private slots:
+    void jarFinished();
+
 private:
     bool removeJar();
+
+private:
+    QFutureWatcher<Made> m_watcher;
 };
@@ -0,0 +1,93 @@
+#include "PrefetchGameFiles.h"
+#include <launch/LaunchTask.h>
+#include <minecraft/MinecraftInstance.h>
+#include <minecraft/PackProfile.h>
+#include <minecraft/NativesStore.h>
+#include "FileSystem.h"
+#include "tasks/Tracer.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QtConcurrentRun>
+
+namespace {
+PrefetchGameFiles::Prefetched prefetch(QStringList files, QStringList nativeJars, NativesStore::Options options)
+{
+    Tracer::Scope scope("Prefetch game files", "launch");
+    QElapsedTimer timer;
+    timer.start();
+    if(!nativeJars.isEmpty())
+    {
+        // extracted by an earlier launch, a fresh extraction is in the cache anyway.
+        // working out the folder may read the native jars, so that happens here too.
+        auto natives = NativesStore::folderFor(nativeJars, options);
+        for(auto &info: QDir(natives).entryInfoList(QDir::Files))
+        {
+            files.append(info.absoluteFilePath());
+        }
+    }
+    PrefetchGameFiles::Prefetched prefetched;
+    for(auto &file: files)
+    {
+        auto size = FS::readAhead(file);
+        if(size < 0)
+        {
+            continue;
+        }
+        prefetched.files++;
+        prefetched.bytes += size;
+    }
+    prefetched.milliseconds = timer.elapsed();
+    return prefetched;
+}
+
+// the mods the game loads, the disabled ones are left alone
+void appendMods(QStringList &files, const QString &folder)
+{
+    for(auto &info: QDir(folder).entryInfoList(QDir::Files))
+    {
+        if(info.suffix() == "disabled")
+        {
+            continue;
+        }
+        files.append(info.absoluteFilePath());
+    }
+}
+}
+
+PrefetchGameFiles::PrefetchGameFiles(LaunchTask *parent) : LaunchStep(parent)
+{
+    connect(&m_watcher, &QFutureWatcher<Prefetched>::finished, this, &PrefetchGameFiles::prefetchFinished);
+}
+
+PrefetchGameFiles::~PrefetchGameFiles()
+{
+    m_watcher.waitForFinished();
+}
+
+void PrefetchGameFiles::executeTask()
+{
+    auto instance = m_parent->instance();
+    std::shared_ptr<MinecraftInstance> minecraftInstance = std::dynamic_pointer_cast<MinecraftInstance>(instance);
+
+    // in the order the game gets to them
+    auto files = minecraftInstance->getClassPath();
+    auto assets = minecraftInstance->getPackProfile()->getProfile()->getMinecraftAssets();
+    if(assets)
+    {
+        files.append(QDir(FS::PathCombine("assets/indexes", assets->id + ".json")).absolutePath());
+    }
+    appendMods(files, minecraftInstance->modsRoot());
+
+    auto nativeJars = minecraftInstance->getNativeJars();
+    m_watcher.setFuture(QtConcurrent::run(prefetch, files, nativeJars, minecraftInstance->getNativesOptions()));
+}
+
+void PrefetchGameFiles::prefetchFinished()
+{
+    auto prefetched = m_watcher.result();
+    emit logLine(tr("Prefetched %1 files (%2 MiB) in %3 ms.")
+        .arg(prefetched.files)
+        .arg(prefetched.bytes / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(prefetched.milliseconds), MessageLevel::Launcher);
+    emitSucceeded();
+}
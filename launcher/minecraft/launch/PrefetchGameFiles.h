@@ -0,0 +1,35 @@
+#pragma once
+
+#include <launch/LaunchStep.h>
+#include <QFutureWatcher>
+
+/*
+ * Gets the system to read the files the game starts with while the rest of the launch is prepared, so they are read
+ * in one go instead of bit by bit as Java needs them. That matters most on spinning disks and network home folders.
+ */
+class PrefetchGameFiles: public LaunchStep
+{
+    Q_OBJECT
+public:
+    explicit PrefetchGameFiles(LaunchTask *parent);
+    virtual ~PrefetchGameFiles();
+
+    void executeTask() override;
+    bool canAbort() const override
+    {
+        return false;
+    }
+
+    struct Prefetched
+    {
+        int files = 0;
+        qint64 bytes = 0;
+        qint64 milliseconds = 0;
+    };
+
+private slots:
+    void prefetchFinished();
+
+private:
+    QFutureWatcher<Prefetched> m_watcher;
+};
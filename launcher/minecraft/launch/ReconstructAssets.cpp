@@ -19,6 +19,18 @@
 #include "minecraft/AssetsUtils.h"
 #include "launch/LaunchTask.h"
 
+#include <QtConcurrentRun>
+
+ReconstructAssets::ReconstructAssets(LaunchTask *parent) : LaunchStep(parent)
+{
+    connect(&m_watcher, &QFutureWatcher<bool>::finished, this, &ReconstructAssets::reconstructFinished);
+}
+
+ReconstructAssets::~ReconstructAssets()
+{
+    m_watcher.waitForFinished();
+}
+
 void ReconstructAssets::executeTask()
 {
     auto instance = m_parent->instance();
@@ -27,7 +39,13 @@ void ReconstructAssets::executeTask()
     auto profile = components->getProfile();
     auto assets = profile->getMinecraftAssets();
 
-    if(!AssetsUtils::reconstructAssets(assets->id, minecraftInstance->resourcesDir()))
+    // thousands of files, don't make the window wait for them
+    m_watcher.setFuture(QtConcurrent::run(AssetsUtils::reconstructAssets, assets->id, minecraftInstance->resourcesDir()));
+}
+
+void ReconstructAssets::reconstructFinished()
+{
+    if(!m_watcher.result())
     {
         emit logLine("Failed to reconstruct Minecraft assets.", MessageLevel::Error);
     }
@@ -17,17 +17,24 @@
 
 #include <launch/LaunchStep.h>
 #include <memory>
+#include <QFutureWatcher>
 
 class ReconstructAssets: public LaunchStep
 {
     Q_OBJECT
 public:
-    explicit ReconstructAssets(LaunchTask *parent) : LaunchStep(parent){};
-    virtual ~ReconstructAssets(){};
+    explicit ReconstructAssets(LaunchTask *parent);
+    virtual ~ReconstructAssets();
 
     void executeTask() override;
     bool canAbort() const override
     {
         return false;
     }
+
+private slots:
+    void reconstructFinished();
+
+private:
+    QFutureWatcher<bool> m_watcher;
 };
@@ -7,13 +7,24 @@
 
 #include "Application.h"
 
-AssetUpdateTask::AssetUpdateTask(MinecraftInstance * inst)
+#include <QtConcurrentMap>
+
+AssetUpdateTask::AssetUpdateTask(MinecraftInstance * inst, bool deepVerify)
 {
     m_inst = inst;
+    m_deepVerify = deepVerify;
+    connect(&m_verifyWatcher, &QFutureWatcher<bool>::progressValueChanged, this, [this](int value)
+    {
+        setProgress(value, m_verifyObjects.size());
+    });
+    connect(&m_verifyWatcher, &QFutureWatcher<bool>::finished, this, &AssetUpdateTask::verifyFinished);
 }
 
 AssetUpdateTask::~AssetUpdateTask()
 {
+    // the workers use the list of objects
+    m_verifyWatcher.cancel();
+    m_verifyWatcher.waitForFinished();
 }
 
 void AssetUpdateTask::executeTask()
@@ -56,24 +67,56 @@ bool AssetUpdateTask::canAbort() const
 
 void AssetUpdateTask::assetIndexFinished()
 {
-    AssetsIndex index;
     qDebug() << m_inst->name() << ": Finished asset index download";
 
     auto components = m_inst->getPackProfile();
     auto profile = components->getProfile();
     auto assets = profile->getMinecraftAssets();
 
-    QString asset_fname = "assets/indexes/" + assets->id + ".json";
     // FIXME: this looks like a job for a generic validator based on json schema?
-    if (!AssetsUtils::loadAssetsIndexJson(assets->id, asset_fname, index))
+    m_index = AssetsUtils::loadAssetsIndex(assets->id);
+    if (!m_index)
     {
         auto metacache = APPLICATION->metacache();
         auto entry = metacache->resolveEntry("asset_indexes", assets->id + ".json");
         metacache->evictEntry(entry);
         emitFailed(tr("Failed to read the assets index!"));
+        return;
     }
 
-    auto job = index.getDownloadJob();
+    if(m_deepVerify)
+    {
+        // the same object can be there under many names
+        QMap<QString, AssetObject> unique;
+        for(int i = 0; i < m_index->size(); i++)
+        {
+            auto object = m_index->object(i);
+            unique.insert(object.hash, object);
+        }
+        m_verifyObjects = unique.values();
+        setStatus(tr("Verifying assets..."));
+        m_verifyWatcher.setFuture(QtConcurrent::mapped(m_verifyObjects, AssetsUtils::verifyObject));
+        return;
+    }
+    startAssetsDownload();
+}
+
+void AssetUpdateTask::verifyFinished()
+{
+    if(m_verifyWatcher.isCanceled())
+    {
+        emitAborted();
+        return;
+    }
+    auto results = m_verifyWatcher.future().results();
+    qDebug() << m_inst->name() << ":" << results.count(true) << "of" << results.size() << "asset objects are intact";
+    m_verifyObjects.clear();
+    startAssetsDownload();
+}
+
+void AssetUpdateTask::startAssetsDownload()
+{
+    auto job = m_index->getDownloadJob();
     if(job)
     {
         setStatus(tr("Getting the assets files from Mojang..."));
@@ -100,6 +143,11 @@ void AssetUpdateTask::assetsFailed(QString reason)
 
 bool AssetUpdateTask::abort()
 {
+    if(m_verifyWatcher.isRunning())
+    {
+        m_verifyWatcher.cancel();
+        return true;
+    }
     if(downloadJob)
     {
         return downloadJob->abort();
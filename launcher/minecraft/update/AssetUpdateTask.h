@@ -1,13 +1,17 @@
 #pragma once
 #include "tasks/Task.h"
 #include "net/NetJob.h"
+#include "minecraft/AssetsUtils.h"
+
+#include <QFutureWatcher>
 class MinecraftInstance;
 
 class AssetUpdateTask : public Task
 {
     Q_OBJECT
 public:
-    AssetUpdateTask(MinecraftInstance * inst);
+    /// with deepVerify, every asset object already there is hashed to find broken ones
+    AssetUpdateTask(MinecraftInstance * inst, bool deepVerify = false);
     virtual ~AssetUpdateTask();
 
     void executeTask() override;
@@ -18,11 +22,19 @@ private slots:
     void assetIndexFinished();
     void assetIndexFailed(QString reason);
     void assetsFailed(QString reason);
+    void verifyFinished();
 
 public slots:
     bool abort() override;
 
+private:
+    void startAssetsDownload();
+
 private:
     MinecraftInstance *m_inst;
     NetJob::Ptr downloadJob;
+    std::shared_ptr<const AssetsIndex> m_index;
+    bool m_deepVerify = false;
+    QList<AssetObject> m_verifyObjects;
+    QFutureWatcher<bool> m_verifyWatcher;
 };
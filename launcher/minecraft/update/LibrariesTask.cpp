@@ -5,6 +5,8 @@
 
 #include "Application.h"
 
+#include <QPointer>
+
 LibrariesTask::LibrariesTask(MinecraftInstance * inst)
 {
     m_inst = inst;
@@ -13,6 +15,37 @@ LibrariesTask::LibrariesTask(MinecraftInstance * inst)
 void LibrariesTask::executeTask()
 {
     setStatus(tr("Getting the library files from Mojang..."));
+    auto profile = m_inst->getPackProfile()->getProfile();
+
+    // check the cached files first. Files that changed on disk are hashed on worker threads instead of in here.
+    QStringList cachePaths;
+    QList<LibraryPtr> libs;
+    libs.append(profile->getLibraries());
+    libs.append(profile->getNativeLibraries());
+    libs.append(profile->getMavenFiles());
+    libs.append(profile->getMainJar());
+    for (auto lib : libs)
+    {
+        if(lib)
+        {
+            cachePaths.append(lib->getCachePaths(currentSystem));
+        }
+    }
+    m_resolving = true;
+    QPointer<LibrariesTask> self(this);
+    APPLICATION->metacache()->resolveEntries("libraries", cachePaths, [self](QList<MetaEntryPtr>)
+    {
+        if(!self || !self->m_resolving)
+        {
+            return;
+        }
+        self->m_resolving = false;
+        self->startDownloads();
+    });
+}
+
+void LibrariesTask::startDownloads()
+{
     qDebug() << m_inst->name() << ": downloading libraries";
     MinecraftInstance *inst = (MinecraftInstance *)m_inst;
 
@@ -21,11 +54,14 @@ void LibrariesTask::executeTask()
     auto profile = components->getProfile();
 
     auto job = new NetJob(tr("Libraries for instance %1").arg(inst->name()), APPLICATION->network());
+    // start the big jars early, they take longest
+    job->setSchedulingPolicy(NetJob::SchedulingPolicy::LargestFirst);
     downloadJob.reset(job);
 
     auto metacache = APPLICATION->metacache();
 
-    auto processArtifactPool = [&](const QList<LibraryPtr> & pool, QStringList & errors, const QString & localPath)
+    auto processArtifactPool = [&](const QList<LibraryPtr> & pool, QStringList & errors, const QString & localPath,
+                                   NetPriority priority)
     {
         for (auto lib : pool)
         {
@@ -37,6 +73,7 @@ void LibrariesTask::executeTask()
             auto dls = lib->getDownloads(currentSystem, metacache.get(), errors, localPath);
             for(auto dl : dls)
             {
+                dl->m_priority = priority;
                 downloadJob->addNetAction(dl);
             }
         }
@@ -48,11 +85,12 @@ void LibrariesTask::executeTask()
     libArtifactPool.append(profile->getLibraries());
     libArtifactPool.append(profile->getNativeLibraries());
     libArtifactPool.append(profile->getMavenFiles());
-    libArtifactPool.append(profile->getMainJar());
-    processArtifactPool(libArtifactPool, failedLocalLibraries, inst->getLocalLibraryPath());
+    processArtifactPool(libArtifactPool, failedLocalLibraries, inst->getLocalLibraryPath(), NetPriority::Normal);
+    // nothing runs without the game itself
+    processArtifactPool({profile->getMainJar()}, failedLocalLibraries, inst->getLocalLibraryPath(), NetPriority::Critical);
 
     QStringList failedLocalJarMods;
-    processArtifactPool(profile->getJarMods(), failedLocalJarMods, inst->jarModsDir());
+    processArtifactPool(profile->getJarMods(), failedLocalJarMods, inst->jarModsDir(), NetPriority::Normal);
 
     if (!failedLocalJarMods.empty() || !failedLocalLibraries.empty())
     {
@@ -80,6 +118,12 @@ void LibrariesTask::jarlibFailed(QString reason)
 
 bool LibrariesTask::abort()
 {
+    if(m_resolving)
+    {
+        m_resolving = false;
+        emitAborted();
+        return true;
+    }
     if(downloadJob)
     {
         return downloadJob->abort();
@@ -17,10 +17,15 @@ public:
 private slots:
     void jarlibFailed(QString reason);
 
+private:
+    void startDownloads();
+
 public slots:
     bool abort() override;
 
 private:
     MinecraftInstance *m_inst;
     NetJob::Ptr downloadJob;
+    /// true while the cache entries are being checked, before the download job exists
+    bool m_resolving = false;
 };
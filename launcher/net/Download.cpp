@@ -17,16 +17,45 @@
 
 #include <QFileInfo>
 #include <QDateTime>
+#include <QLocale>
 #include <QDebug>
 
 #include "FileSystem.h"
-#include "Application.h"
 #include "ChecksumValidator.h"
 #include "MetaCacheSink.h"
 #include "ByteArraySink.h"
+#include "XzDecompressSink.h"
+#include "DownloadCoordinator.h"
+#include "MirrorSelector.h"
+#include "settings/SettingsObject.h"
 
 #include "BuildConfig.h"
 
+namespace {
+// Retry-After is either a number of seconds or an HTTP date. Returns milliseconds to wait, -1 if there is nothing usable.
+qint64 parseRetryAfter(const QByteArray &header)
+{
+    auto value = QString::fromLatin1(header).trimmed();
+    if(value.isEmpty())
+    {
+        return -1;
+    }
+    bool ok = false;
+    qint64 seconds = value.toLongLong(&ok);
+    if(ok)
+    {
+        return seconds >= 0 ? seconds * 1000 : -1;
+    }
+    auto date = QLocale::c().toDateTime(value, "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+    if(!date.isValid())
+    {
+        return -1;
+    }
+    date.setTimeSpec(Qt::UTC);
+    return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date));
+}
+}
+
 namespace Net {
 
 Download::Download():NetAction()
@@ -34,6 +63,15 @@ Download::Download():NetAction()
     m_status = Job_NotStarted;
 }
 
+Download::~Download()
+{
+    // don't leave subscribers of a transfer that will never finish behind
+    if(m_status == Job_InProgress)
+    {
+        finishTransfer(Job_Failed);
+    }
+}
+
 Download::Ptr Download::makeCached(QUrl url, MetaEntryPtr entry, Options options)
 {
     Download * dl = new Download();
@@ -41,7 +79,7 @@ Download::Ptr Download::makeCached(QUrl url, MetaEntryPtr entry, Options options
     dl->m_options = options;
     auto md5Node = new ChecksumValidator(QCryptographicHash::Md5);
     auto cachedNode = new MetaCacheSink(entry, md5Node);
-    dl->m_sink.reset(cachedNode);
+    dl->setSink(cachedNode);
     dl->m_target_path = entry->getFullPath();
     return dl;
 }
@@ -51,7 +89,7 @@ Download::Ptr Download::makeByteArray(QUrl url, QByteArray *output, Options opti
     Download * dl = new Download();
     dl->m_url = url;
     dl->m_options = options;
-    dl->m_sink.reset(new ByteArraySink(output));
+    dl->setSink(new ByteArraySink(output));
     return dl;
 }
 
@@ -60,15 +98,85 @@ Download::Ptr Download::makeFile(QUrl url, QString path, Options options)
     Download * dl = new Download();
     dl->m_url = url;
     dl->m_options = options;
-    dl->m_sink.reset(new FileSink(path));
+    dl->setSink(new FileSink(path));
+    dl->m_target_path = path;
     return dl;
 }
 
+void Download::setSink(Sink *sink)
+{
+    m_content_sink = sink;
+    if(m_options & Option::DecompressXz)
+    {
+        sink = new XzDecompressSink(sink);
+    }
+    m_sink.reset(sink);
+}
+
 void Download::addValidator(Validator * v)
+{
+    m_content_sink->addValidator(v);
+}
+
+void Download::addTransferValidator(Validator * v)
 {
     m_sink->addValidator(v);
 }
 
+QList<DownloadSource> Download::rankedMirrors(const Services &services)
+{
+    auto settings = services.settings;
+    if(!settings)
+    {
+        return {DownloadSource("Mojang", QString(), "Mojang", false)};
+    }
+    DownloadSource preferred;
+    if(!settings->get("DownloadsourceAuto").toBool())
+    {
+        preferred = DownloadSource(
+            QString(),
+            settings->get("Downloadsourceurl").toString(),
+            settings->get("Downloadsource").toString(),
+            settings->get("Downloadsourceproxy").toBool()
+        );
+    }
+    return services.mirrors->ranked(preferred);
+}
+
+const Services &Download::services()
+{
+    if(!m_services.isValid())
+    {
+        // not given by a job
+        m_services = Services::application();
+    }
+    return m_services;
+}
+
+DownloadSource Download::currentMirror()
+{
+    if(m_mirrors.isEmpty())
+    {
+        // not picked by a job
+        m_mirrors = rankedMirrors(services());
+    }
+    return m_mirrors[m_mirror_attempt % m_mirrors.size()];
+}
+
+QUrl Download::requestedUrl()
+{
+    if(!m_redirect_url.isEmpty())
+    {
+        return m_redirect_url;
+    }
+    return m_source_url.isEmpty() ? m_url : m_source_url;
+}
+
+QUrl Download::effectiveUrl()
+{
+    return MirrorSelector::rewrite(requestedUrl(), currentMirror());
+}
+
 void Download::startImpl()
 {
     if(m_status == Job_Aborted)
@@ -77,80 +185,63 @@ void Download::startImpl()
         emit aborted(m_index_within_job);
         return;
     }
-    QString source = "Mojang";
-    if(APPLICATION->getconfigfile()){
-        source = APPLICATION->settings()->get("Downloadsource").toString();
+    m_failure = NetFailure::None;
+    m_finish_pending = false;
+    m_retry_after = -1;
+    m_error_string.clear();
+    m_http_status = 0;
+    m_cache_hit = false;
+    m_shared = false;
+    m_ttfb = -1;
+    m_transfer_msecs = 0;
+    if(m_source_url.isEmpty())
+    {
+        m_source_url = m_url;
     }
+    m_mirror = currentMirror();
+    m_mirror_name = m_mirror.getName();
+    m_url = MirrorSelector::rewrite(requestedUrl(), m_mirror);
+    m_coordinator = services().coordinator;
 
-    if (source != "Mojang")
+    // the same file may already be on its way, for another job
+    if(m_transfer_key.isEmpty() && !m_target_path.isEmpty())
     {
-        auto settings = APPLICATION->settings();
-        bool useProxy = settings->get("Downloadsourceproxy").toBool();
-        QString baseUrl = settings->get("Downloadsourceurl").toString().trimmed();
-        if (!baseUrl.isEmpty())
-        {
-            baseUrl = QUrl::fromUserInput(baseUrl).toString();
-            if (!baseUrl.startsWith("https://"))
-            {
-                baseUrl = baseUrl.replace("http://", "https://");
-            }
-            if (!baseUrl.endsWith("/"))
-            {
-                baseUrl.append('/');
-            }
-        }
-
-        QString host = m_url.toString();
-        struct Replacement {
-            QString search, replace;
-        };
-        Replacement replacements[] = {
-            {"resources.download.minecraft.net", "<j_url>/assets"},
-            {"libraries.minecraft.net", "<j_url>/maven"},
-            {"maven.fabricmc.net", "<j_url>/maven"},
-            {"launchermeta.mojang.com", "<j_url>"},
-            {"launcher.mojang.com", "<j_url>"},
-            {"files.minecraftforge.net", "<j_url>"},
-            {"meta.fabricmc.net", "<j_url>/fabric-meta"},
-            {"maven.neoforged.net/releases", "<j_url>/maven"},
-            {"maven.quiltmc.org/repository/release","<j_url>/maven"},
-            {"meta.quiltmc.org","<j_url>/quilt-meta"},
-            {"edge.forgecdn.net",""},
-            {"mediafilez.forgecdn.net",""}
-        };
-        for (const auto &replacement : replacements)
+        auto key = DownloadCoordinator::transferKey(m_source_url, m_target_path);
+        if(m_coordinator->subscribe(key, this))
         {
-            if (host.contains(replacement.search) && !host.contains(baseUrl))
-            {
-                QString replacementUrl = baseUrl.isEmpty() ? "" : baseUrl + replacement.replace;
-                if (useProxy && !baseUrl.isEmpty())
-                {
-                    m_url = QUrl(baseUrl + host);
-                }
-                else if (!replacementUrl.isEmpty())
-                {
-                    host.replace(replacement.search, replacementUrl);
-                    m_url = QUrl(host);
-                    break;
-                }
-            }
+            qDebug() << "Download already in progress, waiting for it:" << m_url.toString();
+            m_transfer_key = key;
+            m_subscribed = true;
+            m_status = Job_InProgress;
+            return;
         }
     }
 
     QNetworkRequest request(m_url);
+    m_headers_handled = false;
     m_status = m_sink->init(request);
     switch(m_status)
     {
         case Job_Finished:
+            m_cache_hit = true;
             emit succeeded(m_index_within_job);
             qDebug() << "Download cache hit " << m_url.toString();
             return;
         case Job_InProgress:
             qDebug() << "Downloading " << m_url.toString();
+            // redirects keep the original transfer key, subscribers wait for the final result
+            if(m_transfer_key.isEmpty() && !m_target_path.isEmpty())
+            {
+                m_transfer_key = DownloadCoordinator::transferKey(m_source_url, m_target_path);
+                m_coordinator->lead(m_transfer_key, this);
+            }
+            m_transfer_timer.start();
             break;
         case Job_Failed_Proceed: // this is meaningless in this context. We do need a sink.
         case Job_NotStarted:
         case Job_Failed:
+            m_failure = NetFailure::Local;
+            m_error_string = tr("Could not prepare the download target");
             emit failed(m_index_within_job);
             return;
         case Job_Aborted:
@@ -158,11 +249,20 @@ void Download::startImpl()
     }
 
     request.setHeader(QNetworkRequest::UserAgentHeader, BuildConfig.USER_AGENT);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    // lets many small transfers to the same host share one connection
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#endif
     for(auto iter = m_extra_headers.begin(); iter != m_extra_headers.end(); iter++) {
         request.setRawHeader(iter.key().toUtf8(), iter.value().toUtf8());
     }
 
     QNetworkReply *rep = m_network->get(request);
+    if(m_coordinator->bandwidthLimited())
+    {
+        // keep Qt from buffering data we are not allowed to take yet
+        rep->setReadBufferSize(64 * 1024);
+    }
 
     m_reply.reset(rep);
     connect(rep, SIGNAL(downloadProgress(qint64, qint64)), SLOT(downloadProgress(qint64, qint64)));
@@ -170,6 +270,7 @@ void Download::startImpl()
     connect(rep, SIGNAL(error(QNetworkReply::NetworkError)), SLOT(downloadError(QNetworkReply::NetworkError)));
     connect(rep, &QNetworkReply::sslErrors, this, &Download::sslErrors);
     connect(rep, &QNetworkReply::readyRead, this, &Download::downloadReadyRead);
+    connect(rep, &QNetworkReply::metaDataChanged, this, &Download::downloadMetaDataChanged);
 }
 
 void Download::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
@@ -177,6 +278,51 @@ void Download::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
     m_total_progress = bytesTotal;
     m_progress = bytesReceived;
     emit netActionProgress(m_index_within_job, bytesReceived, bytesTotal);
+    if(!m_subscribed && !m_transfer_key.isEmpty())
+    {
+        m_coordinator->progress(m_transfer_key, bytesReceived, bytesTotal);
+    }
+}
+
+void Download::finishTransfer(JobStatus status)
+{
+    if(m_transfer_key.isEmpty())
+    {
+        return;
+    }
+    auto key = m_transfer_key;
+    m_transfer_key.clear();
+    if(m_subscribed)
+    {
+        m_subscribed = false;
+        m_coordinator->unsubscribe(key, this);
+    }
+    else
+    {
+        m_coordinator->finished(key, status);
+    }
+}
+
+void Download::subscriptionFinished(JobStatus status)
+{
+    m_transfer_key.clear();
+    m_subscribed = false;
+    if(status == Job_Finished)
+    {
+        m_status = Job_Finished;
+        m_shared = true;
+        qDebug() << "Download finished by another job:" << m_url.toString();
+        emit succeeded(m_index_within_job);
+    }
+    else
+    {
+        // let our own job retry, we may get to do the transfer ourselves
+        m_status = Job_Failed;
+        m_failure = NetFailure::Transient;
+        m_error_string = tr("Shared transfer did not succeed");
+        qDebug() << "Download we were waiting for did not succeed:" << m_url.toString();
+        emit failed(m_index_within_job);
+    }
 }
 
 void Download::downloadError(QNetworkReply::NetworkError error)
@@ -199,6 +345,39 @@ void Download::downloadError(QNetworkReply::NetworkError error)
         // error happened during download.
         qCritical() << "Failed " << m_url.toString() << " with reason " << error;
         m_status = Job_Failed;
+        classifyFailure(error);
+        // being told to slow down says nothing about the mirror's health
+        if(m_failure != NetFailure::Throttled)
+        {
+            services().mirrors->reportFailure(m_mirror);
+        }
+    }
+}
+
+void Download::classifyFailure(QNetworkReply::NetworkError error)
+{
+    int statusCode = 0;
+    if(m_reply)
+    {
+        statusCode = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        m_error_string = statusCode ? QString("HTTP %1").arg(statusCode) : m_reply->errorString();
+    }
+    else
+    {
+        m_error_string = tr("Network error %1").arg(int(error));
+    }
+    if(statusCode == 429 || statusCode == 503)
+    {
+        m_failure = NetFailure::Throttled;
+        m_retry_after = parseRetryAfter(m_reply->rawHeader("Retry-After"));
+    }
+    else if(statusCode >= 400 && statusCode < 500 && statusCode != 408)
+    {
+        m_failure = NetFailure::Rejected;
+    }
+    else
+    {
+        m_failure = NetFailure::Transient;
     }
 }
 
@@ -270,15 +449,30 @@ bool Download::handleRedirect()
         qDebug() << "Location header:" << redirect;
     }
 
-    m_url = QUrl(redirect.toString());
+    // the redirect target goes through the same mirror rewriting as the requested URL
+    m_redirect_url = QUrl(redirect.toString());
+    m_url = m_redirect_url;
     qDebug() << "Following redirect to " << m_url.toString();
     start(m_network);
     return true;
 }
 
 
+void Download::downloadMetaDataChanged()
+{
+    if(m_ttfb < 0)
+    {
+        m_ttfb = m_transfer_timer.elapsed();
+    }
+}
+
 void Download::downloadFinished()
 {
+    m_http_status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    m_transfer_msecs = m_transfer_timer.elapsed();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    m_multiplexed = m_reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+#endif
     // handle HTTP redirection first
     if(handleRedirect())
     {
@@ -292,14 +486,28 @@ void Download::downloadFinished()
         qDebug() << "Download failed but we are allowed to proceed:" << m_url.toString();
         m_sink->abort();
         m_reply.reset();
+        finishTransfer(m_status);
         emit succeeded(m_index_within_job);
         return;
     }
     else if (m_status == Job_Failed)
     {
         qDebug() << "Download failed in previous step:" << m_url.toString();
+        if(!m_headers_handled)
+        {
+            // error responses without a body never got to the sink, it may have to act on them (like on a 416)
+            m_headers_handled = true;
+            m_sink->headersReceived(*m_reply.get());
+        }
         m_sink->abort();
         m_reply.reset();
+        finishTransfer(m_status);
+        // retry on the next mirror in line. Throttling hosts asked us to come back, not to go away.
+        if(m_failure != NetFailure::Throttled)
+        {
+            m_mirror_attempt++;
+        }
+        m_redirect_url.clear();
         emit failed(m_index_within_job);
         return;
     }
@@ -308,16 +516,38 @@ void Download::downloadFinished()
         qDebug() << "Download aborted in previous step:" << m_url.toString();
         m_sink->abort();
         m_reply.reset();
+        finishTransfer(m_status);
         emit aborted(m_index_within_job);
         return;
     }
 
-    // make sure we got all the remaining data, if any
-    auto data = m_reply->readAll();
-    if(data.size())
+    if(!m_headers_handled)
     {
-        qDebug() << "Writing extra" << data.size() << "bytes to" << m_target_path;
-        m_status = m_sink->write(data);
+        m_headers_handled = true;
+        m_status = m_sink->headersReceived(*m_reply.get());
+        if (m_status != Job_InProgress)
+        {
+            qDebug() << "Download response was not accepted:" << m_url.toString();
+            m_failure = NetFailure::Rejected;
+            m_error_string = tr("Unexpected response from the server");
+            m_sink->abort();
+            m_reply.reset();
+            finishTransfer(m_status);
+            m_mirror_attempt++;
+            m_redirect_url.clear();
+            emit failed(m_index_within_job);
+            return;
+        }
+    }
+
+    // make sure we got all the remaining data, if any. It counts against the bandwidth budget like the rest of it,
+    // downloadReadyRead comes back here once it is all written.
+    if(m_reply->bytesAvailable() > 0)
+    {
+        qDebug() << "Writing extra" << m_reply->bytesAvailable() << "bytes to" << m_target_path;
+        m_finish_pending = true;
+        downloadReadyRead();
+        return;
     }
 
     // otherwise, finalize the whole graph
@@ -325,24 +555,56 @@ void Download::downloadFinished()
     if (m_status != Job_Finished)
     {
         qDebug() << "Download failed to finalize:" << m_url.toString();
+        m_failure = NetFailure::Rejected;
+        m_error_string = tr("Downloaded data failed validation");
         m_sink->abort();
         m_reply.reset();
+        finishTransfer(m_status);
+        // the mirror gave us bad data, try another one
+        services().mirrors->reportFailure(m_mirror);
+        m_mirror_attempt++;
+        m_redirect_url.clear();
         emit failed(m_index_within_job);
         return;
     }
     m_reply.reset();
+    services().mirrors->reportSuccess(m_mirror, m_progress, m_transfer_timer.elapsed());
     qDebug() << "Download succeeded:" << m_url.toString();
+    finishTransfer(m_status);
     emit succeeded(m_index_within_job);
 }
 
 void Download::downloadReadyRead()
 {
+    if(!m_reply)
+    {
+        // woken up by the bandwidth budget after we were done
+        return;
+    }
+    if(m_status == Job_InProgress && !m_headers_handled)
+    {
+        m_headers_handled = true;
+        m_status = m_sink->headersReceived(*m_reply.get());
+        if(m_status != Job_InProgress)
+        {
+            m_failure = NetFailure::Rejected;
+            m_error_string = tr("Unexpected response from the server");
+        }
+    }
     if(m_status == Job_InProgress)
     {
-        auto data = m_reply->readAll();
+        auto wanted = m_reply->bytesAvailable();
+        auto allowed = m_coordinator->takeBandwidth(this, wanted);
+        if(allowed <= 0)
+        {
+            return;
+        }
+        auto data = m_reply->read(allowed);
         m_status = m_sink->write(data);
         if(m_status == Job_Failed)
         {
+            m_failure = NetFailure::Local;
+            m_error_string = tr("Could not write the downloaded data");
             qCritical() << "Failed to process response chunk for " << m_target_path;
         }
         // qDebug() << "Download" << m_url.toString() << "gained" << data.size() << "bytes";
@@ -351,12 +613,32 @@ void Download::downloadReadyRead()
     {
         qCritical() << "Cannot write to " << m_target_path << ", illegal status" << m_status;
     }
+    if(m_finish_pending && (m_status != Job_InProgress || !m_reply->bytesAvailable()))
+    {
+        m_finish_pending = false;
+        downloadFinished();
+    }
 }
 
 }
 
 bool Net::Download::abort()
 {
+    if(m_subscribed)
+    {
+        finishTransfer(Job_Aborted);
+        m_status = Job_Aborted;
+        emit aborted(m_index_within_job);
+        return true;
+    }
+    if(m_finish_pending)
+    {
+        // the reply is complete already, only the rest of its data was waiting for the bandwidth budget
+        m_finish_pending = false;
+        m_status = Job_Aborted;
+        downloadFinished();
+        return true;
+    }
     if(m_reply)
     {
         m_reply->abort();
@@ -21,42 +21,68 @@
 #include "Sink.h"
 
 #include <QMap>
+#include <QElapsedTimer>
+
+#include "DownloadSource.h"
 
 #include "QObjectPtr.h"
 
 namespace Net {
+class DownloadCoordinator;
+
 class Download : public NetAction
 {
     Q_OBJECT
+    friend class DownloadCoordinator;
 
 public: /* types */
     typedef shared_qobject_ptr<class Download> Ptr;
     enum class Option
     {
         NoOptions = 0,
-        AcceptLocalFiles = 1
+        AcceptLocalFiles = 1,
+        // the response is XZ compressed, store it decompressed
+        DecompressXz = 2
     };
     Q_DECLARE_FLAGS(Options, Option)
 
 protected: /* con/des */
     explicit Download();
 public:
-    virtual ~Download(){};
+    virtual ~Download();
     static Download::Ptr makeCached(QUrl url, MetaEntryPtr entry, Options options = Option::NoOptions);
     static Download::Ptr makeByteArray(QUrl url, QByteArray *output, Options options = Option::NoOptions);
     static Download::Ptr makeFile(QUrl url, QString path, Options options = Option::NoOptions);
 
+    /// the mirrors in the order attempts should go to them, with the one the user picked first
+    static QList<DownloadSource> rankedMirrors(const Services &services);
+
 public: /* methods */
     QString getTargetFilepath()
     {
         return m_target_path;
     }
+    // check the stored data (after decompression)
     void addValidator(Validator * v);
+    // check the data as it came over the network (before decompression)
+    void addTransferValidator(Validator * v);
+    QUrl effectiveUrl() override;
+    bool needsConnection() const override
+    {
+        return !m_subscribed;
+    }
     bool abort() override;
     bool canAbort() override;
 
 private: /* methods */
+    void setSink(Sink *sink);
+    const Services &services();
     bool handleRedirect();
+    void subscriptionFinished(JobStatus status);
+    DownloadSource currentMirror();
+    QUrl requestedUrl();
+    void finishTransfer(JobStatus status);
+    void classifyFailure(QNetworkReply::NetworkError error);
 
 protected slots:
     void downloadProgress(qint64 bytesReceived, qint64 bytesTotal) override;
@@ -64,6 +90,7 @@ protected slots:
     void sslErrors(const QList<QSslError> & errors);
     void downloadFinished() override;
     void downloadReadyRead() override;
+    void downloadMetaDataChanged();
 
 public slots:
     void startImpl() override;
@@ -72,7 +99,27 @@ private: /* data */
     // FIXME: remove this, it has no business being here.
     QString m_target_path;
     std::unique_ptr<Sink> m_sink;
+    // the sink that ends up with the file content, m_sink or the one it decompresses into
+    Sink *m_content_sink = nullptr;
     Options m_options;
+
+    /// the URL as requested, before any mirror was applied
+    QUrl m_source_url;
+    /// where the current attempt was redirected to, if anywhere
+    QUrl m_redirect_url;
+    /// the mirror used by the current attempt, and how many attempts failed over to the next mirror
+    DownloadSource m_mirror;
+    int m_mirror_attempt = 0;
+    QElapsedTimer m_transfer_timer;
+    /// the sink was told about the response headers of the current attempt
+    bool m_headers_handled = false;
+    /// the reply is complete, but the rest of its data is waiting for the bandwidth budget
+    bool m_finish_pending = false;
+
+    shared_qobject_ptr<DownloadCoordinator> m_coordinator;
+    /// key of the coordinated transfer this download leads or subscribes to
+    QString m_transfer_key;
+    bool m_subscribed = false;
 };
 }
 
@@ -0,0 +1,158 @@
+#include "DownloadCoordinator.h"
+#include "Download.h"
+
+#include <QDebug>
+
+#include "settings/Setting.h"
+#include "settings/SettingsObject.h"
+
+namespace {
+// the bandwidth budget is handed out in this many slices per second
+const int refillsPerSecond = 10;
+}
+
+namespace Net {
+
+DownloadCoordinator::DownloadCoordinator(std::shared_ptr<SettingsObject> settings, QObject *parent)
+    : QObject(parent), m_settings(settings)
+{
+    m_refillTimer.setInterval(1000 / refillsPerSecond);
+    connect(&m_refillTimer, &QTimer::timeout, this, &DownloadCoordinator::refillBandwidth);
+    if(m_settings)
+    {
+        connect(m_settings.get(), &SettingsObject::SettingChanged, this, &DownloadCoordinator::settingChanged);
+        connect(m_settings.get(), &SettingsObject::settingReset, this, &DownloadCoordinator::settingChanged);
+        setBandwidthLimit(m_settings->get("MaxDownloadSpeed").toLongLong() * 1024);
+    }
+}
+
+void DownloadCoordinator::settingChanged(const Setting &setting)
+{
+    if(setting.id() == "MaxDownloadSpeed")
+    {
+        setBandwidthLimit(m_settings->get("MaxDownloadSpeed").toLongLong() * 1024);
+    }
+}
+
+QString DownloadCoordinator::transferKey(const QUrl &url, const QString &targetPath)
+{
+    return url.toString() + '\n' + targetPath;
+}
+
+bool DownloadCoordinator::subscribe(const QString &key, Download *download)
+{
+    auto iter = m_transfers.find(key);
+    if(iter == m_transfers.end() || !iter->leader)
+    {
+        return false;
+    }
+    iter->subscribers.append(download);
+    m_merged++;
+    return true;
+}
+
+void DownloadCoordinator::unsubscribe(const QString &key, Download *download)
+{
+    auto iter = m_transfers.find(key);
+    if(iter == m_transfers.end())
+    {
+        return;
+    }
+    iter->subscribers.removeAll(download);
+}
+
+void DownloadCoordinator::lead(const QString &key, Download *leader)
+{
+    m_transfers[key].leader = leader;
+}
+
+void DownloadCoordinator::progress(const QString &key, qint64 bytesReceived, qint64 bytesTotal)
+{
+    auto iter = m_transfers.find(key);
+    if(iter == m_transfers.end())
+    {
+        return;
+    }
+    for(auto & subscriber: iter->subscribers)
+    {
+        if(subscriber)
+        {
+            subscriber->downloadProgress(bytesReceived, bytesTotal);
+        }
+    }
+}
+
+void DownloadCoordinator::finished(const QString &key, JobStatus status)
+{
+    auto iter = m_transfers.find(key);
+    if(iter == m_transfers.end())
+    {
+        return;
+    }
+    // take the subscribers out first, finishing them can start new transfers
+    auto subscribers = iter->subscribers;
+    m_transfers.erase(iter);
+    for(auto & subscriber: subscribers)
+    {
+        if(subscriber)
+        {
+            subscriber->subscriptionFinished(status);
+        }
+    }
+}
+
+void DownloadCoordinator::setBandwidthLimit(qint64 limit)
+{
+    m_limit = qMax<qint64>(0, limit);
+    m_tokens = qMin(m_tokens, m_limit);
+    if(!m_limit && !m_starved.isEmpty())
+    {
+        // nobody has to wait for the budget anymore
+        refillBandwidth();
+    }
+}
+
+qint64 DownloadCoordinator::takeBandwidth(Download *download, qint64 wanted)
+{
+    if(!bandwidthLimited())
+    {
+        return wanted;
+    }
+    qint64 given = qMin(m_tokens, wanted);
+    m_tokens -= given;
+    if(given < wanted)
+    {
+        if(!m_starved.contains(download))
+        {
+            m_starved.append(download);
+        }
+        if(!m_refillTimer.isActive())
+        {
+            m_refillTimer.start();
+        }
+    }
+    return given;
+}
+
+void DownloadCoordinator::refillBandwidth()
+{
+    if(m_limit > 0)
+    {
+        // allow bursts of up to one second worth of data
+        m_tokens = qMin(m_tokens + m_limit / refillsPerSecond, m_limit);
+    }
+    auto starved = m_starved;
+    m_starved.clear();
+    for(auto & download: starved)
+    {
+        if(download)
+        {
+            download->downloadReadyRead();
+        }
+    }
+    if(m_starved.isEmpty())
+    {
+        m_refillTimer.stop();
+    }
+}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <memory>
+
+#include "NetAction.h"
+
+class Setting;
+class SettingsObject;
+
+namespace Net {
+class Download;
+
+/*
+ * Process-wide coordinator every Net::Download goes through.
+ *
+ * Downloads of the same URL into the same target file are merged: the first one becomes the leader and does the
+ * transfer, any other one started while it is running subscribes to it and finishes together with it. Several
+ * instances updating at once then download each shared library or asset only once.
+ *
+ * It also holds the global bandwidth budget (the MaxDownloadSpeed setting, in KiB/s), shared by all transfers.
+ */
+class DownloadCoordinator : public QObject
+{
+    Q_OBJECT
+public: /* con/des */
+    /// the bandwidth limit follows the MaxDownloadSpeed setting, if there are settings
+    explicit DownloadCoordinator(std::shared_ptr<SettingsObject> settings = nullptr, QObject *parent = nullptr);
+    virtual ~DownloadCoordinator() {};
+
+public: /* methods */
+    // the key under which identical transfers are merged
+    static QString transferKey(const QUrl &url, const QString &targetPath);
+
+    // attach the download to a running transfer with the same key. Returns false if there is none.
+    bool subscribe(const QString &key, Download *download);
+
+    // detach a subscriber, for example because it was aborted
+    void unsubscribe(const QString &key, Download *download);
+
+    // make the download the one doing the transfer for the key
+    void lead(const QString &key, Download *leader);
+
+    // forward the leader's progress to all subscribers
+    void progress(const QString &key, qint64 bytesReceived, qint64 bytesTotal);
+
+    // the leader is done, finish all subscribers with the same result
+    void finished(const QString &key, JobStatus status);
+
+    // take up to 'wanted' bytes from the bandwidth budget. If it gets less, the download is woken up later.
+    qint64 takeBandwidth(Download *download, qint64 wanted);
+
+    // true if there is a bandwidth limit set
+    bool bandwidthLimited() const
+    {
+        return m_limit > 0;
+    }
+
+    // bytes per second shared by all transfers, 0 for no limit. Follows the MaxDownloadSpeed setting.
+    void setBandwidthLimit(qint64 limit);
+
+    // number of downloads that did not need their own transfer
+    int mergedCount() const
+    {
+        return m_merged;
+    }
+
+private slots:
+    void refillBandwidth();
+    void settingChanged(const Setting &setting);
+
+private: /* data */
+    std::shared_ptr<SettingsObject> m_settings;
+    struct Transfer
+    {
+        QPointer<Download> leader;
+        QList<QPointer<Download>> subscribers;
+    };
+    QMap<QString, Transfer> m_transfers;
+    int m_merged = 0;
+
+    QTimer m_refillTimer;
+    // asked for on every chunk of every transfer, so it is kept here instead of being read from the settings
+    qint64 m_limit = 0;
+    qint64 m_tokens = 0;
+    QList<QPointer<Download>> m_starved;
+};
+}
@@ -0,0 +1,155 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+#include "net/NetJob.h"
+#include "net/Download.h"
+#include "net/DownloadCoordinator.h"
+#include "net/DownloadStats.h"
+#include "net/TestHttpServer.h"
+#include "FileSystem.h"
+
+class DownloadCoordinatorTest : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir m_dir;
+    shared_qobject_ptr<QNetworkAccessManager> m_network = new QNetworkAccessManager();
+
+    NetJob::Ptr makeJob(const QString &name, const Net::Services &services, const QString &url, const QString &path)
+    {
+        NetJob::Ptr job = new NetJob(name, m_network);
+        job->setServices(services);
+        job->addNetAction(Net::Download::makeFile(QUrl(url), path));
+        return job;
+    }
+
+    // start all the jobs at once and wait for them, true if all of them succeeded
+    static bool runAll(const QList<NetJob::Ptr> &jobs)
+    {
+        for(auto &job: jobs)
+        {
+            job->start();
+        }
+        for(auto &job: jobs)
+        {
+            if(job->isRunning())
+            {
+                QSignalSpy finished(job.get(), &Task::finished);
+                if(!finished.wait(15000))
+                {
+                    return false;
+                }
+            }
+        }
+        for(auto &job: jobs)
+        {
+            if(!job->wasSuccessful())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private
+slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void test_merged()
+    {
+        TestHttpServer server([](const TestHttpServer::Request &)
+        {
+            TestHttpServer::Response response;
+            response.body = "shared content";
+            // long enough for the second job to find the transfer running
+            response.delay = 200;
+            return response;
+        });
+        auto services = Net::Services::standalone(m_network);
+        auto path = FS::PathCombine(m_dir.path(), "merged.jar");
+        auto first = makeJob("first", services, server.url("merged.jar"), path);
+        auto second = makeJob("second", services, server.url("merged.jar"), path);
+        QVERIFY(runAll({first, second}));
+
+        QCOMPARE(server.requests().size(), 1);
+        QCOMPARE(services.coordinator->mergedCount(), 1);
+        QCOMPARE(FS::read(path), QByteArray("shared content"));
+
+        int downloaded = 0;
+        int shared = 0;
+        for(auto &totals: services.stats->jobs())
+        {
+            downloaded += totals.downloaded;
+            shared += totals.shared;
+        }
+        QCOMPARE(downloaded, 1);
+        QCOMPARE(shared, 1);
+    }
+
+    void test_leaderFailed()
+    {
+        int served = 0;
+        TestHttpServer server([&served](const TestHttpServer::Request &)
+        {
+            TestHttpServer::Response response;
+            response.delay = 200;
+            if(served++ == 0)
+            {
+                response.status = 500;
+            }
+            else
+            {
+                response.body = "second try";
+            }
+            return response;
+        });
+        auto services = Net::Services::standalone(m_network);
+        auto path = FS::PathCombine(m_dir.path(), "retried.jar");
+        auto first = makeJob("first", services, server.url("retried.jar"), path);
+        auto second = makeJob("second", services, server.url("retried.jar"), path);
+        QVERIFY(runAll({first, second}));
+
+        // the second job waited for the failed transfer and then retried on its own
+        QVERIFY(server.requests().size() >= 2);
+        QCOMPARE(FS::read(path), QByteArray("second try"));
+        auto jobs = services.stats->jobs();
+        QCOMPARE(jobs.size(), 2);
+        for(auto &totals: jobs)
+        {
+            QCOMPARE(totals.retries, 1);
+            QCOMPARE(totals.failed, 0);
+        }
+    }
+
+    void test_bandwidthLimit()
+    {
+        QByteArray content(60 * 1000, 'x');
+        TestHttpServer server([&content](const TestHttpServer::Request &)
+        {
+            TestHttpServer::Response response;
+            response.body = content;
+            return response;
+        });
+        auto services = Net::Services::standalone(m_network);
+        services.coordinator->setBandwidthLimit(100 * 1000);
+        QVERIFY(services.coordinator->bandwidthLimited());
+        auto path = FS::PathCombine(m_dir.path(), "limited.jar");
+        auto job = makeJob("limited", services, server.url("limited.jar"), path);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(runAll({job}));
+        // the budget starts empty and fills up by a tenth of the limit ten times a second
+        QVERIFY(timer.elapsed() >= 500);
+        QCOMPARE(FS::read(path), content);
+    }
+};
+
+QTEST_GUILESS_MAIN(DownloadCoordinatorTest)
+
+#include "DownloadCoordinator_test.moc"
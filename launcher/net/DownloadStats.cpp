@@ -0,0 +1,224 @@
+#include "DownloadStats.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+
+#include "FileSystem.h"
+
+namespace {
+// how many finished jobs to remember
+const int maxFinishedJobs = 50;
+const int saveDelayMsecs = 5000;
+}
+
+namespace Net {
+
+void DownloadStats::Totals::add(const Transfer &transfer)
+{
+    transfers++;
+    retries += transfer.retries;
+    switch(transfer.outcome)
+    {
+        case Outcome::Downloaded:
+            downloaded++;
+            bytes += transfer.bytes;
+            transferMsecs += transfer.transferMsecs;
+            break;
+        case Outcome::NotModified:
+            notModified++;
+            break;
+        case Outcome::CacheHit:
+            cacheHits++;
+            break;
+        case Outcome::Shared:
+            shared++;
+            break;
+        case Outcome::Failed:
+            failed++;
+            break;
+    }
+    if(transfer.ttfbMsecs >= 0)
+    {
+        ttfbMsecs += transfer.ttfbMsecs;
+        ttfbSamples++;
+    }
+    if(transfer.outcome != Outcome::CacheHit)
+    {
+        mirrors[transfer.mirror]++;
+    }
+}
+
+qint64 DownloadStats::Totals::averageTtfb() const
+{
+    return ttfbSamples ? ttfbMsecs / ttfbSamples : -1;
+}
+
+qint64 DownloadStats::Totals::throughput() const
+{
+    return transferMsecs > 0 ? (bytes * 1000) / transferMsecs : 0;
+}
+
+double DownloadStats::Totals::cacheHitRatio() const
+{
+    return transfers ? double(notModified + cacheHits + shared) / transfers : 0.0;
+}
+
+QJsonObject DownloadStats::Totals::toJson() const
+{
+    QJsonObject out;
+    out.insert("name", name);
+    out.insert("transfers", transfers);
+    out.insert("downloaded", downloaded);
+    out.insert("not_modified", notModified);
+    out.insert("cache_hits", cacheHits);
+    out.insert("shared", shared);
+    out.insert("failed", failed);
+    out.insert("retries", retries);
+    out.insert("bytes", double(bytes));
+    out.insert("transfer_msecs", double(transferMsecs));
+    out.insert("average_ttfb_msecs", double(averageTtfb()));
+    out.insert("throughput", double(throughput()));
+    out.insert("cache_hit_ratio", cacheHitRatio());
+    if(elapsedMsecs)
+    {
+        out.insert("elapsed_msecs", double(elapsedMsecs));
+    }
+    QJsonObject mirrorsObj;
+    for(auto iter = mirrors.begin(); iter != mirrors.end(); iter++)
+    {
+        mirrorsObj.insert(iter.key().isEmpty() ? "Mojang" : iter.key(), iter.value());
+    }
+    out.insert("mirrors", mirrorsObj);
+    return out;
+}
+
+DownloadStats::DownloadStats(QString path, QObject *parent)
+    : QObject(parent), m_path(path), m_started(QDateTime::currentDateTimeUtc())
+{
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_saveTimer, &QTimer::timeout, this, &DownloadStats::saveNow);
+}
+
+DownloadStats::~DownloadStats()
+{
+    if(m_saveTimer.isActive())
+    {
+        m_saveTimer.stop();
+        saveNow();
+    }
+}
+
+QString DownloadStats::outcomeName(Outcome outcome)
+{
+    switch(outcome)
+    {
+        case Outcome::Downloaded:
+            return "downloaded";
+        case Outcome::NotModified:
+            return "not_modified";
+        case Outcome::CacheHit:
+            return "cache_hit";
+        case Outcome::Shared:
+            return "shared";
+        case Outcome::Failed:
+            return "failed";
+    }
+    return QString();
+}
+
+quint64 DownloadStats::newJobId()
+{
+    return ++m_lastJobId;
+}
+
+void DownloadStats::record(quint64 job, const QString &name, const Transfer &transfer)
+{
+    auto &host = m_hosts[transfer.host];
+    host.name = transfer.host;
+    host.add(transfer);
+    auto &jobTotals = m_runningJobs[job];
+    jobTotals.name = name;
+    jobTotals.add(transfer);
+    emit changed();
+    saveEventually();
+}
+
+void DownloadStats::jobFinished(quint64 job, qint64 elapsedMsecs)
+{
+    auto iter = m_runningJobs.find(job);
+    if(iter == m_runningJobs.end())
+    {
+        return;
+    }
+    auto totals = *iter;
+    m_runningJobs.erase(iter);
+    totals.elapsedMsecs = elapsedMsecs;
+    qDebug() << "Job" << totals.name << "took" << elapsedMsecs << "ms for" << totals.transfers << "files:" << totals.downloaded
+             << "downloaded," << totals.notModified << "not modified," << totals.cacheHits << "cache hits,"
+             << totals.shared << "shared," << totals.failed << "failed," << totals.retries << "retries,"
+             << totals.bytes << "bytes, average TTFB" << totals.averageTtfb() << "ms";
+    m_finishedJobs.prepend(totals);
+    while(m_finishedJobs.size() > maxFinishedJobs)
+    {
+        m_finishedJobs.removeLast();
+    }
+    emit changed();
+    saveEventually();
+}
+
+QList<DownloadStats::Totals> DownloadStats::hosts() const
+{
+    return m_hosts.values();
+}
+
+QList<DownloadStats::Totals> DownloadStats::jobs() const
+{
+    return m_runningJobs.values() + m_finishedJobs;
+}
+
+QJsonObject DownloadStats::toJson() const
+{
+    QJsonObject out;
+    out.insert("session_started", m_started.toString(Qt::ISODate));
+    QJsonArray hostsArr;
+    for(auto & host: m_hosts)
+    {
+        hostsArr.append(host.toJson());
+    }
+    out.insert("hosts", hostsArr);
+    QJsonArray jobsArr;
+    for(auto & job: jobs())
+    {
+        jobsArr.append(job.toJson());
+    }
+    out.insert("jobs", jobsArr);
+    return out;
+}
+
+void DownloadStats::saveEventually()
+{
+    if(m_path.isEmpty() || m_saveTimer.isActive())
+    {
+        return;
+    }
+    m_saveTimer.start(saveDelayMsecs);
+}
+
+void DownloadStats::saveNow()
+{
+    if(m_path.isEmpty())
+    {
+        return;
+    }
+    try
+    {
+        FS::write(m_path, QJsonDocument(toJson()).toJson());
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << e.what();
+    }
+}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QDateTime>
+#include <QJsonObject>
+
+namespace Net {
+/*
+ * Collects metrics of finished transfers, to find out where download time goes.
+ *
+ * NetJobs report each part once it is done for good: how it ended (downloaded, 304, cache hit, shared with another job,
+ * failed), its size, time to first byte, transfer time, retries and the mirror it came from. The numbers are summed up
+ * per host and per job, and written to a JSON file a few seconds after they change.
+ */
+class DownloadStats : public QObject
+{
+    Q_OBJECT
+public: /* types */
+    enum class Outcome
+    {
+        Downloaded,
+        NotModified,
+        CacheHit,
+        Shared,
+        Failed
+    };
+
+    struct Transfer
+    {
+        QString host;
+        QString mirror;
+        Outcome outcome = Outcome::Downloaded;
+        int httpStatus = 0;
+        qint64 bytes = 0;
+        // until the response headers arrived, -1 if they never did
+        qint64 ttfbMsecs = -1;
+        qint64 transferMsecs = 0;
+        int retries = 0;
+    };
+
+    struct Totals
+    {
+        QString name;
+        int transfers = 0;
+        int downloaded = 0;
+        int notModified = 0;
+        int cacheHits = 0;
+        int shared = 0;
+        int failed = 0;
+        int retries = 0;
+        // bytes and time of actual downloads
+        qint64 bytes = 0;
+        qint64 transferMsecs = 0;
+        qint64 ttfbMsecs = 0;
+        int ttfbSamples = 0;
+        // wall clock time, only known for finished jobs
+        qint64 elapsedMsecs = 0;
+        // transfers per mirror
+        QMap<QString, int> mirrors;
+
+        void add(const Transfer &transfer);
+        qint64 averageTtfb() const;
+        // bytes per second of a single transfer
+        qint64 throughput() const;
+        // share of transfers that did not need new data from the network
+        double cacheHitRatio() const;
+        QJsonObject toJson() const;
+    };
+
+public: /* con/des */
+    // supply the path of the stats file, or nothing to keep them in memory only
+    explicit DownloadStats(QString path = QString(), QObject *parent = nullptr);
+    virtual ~DownloadStats();
+
+public: /* methods */
+    // jobs are told apart by this, several running ones can have the same name
+    quint64 newJobId();
+
+    void record(quint64 job, const QString &name, const Transfer &transfer);
+
+    // the job is done, log its summary and move it to the finished ones
+    void jobFinished(quint64 job, qint64 elapsedMsecs);
+
+    QList<Totals> hosts() const;
+    // running jobs first, then the finished ones, newest first
+    QList<Totals> jobs() const;
+
+    QJsonObject toJson() const;
+
+    static QString outcomeName(Outcome outcome);
+
+public slots:
+    void saveNow();
+
+signals:
+    void changed();
+
+private: /* methods */
+    void saveEventually();
+
+private: /* data */
+    QString m_path;
+    QDateTime m_started;
+    QMap<QString, Totals> m_hosts;
+    QMap<quint64, Totals> m_runningJobs;
+    quint64 m_lastJobId = 0;
+    QList<Totals> m_finishedJobs;
+    QTimer m_saveTimer;
+};
+}
@@ -1,8 +1,18 @@
 #include "FileSink.h"
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include "FileSystem.h"
 
+namespace {
+// chunk size used to feed already downloaded data back into the validators
+const qint64 rehashChunkSize = 1024 * 1024;
+
+// smaller files are downloaded again instead of resumed, they are not worth the extra file
+const qint64 resumableSize = 1024 * 1024;
+}
+
 namespace Net {
 
 FileSink::FileSink(QString filename)
@@ -16,6 +26,16 @@ FileSink::~FileSink()
     // nil
 }
 
+QString FileSink::partPath() const
+{
+    return m_filename + ".part";
+}
+
+QString FileSink::partInfoPath() const
+{
+    return m_filename + ".part.json";
+}
+
 JobStatus FileSink::init(QNetworkRequest& request)
 {
     auto result = initCache(request);
@@ -23,23 +43,130 @@ JobStatus FileSink::init(QNetworkRequest& request)
     {
         return result;
     }
-    // create a new save file and open it for writing
+    // create a new partial file and open it for writing
     if (!FS::ensureFilePathExists(m_filename))
     {
         qCritical() << "Could not create folder for " + m_filename;
         return Job_Failed;
     }
     wroteAnyData = false;
-    m_output_file.reset(new QSaveFile(m_filename));
-    if (!m_output_file->open(QIODevice::WriteOnly))
+    m_accepting = false;
+    m_resumable = false;
+    if(!initAllValidators(request))
+        return Job_Failed;
+
+    m_resume_offset = resumePartial(request);
+    m_output_file.reset(new QFile(partPath()));
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Truncate;
+    if(m_resume_offset)
     {
-        qCritical() << "Could not open " + m_filename + " for writing";
+        mode = QIODevice::Append;
+    }
+    if (!m_output_file->open(mode))
+    {
+        qCritical() << "Could not open " + partPath() + " for writing";
         return Job_Failed;
     }
+    return Job_InProgress;
+}
 
-    if(initAllValidators(request))
-        return Job_InProgress;
-    return Job_Failed;
+qint64 FileSink::resumePartial(QNetworkRequest & request)
+{
+    QFileInfo partInfo(partPath());
+    if(!partInfo.exists())
+    {
+        return 0;
+    }
+    if(!partInfo.isFile() || partInfo.size() == 0)
+    {
+        discardPartial();
+        return 0;
+    }
+    QFile infoFile(partInfoPath());
+    if(!infoFile.open(QIODevice::ReadOnly))
+    {
+        discardPartial();
+        return 0;
+    }
+    auto info = QJsonDocument::fromJson(infoFile.readAll()).object();
+    infoFile.close();
+    QString validator = info.value("etag").toString();
+    if(validator.isEmpty())
+    {
+        validator = info.value("last_modified").toString();
+    }
+    if(validator.isEmpty())
+    {
+        discardPartial();
+        return 0;
+    }
+
+    // checksums have to cover the whole file, so feed them what we already have
+    QFile part(partPath());
+    if(!part.open(QIODevice::ReadOnly))
+    {
+        discardPartial();
+        return 0;
+    }
+    while(!part.atEnd())
+    {
+        auto chunk = part.read(rehashChunkSize);
+        if(chunk.isEmpty() || !writeAllValidators(chunk))
+        {
+            qWarning() << "Could not read back partial download" << partPath() << ", starting over";
+            part.close();
+            discardPartial();
+            initAllValidators(request);
+            return 0;
+        }
+    }
+    auto offset = part.pos();
+    qDebug() << "Resuming download of" << m_filename << "from byte" << offset;
+    request.setRawHeader("Range", QString("bytes=%1-").arg(offset).toLatin1());
+    request.setRawHeader("If-Range", validator.toLatin1());
+    wroteAnyData = true;
+    m_resumable = true;
+    return offset;
+}
+
+bool FileSink::restartPartial()
+{
+    qDebug() << "Server sent the whole file, restarting download of" << m_filename;
+    m_resume_offset = 0;
+    wroteAnyData = false;
+    QNetworkRequest dummy;
+    if(!initAllValidators(dummy))
+    {
+        return false;
+    }
+    m_output_file->close();
+    return m_output_file->open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+void FileSink::discardPartial()
+{
+    if(m_output_file)
+    {
+        m_output_file->close();
+    }
+    QFile::remove(partPath());
+    QFile::remove(partInfoPath());
+}
+
+bool FileSink::commitPartial()
+{
+    m_output_file->close();
+    // the old file stays in place until the new one takes its place
+    if (!FS::replaceFile(partPath(), m_filename))
+    {
+        qCritical() << "Failed to move" << partPath() << "to" << m_filename;
+        return false;
+    }
+    if(m_resumable)
+    {
+        QFile::remove(partInfoPath());
+    }
+    return true;
 }
 
 JobStatus FileSink::initCache(QNetworkRequest &)
@@ -47,12 +174,107 @@ JobStatus FileSink::initCache(QNetworkRequest &)
     return Job_InProgress;
 }
 
+JobStatus FileSink::headersReceived(QNetworkReply & reply)
+{
+    QVariant statusCodeV = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if(!statusCodeV.isValid())
+    {
+        // not HTTP, the data is the file
+        m_accepting = true;
+        return Job_InProgress;
+    }
+    int statusCode = statusCodeV.toInt();
+    if(statusCode == 416)
+    {
+        // what we have does not fit the file anymore
+        qWarning() << "Server refused to resume" << m_filename << ", the next attempt starts over";
+        discardPartial();
+        return Job_Failed;
+    }
+    if(statusCode == 206)
+    {
+        // make sure the server continues where we stopped
+        auto contentRange = QString::fromLatin1(reply.rawHeader("Content-Range"));
+        auto start = contentRange.section(' ', 1).section('-', 0, 0).toLongLong();
+        if(!m_resume_offset || start != m_resume_offset)
+        {
+            qWarning() << "Unexpected partial content" << contentRange << "for" << m_filename;
+            discardPartial();
+            return Job_Failed;
+        }
+    }
+    else if(statusCode == 200 || statusCode == 203)
+    {
+        if(m_resume_offset && !restartPartial())
+        {
+            qCritical() << "Could not restart download of" << m_filename;
+            return Job_Failed;
+        }
+    }
+    else
+    {
+        // error pages, redirects and 304s are not the file
+        return Job_InProgress;
+    }
+    m_accepting = true;
+    if(statusCode == 206)
+    {
+        // the validators we resumed with are already on disk
+        return Job_InProgress;
+    }
+
+    // remember what identifies this version of the file, so a broken transfer can continue later.
+    // only for big files, the small ones are quicker to get again than to keep track of.
+    bool hadInfo = m_resumable;
+    auto size = reply.header(QNetworkRequest::ContentLengthHeader);
+    if(!size.isValid() || size.toLongLong() < resumableSize)
+    {
+        m_resumable = false;
+        if(hadInfo)
+        {
+            QFile::remove(partInfoPath());
+        }
+        return Job_InProgress;
+    }
+    QJsonObject info;
+    if(reply.hasRawHeader("ETag"))
+    {
+        info.insert("etag", QString::fromLatin1(reply.rawHeader("ETag")));
+    }
+    if(reply.hasRawHeader("Last-Modified"))
+    {
+        info.insert("last_modified", QString::fromLatin1(reply.rawHeader("Last-Modified")));
+    }
+    m_resumable = !info.isEmpty();
+    if(m_resumable)
+    {
+        try
+        {
+            FS::write(partInfoPath(), QJsonDocument(info).toJson(QJsonDocument::Compact));
+        }
+        catch (const Exception &e)
+        {
+            qWarning() << e.what();
+            m_resumable = false;
+        }
+    }
+    else if(hadInfo)
+    {
+        QFile::remove(partInfoPath());
+    }
+    return Job_InProgress;
+}
+
 JobStatus FileSink::write(QByteArray& data)
 {
+    if(!m_accepting)
+    {
+        return Job_InProgress;
+    }
     if (!writeAllValidators(data) || m_output_file->write(data) != data.size())
     {
-        qCritical() << "Failed writing into " + m_filename;
-        m_output_file->cancelWriting();
+        qCritical() << "Failed writing into " + partPath();
+        discardPartial();
         m_output_file.reset();
         wroteAnyData = false;
         return Job_Failed;
@@ -63,7 +285,19 @@ JobStatus FileSink::write(QByteArray& data)
 
 JobStatus FileSink::abort()
 {
-    m_output_file->cancelWriting();
+    if(m_output_file)
+    {
+        m_output_file->close();
+        QFileInfo partInfo(partPath());
+        if(m_resumable && partInfo.isFile() && partInfo.size() > 0)
+        {
+            qDebug() << "Keeping" << partInfo.size() << "bytes of" << m_filename << "to resume later";
+        }
+        else
+        {
+            discardPartial();
+        }
+    }
     failAllValidators();
     return Job_Failed;
 }
@@ -77,25 +311,35 @@ JobStatus FileSink::finalize(QNetworkReply& reply)
     if(validStatus)
     {
         // this leaves out 304 Not Modified
-        gotFile = statusCode == 200 || statusCode == 203;
+        gotFile = statusCode == 200 || statusCode == 203 || statusCode == 206;
     }
-    // if we wrote any data to the save file, we try to commit the data to the real file.
+    // if we wrote any data to the partial file, we try to commit the data to the real file.
     // if it actually got a proper file, we write it even if it was empty
-    if (gotFile || wroteAnyData)
+    if (gotFile || (wroteAnyData && m_accepting))
     {
         // ask validators for data consistency
         // we only do this for actual downloads, not 'your data is still the same' cache hits
         if(!finalizeAllValidators(reply))
+        {
+            // the data is bad, don't resume from it
+            discardPartial();
             return Job_Failed;
+        }
         // nothing went wrong...
-        if (!m_output_file->commit())
+        if (!commitPartial())
         {
             qCritical() << "Failed to commit changes to " << m_filename;
-            m_output_file->cancelWriting();
+            discardPartial();
             return Job_Failed;
         }
     }
-    // then get rid of the save file
+    else
+    {
+        // the file we have is still good, nothing from the partial file is needed
+        wroteAnyData = false;
+        discardPartial();
+    }
+    // then get rid of the partial file
     m_output_file.reset();
 
     return finalizeCache(reply);
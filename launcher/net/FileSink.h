@@ -1,8 +1,15 @@
 #pragma once
 #include "Sink.h"
-#include <QSaveFile>
+#include <QFile>
 
 namespace Net {
+/*
+ * Sink that writes the download into a file.
+ *
+ * Data goes into '<file>.part' first and replaces the file only once it is complete and validated. If the transfer of
+ * a big file breaks, the partial file is kept along with the server's validators (ETag/Last-Modified) in
+ * '<file>.part.json', and the next attempt continues with a Range/If-Range request. Checksums are always computed over the whole file.
+ */
 class FileSink : public Sink
 {
 public: /* con/des */
@@ -11,6 +18,7 @@ public: /* con/des */
 
 public: /* methods */
     JobStatus init(QNetworkRequest & request) override;
+    JobStatus headersReceived(QNetworkReply & reply) override;
     JobStatus write(QByteArray & data) override;
     JobStatus abort() override;
     JobStatus finalize(QNetworkReply & reply) override;
@@ -20,9 +28,27 @@ protected: /* methods */
     virtual JobStatus initCache(QNetworkRequest &);
     virtual JobStatus finalizeCache(QNetworkReply &reply);
 
+private: /* methods */
+    QString partPath() const;
+    QString partInfoPath() const;
+    // set up the request to continue a partial download. Returns the number of bytes we already have.
+    qint64 resumePartial(QNetworkRequest & request);
+    // throw away what we have and start writing from the beginning
+    bool restartPartial();
+    void discardPartial();
+    bool commitPartial();
+
 protected: /* data */
     QString m_filename;
     bool wroteAnyData = false;
-    std::unique_ptr<QSaveFile> m_output_file;
+    std::unique_ptr<QFile> m_output_file;
+
+private: /* data */
+    // bytes that were already on disk when this attempt started
+    qint64 m_resume_offset = 0;
+    // the response is the file content (and not an error page or a redirect)
+    bool m_accepting = false;
+    // the server gave us something to check a later resume against
+    bool m_resumable = false;
 };
 }
@@ -0,0 +1,213 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFileInfo>
+
+#include "net/NetJob.h"
+#include "net/Download.h"
+#include "net/ChecksumValidator.h"
+#include "net/TestHttpServer.h"
+#include "FileSystem.h"
+
+class FileSinkTest : public QObject
+{
+    Q_OBJECT
+
+    using Request = TestHttpServer::Request;
+    using Response = TestHttpServer::Response;
+
+    const QByteArray etag = "\"v1\"";
+    // where the first transfer breaks off
+    const int brokenAt = 600 * 1024;
+
+    QTemporaryDir m_dir;
+    shared_qobject_ptr<QNetworkAccessManager> m_network = new QNetworkAccessManager();
+    // big enough to be resumed
+    QByteArray m_content;
+
+    // answer the requests with the handlers in turn, the last one answers all the rest
+    static TestHttpServer::Handler inTurn(const QList<TestHttpServer::Handler> &handlers)
+    {
+        auto served = std::make_shared<int>(0);
+        return [handlers, served](const Request &request)
+        {
+            auto handler = handlers[qMin((*served)++, handlers.size() - 1)];
+            return handler(request);
+        };
+    }
+
+    TestHttpServer::Handler whole()
+    {
+        return [this](const Request &)
+        {
+            Response response;
+            response.headers = {{"ETag", etag}};
+            response.body = m_content;
+            return response;
+        };
+    }
+
+    TestHttpServer::Handler broken()
+    {
+        return [this](const Request &)
+        {
+            Response response;
+            response.headers = {{"ETag", etag}};
+            response.body = m_content;
+            response.cutAfter = brokenAt;
+            return response;
+        };
+    }
+
+    // the rest of the file, from where the request says it stopped
+    TestHttpServer::Handler rest()
+    {
+        return [this](const Request &request)
+        {
+            Response response;
+            auto range = request.headers.value("range");
+            if(!range.startsWith("bytes=") || !range.endsWith("-"))
+            {
+                response.status = 400;
+                return response;
+            }
+            auto start = range.mid(6, range.size() - 7).toLongLong();
+            response.status = 206;
+            response.headers = {
+                {"ETag", etag},
+                {"Content-Range", QString("bytes %1-%2/%3").arg(start).arg(m_content.size() - 1).arg(m_content.size()).toLatin1()}
+            };
+            response.body = m_content.mid(start);
+            return response;
+        };
+    }
+
+    // partial content that doesn't start where we stopped
+    TestHttpServer::Handler wrongRange()
+    {
+        return [this](const Request &)
+        {
+            Response response;
+            response.status = 206;
+            response.headers = {
+                {"ETag", etag},
+                {"Content-Range", QString("bytes 0-%1/%2").arg(m_content.size() - 1).arg(m_content.size()).toLatin1()}
+            };
+            response.body = m_content;
+            return response;
+        };
+    }
+
+    static TestHttpServer::Handler status(int code)
+    {
+        return [code](const Request &)
+        {
+            Response response;
+            response.status = code;
+            return response;
+        };
+    }
+
+    // download the file with a checksum of the whole content, true if it succeeded
+    bool download(const QString &url, const QString &path)
+    {
+        NetJob::Ptr job = new NetJob("FileSink test", m_network);
+        job->setServices(Net::Services::standalone(m_network));
+        auto dl = Net::Download::makeFile(QUrl(url), path);
+        dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1,
+                                                    QCryptographicHash::hash(m_content, QCryptographicHash::Sha1)));
+        job->addNetAction(dl);
+
+        QSignalSpy finished(job.get(), &Task::finished);
+        job->start();
+        if(!finished.wait(15000))
+        {
+            return false;
+        }
+        return job->wasSuccessful();
+    }
+
+    // the file is there as it should be, with nothing left over
+    void verifyDownloaded(const QString &path)
+    {
+        QCOMPARE(FS::read(path), m_content);
+        QVERIFY(!QFileInfo::exists(path + ".part"));
+        QVERIFY(!QFileInfo::exists(path + ".part.json"));
+    }
+
+private
+slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        m_content.resize(1536 * 1024);
+        for(int i = 0; i < m_content.size(); i++)
+        {
+            m_content[i] = char(i * 7 % 251);
+        }
+    }
+
+    void test_resumed()
+    {
+        TestHttpServer server(inTurn({broken(), rest()}));
+        auto path = FS::PathCombine(m_dir.path(), "resumed.jar");
+        QVERIFY(download(server.url("resumed.jar"), path));
+        verifyDownloaded(path);
+
+        // the checksum covers the part from the first attempt, or the file would have been asked for again
+        auto requests = server.requests();
+        QCOMPARE(requests.size(), 2);
+        QVERIFY(!requests[0].headers.contains("range"));
+        auto range = requests[1].headers.value("range");
+        QVERIFY(range.startsWith("bytes="));
+        auto start = range.mid(6, range.size() - 7).toLongLong();
+        QVERIFY(start > 0);
+        QVERIFY(start <= brokenAt);
+        QCOMPARE(requests[1].headers.value("if-range"), etag);
+    }
+
+    void test_rangeIgnored()
+    {
+        // the server sends the whole file again, what we had is thrown away
+        TestHttpServer server(inTurn({broken(), whole()}));
+        auto path = FS::PathCombine(m_dir.path(), "restarted.jar");
+        QVERIFY(download(server.url("restarted.jar"), path));
+        verifyDownloaded(path);
+
+        auto requests = server.requests();
+        QCOMPARE(requests.size(), 2);
+        QVERIFY(requests[1].headers.contains("range"));
+    }
+
+    void test_rangeNotSatisfiable()
+    {
+        TestHttpServer server(inTurn({broken(), status(416), whole()}));
+        auto path = FS::PathCombine(m_dir.path(), "unsatisfiable.jar");
+        QVERIFY(download(server.url("unsatisfiable.jar"), path));
+        verifyDownloaded(path);
+
+        // the partial file was dropped, the last attempt started over
+        auto requests = server.requests();
+        QCOMPARE(requests.size(), 3);
+        QVERIFY(requests[1].headers.contains("range"));
+        QVERIFY(!requests[2].headers.contains("range"));
+    }
+
+    void test_wrongRange()
+    {
+        TestHttpServer server(inTurn({broken(), wrongRange(), whole()}));
+        auto path = FS::PathCombine(m_dir.path(), "wrongrange.jar");
+        QVERIFY(download(server.url("wrongrange.jar"), path));
+        verifyDownloaded(path);
+
+        // the range didn't fit what we had, so none of it was kept
+        auto requests = server.requests();
+        QCOMPARE(requests.size(), 3);
+        QVERIFY(requests[1].headers.contains("range"));
+        QVERIFY(!requests[2].headers.contains("range"));
+    }
+};
+
+QTEST_GUILESS_MAIN(FileSinkTest)
+
+#include "FileSink_test.moc"
@@ -0,0 +1,203 @@
+#include "HostScheduler.h"
+
+#include <QDateTime>
+#include <QTimer>
+#include <QDebug>
+
+#include "settings/Setting.h"
+#include "settings/SettingsObject.h"
+
+namespace {
+// Qt opens at most 6 HTTP/1.1 connections to a single host, so that is a sensible default budget
+const int defaultHostBudget = 6;
+
+// upper limit on transfers of all jobs together
+const int defaultGlobalBudget = 32;
+
+// HTTP/2 multiplexes transfers over one connection, small transfers can share it
+const int multiplexFactor = 4;
+}
+
+namespace Net {
+
+HostScheduler::HostScheduler(std::shared_ptr<SettingsObject> settings, QObject *parent)
+    : QObject(parent), m_settings(settings)
+{
+    m_defaultBudget = defaultHostBudget;
+    m_globalBudget = defaultGlobalBudget;
+    if(m_settings)
+    {
+        connect(m_settings.get(), &SettingsObject::SettingChanged, this, &HostScheduler::settingChanged);
+        connect(m_settings.get(), &SettingsObject::settingReset, this, &HostScheduler::settingChanged);
+        setDefaultBudgets(m_settings->get("ThreadsPerHost").toInt(), m_settings->get("MaxConnections").toInt());
+    }
+}
+
+void HostScheduler::settingChanged(const Setting &setting)
+{
+    if(setting.id() == "ThreadsPerHost" || setting.id() == "MaxConnections")
+    {
+        setDefaultBudgets(m_settings->get("ThreadsPerHost").toInt(), m_settings->get("MaxConnections").toInt());
+    }
+}
+
+QString HostScheduler::hostKey(const QUrl &url)
+{
+    if(url.isLocalFile())
+    {
+        return "file://";
+    }
+    return QString("%1://%2:%3").arg(url.scheme(), url.host()).arg(url.port(url.scheme() == "https" ? 443 : 80));
+}
+
+void HostScheduler::setDefaultBudgets(int hostBudget, int globalBudget)
+{
+    m_defaultBudget = hostBudget > 0 ? hostBudget : defaultHostBudget;
+    m_globalBudget = globalBudget > 0 ? globalBudget : defaultGlobalBudget;
+    emit capacityAvailable();
+}
+
+int HostScheduler::budget(const QString &host) const
+{
+    int budget = m_budgetOverrides.value(host, 0);
+    if(budget > 0)
+    {
+        return budget;
+    }
+    budget = m_defaultBudget;
+    auto iter = m_hosts.find(host);
+    if(iter != m_hosts.end() && iter->multiplexed)
+    {
+        budget *= multiplexFactor;
+    }
+    return budget;
+}
+
+void HostScheduler::setBudget(const QString &host, int budget)
+{
+    if(budget > 0)
+    {
+        m_budgetOverrides[host] = budget;
+    }
+    else
+    {
+        m_budgetOverrides.remove(host);
+    }
+    emit capacityAvailable();
+}
+
+int HostScheduler::active(const QString &host) const
+{
+    return m_hosts.value(host).active;
+}
+
+void HostScheduler::holdOff(const QString &host, qint64 msecs)
+{
+    auto &entry = m_hosts[host];
+    entry.host = host;
+    entry.throttled++;
+    auto until = QDateTime::currentMSecsSinceEpoch() + msecs;
+    if(until <= entry.holdUntil)
+    {
+        return;
+    }
+    qDebug() << "Host" << host << "is throttling us, holding off for" << msecs << "ms";
+    entry.holdUntil = until;
+    QTimer::singleShot(int(msecs), this, [this, host, until]()
+    {
+        auto iter = m_hosts.find(host);
+        // a later hold replaced this one, its own timer lifts it
+        if(iter == m_hosts.end() || iter->holdUntil != until)
+        {
+            return;
+        }
+        iter->holdUntil = 0;
+        emit capacityAvailable();
+    });
+}
+
+bool HostScheduler::acquire(const QString &host)
+{
+    auto &entry = m_hosts[host];
+    entry.host = host;
+    if(entry.holdUntil || m_totalActive >= m_globalBudget || entry.active >= budget(host))
+    {
+        return false;
+    }
+    m_totalActive++;
+    entry.active++;
+    if(entry.active > entry.peak)
+    {
+        entry.peak = entry.active;
+    }
+    return true;
+}
+
+void HostScheduler::cancel(const QString &host)
+{
+    auto iter = m_hosts.find(host);
+    if(iter == m_hosts.end() || iter->active == 0)
+    {
+        qWarning() << "Cancelling a connection slot that was never taken for" << host;
+        return;
+    }
+    iter->active--;
+    m_totalActive--;
+    emit capacityAvailable();
+}
+
+void HostScheduler::release(const QString &host, qint64 bytes, qint64 msecs, bool succeeded, bool multiplexed)
+{
+    auto iter = m_hosts.find(host);
+    if(iter == m_hosts.end() || iter->active == 0)
+    {
+        qWarning() << "Releasing a connection slot that was never taken for" << host;
+        return;
+    }
+    iter->active--;
+    m_totalActive--;
+    if(succeeded)
+    {
+        iter->completed++;
+        iter->bytes += bytes;
+        iter->transferMsecs += msecs;
+    }
+    else
+    {
+        iter->failed++;
+    }
+    if(multiplexed && !iter->multiplexed)
+    {
+        qDebug() << "Host" << host << "supports HTTP/2, raising its connection budget";
+        iter->multiplexed = true;
+    }
+    emit capacityAvailable();
+}
+
+QList<HostScheduler::HostStats> HostScheduler::stats() const
+{
+    QList<HostStats> out;
+    for(auto iter = m_hosts.begin(); iter != m_hosts.end(); iter++)
+    {
+        HostStats entry = *iter;
+        entry.budget = budget(iter.key());
+        out.append(entry);
+    }
+    return out;
+}
+
+void HostScheduler::logStats(const QSet<QString> &hosts) const
+{
+    for(auto & entry: stats())
+    {
+        if(!hosts.isEmpty() && !hosts.contains(entry.host))
+        {
+            continue;
+        }
+        qDebug() << "Host" << entry.host << "active:" << entry.active << "peak:" << entry.peak << "budget:" << entry.budget
+                 << "completed:" << entry.completed << "failed:" << entry.failed << "throttled:" << entry.throttled
+                 << "bytes:" << entry.bytes
+                 << "throughput (B/s):" << entry.throughput() << (entry.multiplexed ? "HTTP/2" : "HTTP/1.1");
+    }
+}
+}
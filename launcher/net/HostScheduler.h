@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QUrl>
+#include <QString>
+#include <memory>
+
+class Setting;
+class SettingsObject;
+
+namespace Net {
+/*
+ * Process-wide connection budget, kept per host (or mirror), with a global cap (the MaxConnections setting) on top.
+ *
+ * All NetJobs share one QNetworkAccessManager, which keeps connections alive and reuses them between requests to the
+ * same host. The scheduler decides how many transfers may be in flight against each host at once, so a single slow
+ * host cannot take every slot of a job. Hosts that answered over HTTP/2 get a bigger budget, because their transfers
+ * are multiplexed over a shared connection instead of each needing their own.
+ */
+class HostScheduler : public QObject
+{
+    Q_OBJECT
+public: /* types */
+    struct HostStats
+    {
+        QString host;
+        int active = 0;
+        int peak = 0;
+        int budget = 0;
+        int completed = 0;
+        int failed = 0;
+        qint64 bytes = 0;
+        qint64 transferMsecs = 0;
+        bool multiplexed = false;
+        // the host told us to back off, no new transfers until this time (msecs since epoch). 0 when not held off
+        qint64 holdUntil = 0;
+        int throttled = 0;
+
+        // average throughput of a single transfer, in bytes per second
+        qint64 throughput() const
+        {
+            return transferMsecs > 0 ? (bytes * 1000) / transferMsecs : 0;
+        }
+    };
+
+public: /* con/des */
+    /// the budgets follow the ThreadsPerHost and MaxConnections settings, if there are settings
+    explicit HostScheduler(std::shared_ptr<SettingsObject> settings = nullptr, QObject *parent = nullptr);
+    virtual ~HostScheduler() {};
+
+public: /* methods */
+    // the key used to group requests, scheme://host:port
+    static QString hostKey(const QUrl &url);
+
+    // try to take a slot for the host. Returns false if the host or the whole process is at its budget.
+    bool acquire(const QString &host);
+
+    // give back a slot taken by acquire() that ended up not being used for a transfer
+    void cancel(const QString &host);
+
+    // give back a slot taken by acquire(), and record what the transfer did
+    void release(const QString &host, qint64 bytes, qint64 msecs, bool succeeded, bool multiplexed);
+
+    // how many concurrent transfers the host may have
+    int budget(const QString &host) const;
+
+    // override the default budget for a single host. Use 0 to go back to the default.
+    void setBudget(const QString &host, int budget);
+
+    // the budget of hosts without an override (ThreadsPerHost) and of all hosts together (MaxConnections)
+    void setDefaultBudgets(int hostBudget, int globalBudget);
+
+    int active(const QString &host) const;
+
+    // the host asked us to slow down (429/503), don't start anything new against it for the given time
+    void holdOff(const QString &host, qint64 msecs);
+
+    QList<HostStats> stats() const;
+
+    // print the per-host statistics into the log, for the given hosts or all of them
+    void logStats(const QSet<QString> &hosts = QSet<QString>()) const;
+
+signals:
+    // some host has a free slot again - waiting jobs should try to start more parts
+    void capacityAvailable();
+
+private slots:
+    void settingChanged(const Setting &setting);
+
+private: /* data */
+    std::shared_ptr<SettingsObject> m_settings;
+    QMap<QString, HostStats> m_hosts;
+    int m_totalActive = 0;
+    // checked for every transfer that starts, so they are kept here instead of being read from the settings
+    int m_defaultBudget;
+    int m_globalBudget;
+    QMap<QString, int> m_budgetOverrides;
+};
+}
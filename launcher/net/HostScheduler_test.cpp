@@ -0,0 +1,140 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include "net/HostScheduler.h"
+#include "settings/INISettingsObject.h"
+#include "FileSystem.h"
+
+class HostSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+    const QString mojang = "https://libraries.minecraft.net:443";
+    const QString mirror = "https://mirror.example.com:443";
+
+    // take slots until the scheduler says no, returns how many were taken
+    static int fill(Net::HostScheduler &scheduler, const QString &host)
+    {
+        int taken = 0;
+        while(taken < 1000 && scheduler.acquire(host))
+        {
+            taken++;
+        }
+        return taken;
+    }
+
+private
+slots:
+    void test_hostKey()
+    {
+        QCOMPARE(Net::HostScheduler::hostKey(QUrl("https://libraries.minecraft.net/a/b.jar")), mojang);
+        QCOMPARE(Net::HostScheduler::hostKey(QUrl("http://example.com/")), QString("http://example.com:80"));
+        QCOMPARE(Net::HostScheduler::hostKey(QUrl("http://example.com:8080/")), QString("http://example.com:8080"));
+        QCOMPARE(Net::HostScheduler::hostKey(QUrl::fromLocalFile("/tmp/file")), QString("file://"));
+    }
+
+    void test_budgets()
+    {
+        Net::HostScheduler scheduler;
+        scheduler.setDefaultBudgets(2, 3);
+        QCOMPARE(fill(scheduler, mojang), 2);
+        QCOMPARE(scheduler.active(mojang), 2);
+        // the other host has a budget of its own, but all of them together only get 3
+        QCOMPARE(fill(scheduler, mirror), 1);
+
+        scheduler.cancel(mirror);
+        QCOMPARE(scheduler.active(mirror), 0);
+        QVERIFY(scheduler.acquire(mirror));
+        scheduler.release(mojang, 1000, 10, true, false);
+        QVERIFY(scheduler.acquire(mojang));
+        QVERIFY(!scheduler.acquire(mojang));
+
+        // giving back a slot that was never taken doesn't make room
+        scheduler.cancel("https://nowhere.example.com:443");
+        QVERIFY(!scheduler.acquire(mirror));
+
+        // bad values mean the defaults
+        scheduler.setDefaultBudgets(0, -1);
+        QCOMPARE(scheduler.budget(mojang), 6);
+    }
+
+    void test_overrides()
+    {
+        Net::HostScheduler scheduler;
+        scheduler.setDefaultBudgets(2, 100);
+        scheduler.setBudget(mirror, 5);
+        QCOMPARE(scheduler.budget(mirror), 5);
+        QCOMPARE(fill(scheduler, mirror), 5);
+        QCOMPARE(fill(scheduler, mojang), 2);
+
+        scheduler.setBudget(mirror, 0);
+        QCOMPARE(scheduler.budget(mirror), 2);
+    }
+
+    void test_multiplexed()
+    {
+        Net::HostScheduler scheduler;
+        scheduler.setDefaultBudgets(2, 100);
+        QVERIFY(scheduler.acquire(mojang));
+        scheduler.release(mojang, 100, 10, true, true);
+        // HTTP/2 hosts get more transfers, they share one connection
+        QCOMPARE(scheduler.budget(mojang), 8);
+        QCOMPARE(fill(scheduler, mojang), 8);
+
+        // an override is taken as it is
+        scheduler.setBudget(mojang, 3);
+        QCOMPARE(scheduler.budget(mojang), 3);
+
+        auto stats = scheduler.stats();
+        QCOMPARE(stats.size(), 1);
+        QCOMPARE(stats[0].completed, 1);
+        QCOMPARE(stats[0].peak, 8);
+        QVERIFY(stats[0].multiplexed);
+    }
+
+    void test_holdOff()
+    {
+        Net::HostScheduler scheduler;
+        QSignalSpy capacity(&scheduler, &Net::HostScheduler::capacityAvailable);
+        scheduler.holdOff(mojang, 200);
+        QVERIFY(!scheduler.acquire(mojang));
+        QVERIFY(scheduler.acquire(mirror));
+        // a shorter hold doesn't lift the longer one
+        scheduler.holdOff(mojang, 50);
+        QCOMPARE(scheduler.stats().first().throttled, 2);
+
+        QTest::qWait(100);
+        QVERIFY(!scheduler.acquire(mojang));
+        QVERIFY(capacity.wait(1000));
+        QVERIFY(scheduler.acquire(mojang));
+    }
+
+    void test_settings()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        std::shared_ptr<SettingsObject> settings(new INISettingsObject(FS::PathCombine(dir.path(), "launcher.cfg")));
+        settings->registerSetting("ThreadsPerHost", 3);
+        settings->registerSetting("MaxConnections", 32);
+
+        Net::HostScheduler scheduler(settings);
+        QCOMPARE(scheduler.budget(mojang), 3);
+
+        QSignalSpy capacity(&scheduler, &Net::HostScheduler::capacityAvailable);
+        settings->set("ThreadsPerHost", 4);
+        QCOMPARE(scheduler.budget(mojang), 4);
+        QCOMPARE(capacity.size(), 1);
+
+        settings->set("MaxConnections", 5);
+        QCOMPARE(fill(scheduler, mojang), 4);
+        QCOMPARE(fill(scheduler, mirror), 1);
+
+        settings->reset("ThreadsPerHost");
+        QCOMPARE(scheduler.budget(mojang), 3);
+    }
+};
+
+QTEST_GUILESS_MAIN(HostSchedulerTest)
+
+#include "HostScheduler_test.moc"
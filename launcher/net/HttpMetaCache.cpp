@@ -20,13 +20,75 @@
 #include <QFile>
 #include <QDateTime>
 #include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 
 #include <QDebug>
 
+#include <QDataStream>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 
+namespace {
+// "MMCJ" followed by the format version. The JSON index was version 1.
+const quint32 journalMagic = 0x4D4D434A;
+const quint32 journalVersion = 2;
+const qint64 journalHeaderSize = 8;
+
+enum RecordType : quint8
+{
+    Record_Put = 1,
+    Record_Remove = 2
+};
+
+// compact once there are this many dead records, and more of them than live entries
+const int compactionThreshold = 1024;
+
+QByteArray journalHeader()
+{
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream << journalMagic << journalVersion;
+    return out;
+}
+
+// each record is its size, a checksum and the payload. A torn write at the end of the journal fails the checksum.
+QByteArray frameRecord(const QByteArray &payload)
+{
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream << quint32(payload.size()) << qChecksum(payload.constData(), payload.size());
+    out.append(payload);
+    return out;
+}
+
+// md5sum of a file, read in chunks so big jars don't end up in memory whole
+QString hashFile(const QString &path)
+{
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&input))
+    {
+        return QString();
+    }
+    return hash.result().toHex().constData();
+}
+
+QByteArray removeRecord(const QString &base, const QString &path)
+{
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << quint8(Record_Remove) << base << path;
+    return frameRecord(out);
+}
+}
+
 QString MetaEntry::getFullPath()
 {
     // FIXME: make local?
@@ -47,6 +109,16 @@ HttpMetaCache::~HttpMetaCache()
     SaveNow();
 }
 
+QByteArray MetaEntry::journalRecord() const
+{
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << quint8(Record_Put) << baseId << relativePath << md5sum << etag << local_changed_timestamp
+           << remote_changed_timestamp;
+    return frameRecord(out);
+}
+
 MetaEntryPtr HttpMetaCache::getEntry(QString base, QString resource_path)
 {
     // no base. no base path. can't store
@@ -65,6 +137,90 @@ MetaEntryPtr HttpMetaCache::getEntry(QString base, QString resource_path)
 
 MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path, QString expected_etag)
 {
+    bool needs_hash = false;
+    qint64 file_last_changed = 0;
+    auto entry = checkEntry(base, resource_path, expected_etag, needs_hash, file_last_changed);
+    if (needs_hash)
+    {
+        return acceptHash(entry, hashFile(FS::PathCombine(getBasePath(base), resource_path)), file_last_changed);
+    }
+    return entry;
+}
+
+void HttpMetaCache::resolveEntryAsync(QString base, QString resource_path, ResolveCallback callback,
+                                      QString expected_etag)
+{
+    bool needs_hash = false;
+    qint64 file_last_changed = 0;
+    auto entry = checkEntry(base, resource_path, expected_etag, needs_hash, file_last_changed);
+    if (!needs_hash)
+    {
+        callback(entry);
+        return;
+    }
+
+    // the file may already be in the works for someone else
+    auto key = qMakePair(base, resource_path);
+    auto iter = m_pending_hashes.find(key);
+    if (iter != m_pending_hashes.end())
+    {
+        iter->callbacks.append(callback);
+        return;
+    }
+    auto &pending = m_pending_hashes[key];
+    pending.entry = entry;
+    pending.file_last_changed = file_last_changed;
+    pending.callbacks.append(callback);
+
+    auto watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, key]()
+    {
+        watcher->deleteLater();
+        auto pending = m_pending_hashes.take(key);
+        auto resolved = acceptHash(pending.entry, watcher->result(), pending.file_last_changed);
+        for (auto &callback : pending.callbacks)
+        {
+            callback(resolved);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&m_hash_pool, hashFile, FS::PathCombine(getBasePath(base), resource_path)));
+}
+
+void HttpMetaCache::resolveEntries(QString base, QStringList resource_paths, BulkResolveCallback callback)
+{
+    struct BulkState
+    {
+        QList<MetaEntryPtr> entries;
+        int remaining = 0;
+    };
+    auto state = std::make_shared<BulkState>();
+    state->remaining = resource_paths.size();
+    if (resource_paths.isEmpty())
+    {
+        callback(state->entries);
+        return;
+    }
+    for (int i = 0; i < resource_paths.size(); i++)
+    {
+        state->entries.append(MetaEntryPtr());
+    }
+    for (int i = 0; i < resource_paths.size(); i++)
+    {
+        resolveEntryAsync(base, resource_paths[i], [state, i, callback](MetaEntryPtr entry)
+        {
+            state->entries[i] = entry;
+            if (--state->remaining == 0)
+            {
+                callback(state->entries);
+            }
+        });
+    }
+}
+
+MetaEntryPtr HttpMetaCache::checkEntry(QString base, QString resource_path, QString expected_etag, bool &needs_hash,
+                                       qint64 &file_last_changed)
+{
+    needs_hash = false;
     auto entry = getEntry(base, resource_path);
     // it's not present? generate a default stale entry
     if (!entry)
@@ -80,34 +236,23 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path, QS
     if (!finfo.isFile() || !finfo.isReadable())
     {
         // if the file doesn't exist, we disown the entry
-        selected_base.entry_list.remove(resource_path);
+        removeEntry(base, resource_path);
         return staleEntry(base, resource_path);
     }
 
     if (!expected_etag.isEmpty() && expected_etag != entry->etag)
     {
         // if the etag doesn't match expected, we disown the entry
-        selected_base.entry_list.remove(resource_path);
+        removeEntry(base, resource_path);
         return staleEntry(base, resource_path);
     }
 
     // if the file changed, check md5sum
-    qint64 file_last_changed = finfo.lastModified().toUTC().toMSecsSinceEpoch();
+    file_last_changed = finfo.lastModified().toUTC().toMSecsSinceEpoch();
     if (file_last_changed != entry->local_changed_timestamp)
     {
-        QFile input(real_path);
-        input.open(QIODevice::ReadOnly);
-        QString md5sum = QCryptographicHash::hash(input.readAll(), QCryptographicHash::Md5)
-                             .toHex()
-                             .constData();
-        if (entry->md5sum != md5sum)
-        {
-            selected_base.entry_list.remove(resource_path);
-            return staleEntry(base, resource_path);
-        }
-        // md5sums matched... keep entry and save the new state to file
-        entry->local_changed_timestamp = file_last_changed;
-        SaveEventually();
+        needs_hash = true;
+        return entry;
     }
 
     // entry passed all the checks we cared about.
@@ -115,6 +260,33 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path, QS
     return entry;
 }
 
+MetaEntryPtr HttpMetaCache::acceptHash(MetaEntryPtr entry, QString md5sum, qint64 file_last_changed)
+{
+    auto base = entry->baseId;
+    auto resource_path = entry->relativePath;
+    entry->basePath = getBasePath(base);
+    // evicted while we were hashing, it gets downloaded again anyway
+    if (entry->stale)
+    {
+        return entry;
+    }
+    // replaced while we were hashing, what we know is outdated
+    if (getEntry(base, resource_path) != entry)
+    {
+        return resolveEntry(base, resource_path);
+    }
+    if (md5sum.isEmpty() || entry->md5sum != md5sum)
+    {
+        removeEntry(base, resource_path);
+        return staleEntry(base, resource_path);
+    }
+    // md5sums matched... keep entry and save the new state to file
+    entry->local_changed_timestamp = file_last_changed;
+    appendRecord(entry->journalRecord());
+    SaveEventually();
+    return entry;
+}
+
 bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
 {
     if (!m_entries.contains(stale_entry->baseId))
@@ -129,6 +301,7 @@ bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
         return false;
     }
     m_entries[stale_entry->baseId].entry_list[stale_entry->relativePath] = stale_entry;
+    appendRecord(stale_entry->journalRecord());
     SaveEventually();
     return true;
 }
@@ -138,12 +311,19 @@ bool HttpMetaCache::evictEntry(MetaEntryPtr entry)
     if(entry)
     {
         entry->stale = true;
+        appendRecord(removeRecord(entry->baseId, entry->relativePath));
         SaveEventually();
         return true;
     }
     return false;
 }
 
+void HttpMetaCache::removeEntry(QString base, QString resource_path)
+{
+    m_entries[base].entry_list.remove(resource_path);
+    appendRecord(removeRecord(base, resource_path));
+}
+
 MetaEntryPtr HttpMetaCache::staleEntry(QString base, QString resource_path)
 {
     auto foo = new MetaEntry();
@@ -179,30 +359,78 @@ void HttpMetaCache::Load()
     if(m_index_file.isNull())
         return;
 
-    QFile index(m_index_file);
-    if (!index.open(QIODevice::ReadOnly))
+    QByteArray data;
+    {
+        QFile index(m_index_file);
+        if (index.open(QIODevice::ReadOnly))
+        {
+            data = index.readAll();
+        }
+    }
+
+    bool rewrite = true;
+    if (data.startsWith('{'))
+    {
+        // the old JSON index, the journal replaces it
+        if (loadLegacyIndex(data))
+        {
+            qDebug() << "Migrating" << m_index_file << "to the journal format";
+        }
+    }
+    else if (!data.isEmpty())
+    {
+        qint64 validSize = 0;
+        m_journal_records = loadJournal(data, validSize);
+        if (m_journal_records < 0)
+        {
+            qWarning() << "Unknown format of" << m_index_file << ", starting with an empty cache index";
+        }
+        else if (validSize != data.size())
+        {
+            // most likely a write that was cut short, don't append after the garbage
+            qWarning() << "Ignoring" << data.size() - validSize << "broken bytes at the end of" << m_index_file;
+        }
+        else
+        {
+            rewrite = false;
+        }
+    }
+
+    if (rewrite)
+    {
+        compact();
         return;
+    }
+    m_journal.reset(new QFile(m_index_file));
+    if (!m_journal->open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning() << "Could not open" << m_index_file << "for writing:" << m_journal->errorString();
+        m_journal.reset();
+    }
+}
 
-    QJsonDocument json = QJsonDocument::fromJson(index.readAll());
+bool HttpMetaCache::loadLegacyIndex(const QByteArray &data)
+{
+    QJsonDocument json = QJsonDocument::fromJson(data);
     if (!json.isObject())
-        return;
+        return false;
     auto root = json.object();
     // check file version first
     auto version_val = root.value("version");
     if (!version_val.isString())
-        return;
+        return false;
     if (version_val.toString() != "1")
-        return;
+        return false;
 
     // read the entry array
     auto entries_val = root.value("entries");
     if (!entries_val.isArray())
-        return;
+        return false;
     QJsonArray array = entries_val.toArray();
     for (auto element : array)
     {
         if (!element.isObject())
-            return;
+            return false;
         auto element_obj = element.toObject();
         QString base = element_obj.value("base").toString();
         if (!m_entries.contains(base))
@@ -220,53 +448,153 @@ void HttpMetaCache::Load()
         foo->stale = false;
         entrymap.entry_list[path] = MetaEntryPtr(foo);
     }
+    return true;
 }
 
-void HttpMetaCache::SaveEventually()
+int HttpMetaCache::loadJournal(const QByteArray &data, qint64 &validSize)
 {
-    // reset the save timer
-    saveBatchingTimer.stop();
-    saveBatchingTimer.start(30000);
+    QDataStream stream(data);
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != journalMagic || version != journalVersion)
+    {
+        return -1;
+    }
+    validSize = journalHeaderSize;
+    int records = 0;
+    while (!stream.atEnd())
+    {
+        quint32 size = 0;
+        quint16 checksum = 0;
+        stream >> size >> checksum;
+        if (stream.status() != QDataStream::Ok || size > quint64(data.size() - stream.device()->pos()))
+        {
+            break;
+        }
+        QByteArray record(size, Qt::Uninitialized);
+        if (stream.readRawData(record.data(), size) != int(size) || qChecksum(record.constData(), size) != checksum)
+        {
+            break;
+        }
+        applyRecord(record);
+        records++;
+        validSize = stream.device()->pos();
+    }
+    return records;
 }
 
-void HttpMetaCache::SaveNow()
+void HttpMetaCache::applyRecord(const QByteArray &record)
 {
-    if(m_index_file.isNull())
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint8 type = 0;
+    QString base, path;
+    stream >> type >> base >> path;
+    if (!m_entries.contains(base))
+        return;
+    auto &entrymap = m_entries[base];
+    if (type == Record_Remove)
+    {
+        entrymap.entry_list.remove(path);
+        return;
+    }
+    if (type != Record_Put)
         return;
-    QJsonObject toplevel;
-    toplevel.insert("version", QJsonValue(QString("1")));
-    QJsonArray entriesArr;
-    for (auto group : m_entries)
+    auto foo = new MetaEntry();
+    foo->baseId = base;
+    foo->relativePath = path;
+    stream >> foo->md5sum >> foo->etag >> foo->local_changed_timestamp >> foo->remote_changed_timestamp;
+    // presumed innocent until closer examination
+    foo->stale = false;
+    entrymap.entry_list[path] = MetaEntryPtr(foo);
+}
+
+void HttpMetaCache::appendRecord(const QByteArray &record)
+{
+    // before Load() or after a write error, SaveNow() writes everything at once
+    if (!m_journal)
+        return;
+    if (m_journal->write(record) != record.size() || !m_journal->flush())
+    {
+        qWarning() << "Failed to append to" << m_index_file << ":" << m_journal->errorString();
+        m_journal.reset();
+        return;
+    }
+    m_journal_records++;
+}
+
+int HttpMetaCache::liveEntries() const
+{
+    int count = 0;
+    for (auto &group : m_entries)
     {
-        for (auto entry : group.entry_list)
+        for (auto &entry : group.entry_list)
+        {
+            if (!entry->stale)
+            {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+void HttpMetaCache::compact()
+{
+    m_journal.reset();
+    QByteArray out = journalHeader();
+    int records = 0;
+    for (auto &group : m_entries)
+    {
+        for (auto &entry : group.entry_list)
         {
             // do not save stale entries. they are dead.
-            if(entry->stale)
+            if (entry->stale)
             {
                 continue;
             }
-            QJsonObject entryObj;
-            entryObj.insert("base", QJsonValue(entry->baseId));
-            entryObj.insert("path", QJsonValue(entry->relativePath));
-            entryObj.insert("md5sum", QJsonValue(entry->md5sum));
-            entryObj.insert("etag", QJsonValue(entry->etag));
-            entryObj.insert("last_changed_timestamp",
-                            QJsonValue(double(entry->local_changed_timestamp)));
-            if (!entry->remote_changed_timestamp.isEmpty())
-                entryObj.insert("remote_changed_timestamp",
-                                QJsonValue(entry->remote_changed_timestamp));
-            entriesArr.append(entryObj);
+            out.append(entry->journalRecord());
+            records++;
         }
     }
-    toplevel.insert("entries", entriesArr);
-
-    QJsonDocument doc(toplevel);
     try
     {
-        FS::write(m_index_file, doc.toJson());
+        FS::write(m_index_file, out);
     }
     catch (const Exception &e)
     {
         qWarning() << e.what();
+        return;
+    }
+    m_journal_records = records;
+    m_journal.reset(new QFile(m_index_file));
+    if (!m_journal->open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning() << "Could not open" << m_index_file << "for writing:" << m_journal->errorString();
+        m_journal.reset();
+    }
+}
+
+void HttpMetaCache::SaveEventually()
+{
+    // reset the save timer
+    saveBatchingTimer.stop();
+    saveBatchingTimer.start(30000);
+}
+
+void HttpMetaCache::SaveNow()
+{
+    if(m_index_file.isNull())
+        return;
+    if (!m_journal)
+    {
+        compact();
+        return;
+    }
+    int dead = m_journal_records - liveEntries();
+    if (dead > compactionThreshold && dead > m_journal_records / 2)
+    {
+        qDebug() << "Compacting" << m_index_file << "with" << dead << "dead records";
+        compact();
     }
 }
@@ -16,7 +16,12 @@
 #pragma once
 #include <QString>
 #include <QMap>
+#include <QFile>
+#include <QPair>
+#include <QStringList>
+#include <QThreadPool>
 #include <qtimer.h>
+#include <functional>
 #include <memory>
 
 class HttpMetaCache;
@@ -64,6 +69,10 @@ public:
     {
         this->md5sum = md5sum;
     }
+protected:
+    // the entry as a record of the index journal
+    QByteArray journalRecord() const;
+
 protected:
     QString baseId;
     QString basePath;
@@ -77,10 +86,18 @@ protected:
 
 typedef std::shared_ptr<MetaEntry> MetaEntryPtr;
 
+/*
+ * The index is an append-only journal of binary records: every update or removal of an entry appends one small record,
+ * and loading replays them in order. Once the journal holds much more dead records than live entries, it is compacted by
+ * rewriting it with only the live ones. The old JSON index (version "1") is migrated on load.
+ */
 class HttpMetaCache : public QObject
 {
     Q_OBJECT
 public:
+    using ResolveCallback = std::function<void(MetaEntryPtr)>;
+    using BulkResolveCallback = std::function<void(QList<MetaEntryPtr>)>;
+
     // supply path to the cache index file
     HttpMetaCache(QString path = QString());
     ~HttpMetaCache();
@@ -93,6 +110,14 @@ public:
     MetaEntryPtr resolveEntry(QString base, QString resource_path,
                               QString expected_etag = QString());
 
+    // same as resolveEntry, but files that changed on disk are hashed on a worker thread
+    // the callback runs on the cache's thread, right away if no hashing is needed
+    void resolveEntryAsync(QString base, QString resource_path, ResolveCallback callback,
+                           QString expected_etag = QString());
+
+    // resolve many entries of one base at once. The callback gets them in the order of the paths.
+    void resolveEntries(QString base, QStringList resource_paths, BulkResolveCallback callback);
+
     // add a previously resolved stale entry
     bool updateEntry(MetaEntryPtr stale_entry);
 
@@ -103,15 +128,33 @@ public:
 
     // (re)start a timer that calls SaveNow later.
     void SaveEventually();
+    // read the index. Bases have to be added before this.
     void Load();
     QString getBasePath(QString base);
 public
 slots:
+    // make sure everything is on disk, compacting the journal if it grew too much
     void SaveNow();
 
 private:
     // create a new stale entry, given the parameters
     MetaEntryPtr staleEntry(QString base, QString resource_path);
+    // drop an entry from the index
+    void removeEntry(QString base, QString resource_path);
+    // the checks of resolveEntry that don't need to read the file. Sets needs_hash if the file changed on disk.
+    MetaEntryPtr checkEntry(QString base, QString resource_path, QString expected_etag, bool &needs_hash,
+                            qint64 &file_last_changed);
+    // finish resolving an entry whose file changed, given the file's current md5sum
+    MetaEntryPtr acceptHash(MetaEntryPtr entry, QString md5sum, qint64 file_last_changed);
+
+    bool loadLegacyIndex(const QByteArray &data);
+    // replay journal records. Returns the number of records read, -1 if this isn't a journal
+    int loadJournal(const QByteArray &data, qint64 &validSize);
+    void applyRecord(const QByteArray &record);
+    void appendRecord(const QByteArray &record);
+    // rewrite the journal with only the live entries
+    void compact();
+    int liveEntries() const;
     struct EntryMap
     {
         QString base_path;
@@ -120,4 +163,18 @@ private:
     QMap<QString, EntryMap> m_entries;
     QString m_index_file;
     QTimer saveBatchingTimer;
+    // the journal, open for appending after Load()
+    std::unique_ptr<QFile> m_journal;
+    // records in the journal, live or not
+    int m_journal_records = 0;
+
+    // files being hashed for resolveEntryAsync, with everyone waiting for them
+    struct PendingHash
+    {
+        MetaEntryPtr entry;
+        qint64 file_last_changed = 0;
+        QList<ResolveCallback> callbacks;
+    };
+    QMap<QPair<QString, QString>, PendingHash> m_pending_hashes;
+    QThreadPool m_hash_pool;
 };
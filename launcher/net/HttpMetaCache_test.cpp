@@ -0,0 +1,169 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+
+#include "TestUtil.h"
+
+#include "net/HttpMetaCache.h"
+
+class HttpMetaCacheTest : public QObject
+{
+    Q_OBJECT
+
+    void addEntry(HttpMetaCache &cache, const QString &path, const QString &md5)
+    {
+        auto entry = cache.resolveEntry("libraries", path);
+        entry->setMD5Sum(md5);
+        entry->setETag("\"" + md5 + "\"");
+        entry->setLocalChangedTimestamp(1234);
+        entry->setStale(false);
+        QVERIFY(cache.updateEntry(entry));
+    }
+
+private
+slots:
+    void test_journalRoundTrip()
+    {
+        QTemporaryDir dir;
+        auto indexPath = dir.path() + "/metacache";
+        {
+            HttpMetaCache cache(indexPath);
+            cache.addBase("libraries", dir.path());
+            cache.Load();
+            addEntry(cache, "a.jar", "aaaa");
+
+            // every update is a small append, not a rewrite of the whole index
+            auto before = QFileInfo(indexPath).size();
+            addEntry(cache, "b.jar", "bbbb");
+            auto after = QFileInfo(indexPath).size();
+            QVERIFY(after > before);
+            QVERIFY(after - before < 256);
+
+            addEntry(cache, "c.jar", "cccc");
+            QVERIFY(cache.evictEntry(cache.getEntry("libraries", "c.jar")));
+        }
+        HttpMetaCache cache(indexPath);
+        cache.addBase("libraries", dir.path());
+        cache.Load();
+        auto a = cache.getEntry("libraries", "a.jar");
+        QVERIFY(a);
+        QCOMPARE(a->getMD5Sum(), QString("aaaa"));
+        QCOMPARE(a->getETag(), QString("\"aaaa\""));
+        QVERIFY(cache.getEntry("libraries", "b.jar"));
+        QVERIFY(!cache.getEntry("libraries", "c.jar"));
+    }
+
+    void test_brokenTail()
+    {
+        QTemporaryDir dir;
+        auto indexPath = dir.path() + "/metacache";
+        {
+            HttpMetaCache cache(indexPath);
+            cache.addBase("libraries", dir.path());
+            cache.Load();
+            addEntry(cache, "a.jar", "aaaa");
+        }
+        {
+            // a record that was cut short
+            QFile index(indexPath);
+            QVERIFY(index.open(QIODevice::Append));
+            index.write(QByteArray("\x00\x00\x01\x00\x12", 5));
+        }
+        {
+            HttpMetaCache cache(indexPath);
+            cache.addBase("libraries", dir.path());
+            cache.Load();
+            QVERIFY(cache.getEntry("libraries", "a.jar"));
+            addEntry(cache, "b.jar", "bbbb");
+        }
+        // records appended after the broken one are not lost
+        HttpMetaCache cache(indexPath);
+        cache.addBase("libraries", dir.path());
+        cache.Load();
+        QVERIFY(cache.getEntry("libraries", "a.jar"));
+        QVERIFY(cache.getEntry("libraries", "b.jar"));
+    }
+
+    void test_legacyMigration()
+    {
+        QTemporaryDir dir;
+        auto indexPath = dir.path() + "/metacache";
+        {
+            QFile index(indexPath);
+            QVERIFY(index.open(QIODevice::WriteOnly));
+            index.write(
+                "{\"version\": \"1\", \"entries\": ["
+                "{\"base\": \"libraries\", \"path\": \"a.jar\", \"md5sum\": \"aaaa\", \"etag\": \"\\\"aaaa\\\"\", "
+                "\"last_changed_timestamp\": 1234, \"remote_changed_timestamp\": \"Wed, 21 Oct 2015 07:28:00 GMT\"},"
+                "{\"base\": \"unknown\", \"path\": \"b.jar\", \"md5sum\": \"bbbb\", \"etag\": \"\", \"last_changed_timestamp\": 0}"
+                "]}");
+        }
+        {
+            HttpMetaCache cache(indexPath);
+            cache.addBase("libraries", dir.path());
+            cache.Load();
+            auto a = cache.getEntry("libraries", "a.jar");
+            QVERIFY(a);
+            QCOMPARE(a->getRemoteChangedTimestamp(), QString("Wed, 21 Oct 2015 07:28:00 GMT"));
+        }
+        QFile index(indexPath);
+        QVERIFY(index.open(QIODevice::ReadOnly));
+        QCOMPARE(index.read(4), QByteArray("MMCJ"));
+        index.close();
+
+        HttpMetaCache cache(indexPath);
+        cache.addBase("libraries", dir.path());
+        cache.Load();
+        auto a = cache.getEntry("libraries", "a.jar");
+        QVERIFY(a);
+        QCOMPARE(a->getMD5Sum(), QString("aaaa"));
+    }
+
+    void test_resolveAsync()
+    {
+        QTemporaryDir dir;
+        HttpMetaCache cache;
+        cache.addBase("libraries", dir.path());
+        QByteArray content(3 * 1024 * 1024, 'x');
+        {
+            QFile file(dir.path() + "/good.jar");
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(content);
+            QFile other(dir.path() + "/bad.jar");
+            QVERIFY(other.open(QIODevice::WriteOnly));
+            other.write("not what we downloaded");
+        }
+        auto md5 = QString(QCryptographicHash::hash(content, QCryptographicHash::Md5).toHex());
+        // the recorded timestamps don't match the files, so both have to be hashed
+        addEntry(cache, "good.jar", md5);
+        addEntry(cache, "bad.jar", md5);
+
+        QList<MetaEntryPtr> resolved;
+        bool done = false;
+        cache.resolveEntries("libraries", {"good.jar", "bad.jar", "missing.jar"}, [&](QList<MetaEntryPtr> entries)
+        {
+            resolved = entries;
+            done = true;
+        });
+        QTRY_VERIFY_WITH_TIMEOUT(done, 10000);
+        QCOMPARE(resolved.size(), 3);
+        QVERIFY(!resolved[0]->isStale());
+        QCOMPARE(resolved[0]->getFullPath(), dir.path() + "/good.jar");
+        QVERIFY(resolved[1]->isStale());
+        QVERIFY(resolved[2]->isStale());
+
+        // the good one was revalidated, resolving it again needs no hashing
+        bool immediate = false;
+        cache.resolveEntryAsync("libraries", "good.jar", [&](MetaEntryPtr entry)
+        {
+            immediate = !entry->isStale();
+        });
+        QVERIFY(immediate);
+    }
+};
+
+QTEST_GUILESS_MAIN(HttpMetaCacheTest)
+
+#include "HttpMetaCache_test.moc"
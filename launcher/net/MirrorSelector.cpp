@@ -0,0 +1,297 @@
+#include "MirrorSelector.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <QDebug>
+
+#include <algorithm>
+#include <memory>
+
+#include "BuildConfig.h"
+
+namespace {
+// mirrors failing this many times in a row are left alone for a while
+const int maxConsecutiveFailures = 3;
+const qint64 unhealthyCooldownMsecs = 60 * 1000;
+const int reprobeIntervalMsecs = 10 * 60 * 1000;
+const int probeTimeoutMsecs = 10 * 1000;
+
+// weight of the newest sample in the smoothed averages, in percent
+const qint64 smoothingWeight = 30;
+
+qint64 smooth(qint64 current, qint64 sample)
+{
+    if(current < 0)
+    {
+        return sample;
+    }
+    return (current * (100 - smoothingWeight) + sample * smoothingWeight) / 100;
+}
+
+QString normalizedBaseUrl(const DownloadSource &mirror)
+{
+    QString baseUrl = mirror.getUrl().trimmed();
+    if (!baseUrl.isEmpty())
+    {
+        baseUrl = QUrl::fromUserInput(baseUrl).toString();
+        if (!baseUrl.startsWith("https://"))
+        {
+            baseUrl = baseUrl.replace("http://", "https://");
+        }
+        if (!baseUrl.endsWith("/"))
+        {
+            baseUrl.append('/');
+        }
+    }
+    return baseUrl;
+}
+}
+
+namespace Net {
+
+bool MirrorSelector::Mirror::isUpstream() const
+{
+    return source.getType() == "Mojang" || source.getUrl().trimmed().isEmpty();
+}
+
+bool MirrorSelector::Mirror::isHealthy() const
+{
+    return unhealthyUntil <= QDateTime::currentMSecsSinceEpoch();
+}
+
+MirrorSelector::MirrorSelector(shared_qobject_ptr<QNetworkAccessManager> network, QObject *parent)
+    : QObject(parent), m_network(network), m_upstreamProbeUrl("https://launchermeta.mojang.com/")
+{
+    // the upstream servers are always there
+    DownloadSource upstream("Mojang", QString(), "Mojang", false);
+    m_mirrors[mirrorKey(upstream)].source = upstream;
+
+    m_reprobeTimer.setInterval(reprobeIntervalMsecs);
+    connect(&m_reprobeTimer, &QTimer::timeout, this, &MirrorSelector::probe);
+}
+
+QString MirrorSelector::mirrorKey(const DownloadSource &source)
+{
+    if(source.getType() == "Mojang")
+    {
+        return QString();
+    }
+    return source.getUrl().trimmed();
+}
+
+MirrorSelector::Mirror & MirrorSelector::mirrorFor(const DownloadSource &source)
+{
+    auto &mirror = m_mirrors[mirrorKey(source)];
+    if(mirror.source.getType().isEmpty())
+    {
+        mirror.source = source;
+    }
+    return mirror;
+}
+
+void MirrorSelector::setMirrors(const QList<DownloadSource> &sources)
+{
+    QMap<QString, Mirror> updated;
+    updated[QString()] = m_mirrors.value(QString());
+    for(auto & source: sources)
+    {
+        auto key = mirrorKey(source);
+        if(updated.contains(key))
+        {
+            continue;
+        }
+        auto mirror = m_mirrors.value(key);
+        mirror.source = source;
+        updated[key] = mirror;
+    }
+    m_mirrors = updated;
+}
+
+QList<DownloadSource> MirrorSelector::ranked(const DownloadSource &preferred) const
+{
+    QList<Mirror> candidates = m_mirrors.values();
+    auto preferredKey = mirrorKey(preferred);
+    bool hasPreference = !preferred.getType().isEmpty();
+    if(hasPreference && !m_mirrors.contains(preferredKey))
+    {
+        Mirror extra;
+        extra.source = preferred;
+        candidates.append(extra);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [&](const Mirror &a, const Mirror &b)
+    {
+        // healthy ones first
+        if(a.isHealthy() != b.isHealthy())
+        {
+            return a.isHealthy();
+        }
+        // then what the user picked
+        if(hasPreference)
+        {
+            bool aPreferred = mirrorKey(a.source) == preferredKey;
+            bool bPreferred = mirrorKey(b.source) == preferredKey;
+            if(aPreferred != bPreferred)
+            {
+                return aPreferred;
+            }
+        }
+        // then the ones we know something about, fastest first
+        if((a.latency < 0) != (b.latency < 0))
+        {
+            return a.latency >= 0;
+        }
+        if(a.latency != b.latency)
+        {
+            return a.latency < b.latency;
+        }
+        return a.throughput > b.throughput;
+    });
+    QList<DownloadSource> out;
+    for(auto & mirror: candidates)
+    {
+        out.append(mirror.source);
+    }
+    return out;
+}
+
+DownloadSource MirrorSelector::select(const DownloadSource &preferred, int attempt) const
+{
+    auto list = ranked(preferred);
+    return list[attempt % list.size()];
+}
+
+void MirrorSelector::reportSuccess(const DownloadSource &mirror, qint64 bytes, qint64 msecs)
+{
+    auto &entry = mirrorFor(mirror);
+    entry.consecutiveFailures = 0;
+    entry.unhealthyUntil = 0;
+    // tiny transfers say more about latency than throughput
+    if(msecs > 0 && bytes > 64 * 1024)
+    {
+        entry.throughput = smooth(entry.throughput > 0 ? entry.throughput : -1, (bytes * 1000) / msecs);
+    }
+}
+
+void MirrorSelector::reportFailure(const DownloadSource &mirror)
+{
+    auto &entry = mirrorFor(mirror);
+    entry.consecutiveFailures++;
+    if(entry.consecutiveFailures >= maxConsecutiveFailures)
+    {
+        qWarning() << "Mirror" << entry.source.getName() << "keeps failing, not using it for a while";
+        entry.unhealthyUntil = QDateTime::currentMSecsSinceEpoch() + unhealthyCooldownMsecs;
+    }
+}
+
+QUrl MirrorSelector::rewrite(const QUrl &url, const DownloadSource &mirror)
+{
+    if (mirror.getType() == "Mojang")
+    {
+        return url;
+    }
+    QString baseUrl = normalizedBaseUrl(mirror);
+    bool useProxy = mirror.isProxy();
+
+    QUrl out = url;
+    QString host = url.toString();
+    struct Replacement {
+        QString search, replace;
+    };
+    Replacement replacements[] = {
+        {"resources.download.minecraft.net", "<j_url>/assets"},
+        {"libraries.minecraft.net", "<j_url>/maven"},
+        {"maven.fabricmc.net", "<j_url>/maven"},
+        {"launchermeta.mojang.com", "<j_url>"},
+        {"launcher.mojang.com", "<j_url>"},
+        {"files.minecraftforge.net", "<j_url>"},
+        {"meta.fabricmc.net", "<j_url>/fabric-meta"},
+        {"maven.neoforged.net/releases", "<j_url>/maven"},
+        {"maven.quiltmc.org/repository/release","<j_url>/maven"},
+        {"meta.quiltmc.org","<j_url>/quilt-meta"},
+        {"edge.forgecdn.net",""},
+        {"mediafilez.forgecdn.net",""}
+    };
+    for (const auto &replacement : replacements)
+    {
+        if (host.contains(replacement.search) && !host.contains(baseUrl))
+        {
+            QString replacementUrl = baseUrl.isEmpty() ? "" : baseUrl + replacement.replace;
+            if (useProxy && !baseUrl.isEmpty())
+            {
+                out = QUrl(baseUrl + host);
+            }
+            else if (!replacementUrl.isEmpty())
+            {
+                host.replace(replacement.search, replacementUrl);
+                out = QUrl(host);
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+QUrl MirrorSelector::probeUrl(const DownloadSource &mirror) const
+{
+    if(mirror.getType() == "Mojang" || mirror.getUrl().trimmed().isEmpty())
+    {
+        return m_upstreamProbeUrl;
+    }
+    // probe the mirror the way it was given to us, so local stand-ins can be plain HTTP
+    return QUrl::fromUserInput(mirror.getUrl().trimmed());
+}
+
+void MirrorSelector::probe()
+{
+    if(!m_network || m_probesRunning)
+    {
+        return;
+    }
+    m_reprobeTimer.start();
+    for(auto iter = m_mirrors.begin(); iter != m_mirrors.end(); iter++)
+    {
+        QNetworkRequest request(probeUrl(iter->source));
+        request.setHeader(QNetworkRequest::UserAgentHeader, BuildConfig.USER_AGENT);
+        auto reply = m_network->head(request);
+        auto key = iter.key();
+        auto timer = std::make_shared<QElapsedTimer>();
+        timer->start();
+        m_probesRunning++;
+        // don't let a dead mirror keep the probe around forever
+        QTimer::singleShot(probeTimeoutMsecs, reply, &QNetworkReply::abort);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, key, timer]()
+        {
+            probeDone(reply, key, timer->elapsed());
+        });
+    }
+}
+
+void MirrorSelector::probeDone(QNetworkReply *reply, const QString &key, qint64 elapsed)
+{
+    reply->deleteLater();
+    m_probesRunning--;
+    auto iter = m_mirrors.find(key);
+    if(iter != m_mirrors.end())
+    {
+        // any HTTP answer means the mirror is alive, only transport errors count against it
+        bool answered = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid();
+        if(answered)
+        {
+            iter->latency = smooth(iter->latency, elapsed);
+            iter->consecutiveFailures = 0;
+            iter->unhealthyUntil = 0;
+            qDebug() << "Mirror" << iter->source.getName() << "answered in" << elapsed << "ms";
+        }
+        else
+        {
+            qWarning() << "Mirror" << iter->source.getName() << "failed probe:" << reply->errorString();
+            iter->unhealthyUntil = QDateTime::currentMSecsSinceEpoch() + unhealthyCooldownMsecs;
+        }
+    }
+    if(m_probesRunning == 0)
+    {
+        emit probeFinished();
+    }
+}
+}
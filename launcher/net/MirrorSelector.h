@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QUrl>
+#include <QTimer>
+#include <QNetworkAccessManager>
+
+#include "DownloadSource.h"
+#include "QObjectPtr.h"
+
+namespace Net {
+/*
+ * Keeps track of the known download mirrors and how well they are doing.
+ *
+ * Mirror latency is probed in the background and transfer results are fed back by the downloads themselves. Each
+ * request is sent to the best healthy mirror, and when it fails the next attempt goes to the next one in line instead
+ * of the same host again. The upstream servers (the "Mojang" source, no rewriting) always take part as a fallback.
+ */
+class MirrorSelector : public QObject
+{
+    Q_OBJECT
+public: /* types */
+    struct Mirror
+    {
+        DownloadSource source;
+        // smoothed round trip of probes, in ms. -1 when not known yet
+        qint64 latency = -1;
+        // smoothed throughput of real transfers, in bytes per second
+        qint64 throughput = 0;
+        int consecutiveFailures = 0;
+        // msecs since epoch until which the mirror is not used
+        qint64 unhealthyUntil = 0;
+
+        bool isUpstream() const;
+        bool isHealthy() const;
+    };
+
+public: /* con/des */
+    explicit MirrorSelector(shared_qobject_ptr<QNetworkAccessManager> network, QObject *parent = nullptr);
+    virtual ~MirrorSelector() {};
+
+public: /* methods */
+    // replace the list of known mirrors, keeping what we measured about the ones that stay
+    void setMirrors(const QList<DownloadSource> &sources);
+
+    /*
+     * Mirrors in the order they should be tried.
+     * The preferred mirror goes first while it is healthy. Without a preference, the best ranked one does.
+     */
+    QList<DownloadSource> ranked(const DownloadSource &preferred = DownloadSource()) const;
+
+    // the mirror to use for the given attempt of a request, counting from 0
+    DownloadSource select(const DownloadSource &preferred, int attempt) const;
+
+    // feed back the results of real transfers
+    void reportSuccess(const DownloadSource &mirror, qint64 bytes, qint64 msecs);
+    void reportFailure(const DownloadSource &mirror);
+
+    QList<Mirror> mirrors() const
+    {
+        return m_mirrors.values();
+    }
+
+    // rewrite an upstream URL so it points at the given mirror
+    static QUrl rewrite(const QUrl &url, const DownloadSource &mirror);
+
+    // the URL used to measure the mirror
+    QUrl probeUrl(const DownloadSource &mirror) const;
+
+    // where the upstream servers are probed
+    void setUpstreamProbeUrl(const QUrl &url)
+    {
+        m_upstreamProbeUrl = url;
+    }
+
+public slots:
+    // measure all mirrors in the background
+    void probe();
+
+signals:
+    void probeFinished();
+
+private: /* methods */
+    static QString mirrorKey(const DownloadSource &source);
+    void probeDone(QNetworkReply *reply, const QString &key, qint64 elapsed);
+    Mirror & mirrorFor(const DownloadSource &source);
+
+private: /* data */
+    shared_qobject_ptr<QNetworkAccessManager> m_network;
+    QMap<QString, Mirror> m_mirrors;
+    QUrl m_upstreamProbeUrl;
+    QTimer m_reprobeTimer;
+    int m_probesRunning = 0;
+};
+}
@@ -0,0 +1,90 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTcpServer>
+
+#include "TestUtil.h"
+
+#include "net/MirrorSelector.h"
+#include "net/TestHttpServer.h"
+
+// answers every request with an empty 200 after an artificial delay
+static TestHttpServer::Handler delayed(int delay)
+{
+    return [delay](const TestHttpServer::Request &)
+    {
+        TestHttpServer::Response response;
+        response.delay = delay;
+        return response;
+    };
+}
+
+class MirrorSelectorTest : public QObject
+{
+    Q_OBJECT
+private
+slots:
+    void test_rewrite()
+    {
+        DownloadSource upstream("Mojang", QString(), "Mojang", false);
+        DownloadSource proxy("Proxy", "http://proxy.example.com", "Proxy", true);
+
+        QUrl asset("https://resources.download.minecraft.net/ab/abcdef");
+        QCOMPARE(Net::MirrorSelector::rewrite(asset, upstream), asset);
+        QCOMPARE(Net::MirrorSelector::rewrite(asset, proxy), QUrl("https://proxy.example.com/" + asset.toString()));
+
+        // things the mirrors don't carry are left alone
+        QUrl other("https://example.org/file.jar");
+        QCOMPARE(Net::MirrorSelector::rewrite(other, proxy), other);
+    }
+
+    void test_probeRanking()
+    {
+        TestHttpServer slow(delayed(400));
+        TestHttpServer fast(delayed(10));
+        TestHttpServer upstreamStandIn(delayed(150));
+        // a port nobody listens on
+        QTcpServer dead;
+        dead.listen(QHostAddress::LocalHost);
+        auto deadUrl = QString("http://127.0.0.1:%1/").arg(dead.serverPort());
+        dead.close();
+
+        DownloadSource slowSource("Slow", slow.url(), "Slow", false);
+        DownloadSource fastSource("Fast", fast.url(), "Fast", false);
+        DownloadSource deadSource("Dead", deadUrl, "Dead", false);
+
+        shared_qobject_ptr<QNetworkAccessManager> network = new QNetworkAccessManager();
+        Net::MirrorSelector selector(network);
+        selector.setUpstreamProbeUrl(QUrl(upstreamStandIn.url()));
+        selector.setMirrors({slowSource, deadSource, fastSource});
+
+        QSignalSpy spy(&selector, SIGNAL(probeFinished()));
+        selector.probe();
+        QVERIFY(spy.wait(15000));
+
+        auto ranked = selector.ranked();
+        QCOMPARE(ranked.size(), 4);
+        QCOMPARE(ranked[0].getName(), QString("Fast"));
+        QCOMPARE(ranked[1].getName(), QString("Mojang"));
+        QCOMPARE(ranked[2].getName(), QString("Slow"));
+        QCOMPARE(ranked[3].getName(), QString("Dead"));
+
+        // the user's pick goes first while it is healthy, retries fail over by rank
+        QCOMPARE(selector.select(slowSource, 0).getName(), QString("Slow"));
+        QCOMPARE(selector.select(slowSource, 1).getName(), QString("Fast"));
+        QCOMPARE(selector.select(slowSource, 2).getName(), QString("Mojang"));
+
+        // a dead pick is skipped right away
+        QCOMPARE(selector.select(deadSource, 0).getName(), QString("Fast"));
+
+        // a pick that keeps failing is, too
+        for(int i = 0; i < 3; i++)
+        {
+            selector.reportFailure(slowSource);
+        }
+        QCOMPARE(selector.select(slowSource, 0).getName(), QString("Fast"));
+    }
+};
+
+QTEST_GUILESS_MAIN(MirrorSelectorTest)
+
+#include "MirrorSelector_test.moc"
@@ -21,6 +21,9 @@
 #include <QNetworkReply>
 #include <QObjectPtr.h>
 
+#include "DownloadSource.h"
+#include "Services.h"
+
 enum JobStatus
 {
     Job_NotStarted,
@@ -35,6 +38,30 @@ enum JobStatus
     Job_Failed_Proceed
 };
 
+/// why the last attempt of an action failed, decides how and when it is retried
+enum class NetFailure
+{
+    None,
+    /// connection trouble, timeouts and server errors. Retried after a growing delay.
+    Transient,
+    /// the server asked us to slow down (429/503). Retried when it says so, does not count as a hard failure.
+    Throttled,
+    /// the server refused the request or sent bad data. Retried right away, on the next mirror.
+    Rejected,
+    /// something on our side broke, like a file that can't be written. Retrying won't help.
+    Local
+};
+
+/// how badly the result of an action is needed, decides the order in which a job starts its parts
+enum class NetPriority
+{
+    /// nice to have, like sounds. Anything else goes first.
+    Background,
+    Normal,
+    /// needed before anything else can happen, like the game jar
+    Critical
+};
+
 class NetAction : public QObject
 {
     Q_OBJECT
@@ -79,6 +106,16 @@ public:
     {
         return m_url;
     }
+    /// the URL the request will actually be sent to, after download sources/mirrors are applied
+    virtual QUrl effectiveUrl()
+    {
+        return m_url;
+    }
+    /// false while the action only waits for a transfer done by someone else, it doesn't use a connection then
+    virtual bool needsConnection() const
+    {
+        return true;
+    }
     void setExtraHeader(const QString& key, const QString & value) {
         if(value.isNull()) {
             m_extra_headers.remove(key);
@@ -125,6 +162,36 @@ public:
     qint64 m_progress = 0;
     qint64 m_total_progress = 1;
 
+    /// where the action goes in the job's queue
+    NetPriority m_priority = NetPriority::Normal;
+    /// size of the result as far as it is known before starting (from the metadata), -1 if it isn't
+    qint64 m_expected_size = -1;
+    /// mirrors in the order attempts go to them, picked once by the job for all of its parts. Empty if not picked yet.
+    QList<DownloadSource> m_mirrors;
+    /// what the action shares with the other downloads, given by the job. The application's if not given.
+    Net::Services m_services;
+
+    /// true if the last reply shared a multiplexed (HTTP/2) connection
+    bool m_multiplexed = false;
+
+    /// how the last attempt failed
+    NetFailure m_failure = NetFailure::None;
+    /// what the server asked us to wait before retrying (Retry-After), in ms. -1 if it didn't say
+    qint64 m_retry_after = -1;
+    /// human readable reason of the last failure
+    QString m_error_string;
+
+    /// metrics of the last attempt, for the download statistics
+    int m_http_status = 0;
+    /// the local copy was still good, nothing was requested
+    bool m_cache_hit = false;
+    /// another job did the transfer for us
+    bool m_shared = false;
+    /// time until the response headers arrived, in ms. -1 if they never did
+    qint64 m_ttfb = -1;
+    qint64 m_transfer_msecs = 0;
+    QString m_mirror_name;
+
     QMap<QString, QString> m_extra_headers;
 
 protected:
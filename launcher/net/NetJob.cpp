@@ -15,10 +15,33 @@
 
 #include "NetJob.h"
 #include "Download.h"
-#include "Application.h"
+#include "DownloadStats.h"
+#include "settings/SettingsObject.h"
+#include "tasks/Tracer.h"
 
+#include <QTimer>
 #include <QDebug>
 
+#include <random>
+#include <algorithm>
+
+namespace {
+// retries of parts that failed on their own
+const int maxFailures = 3;
+// retries of parts the server told to wait
+const int maxThrottles = 10;
+// don't let a server park a part for longer than this
+const qint64 maxRetryAfterMsecs = 2 * 60 * 1000;
+
+// spread retries out between half and all of the delay, so parts that failed together don't come back together
+qint64 jittered(qint64 delay)
+{
+    static std::mt19937 generator{std::random_device{}()};
+    std::uniform_int_distribution<qint64> distribution(delay / 2, delay);
+    return distribution(generator);
+}
+}
+
 void NetJob::partSucceeded(int index)
 {
     // do progress. all slots are 1 in size at least
@@ -27,6 +50,8 @@ void NetJob::partSucceeded(int index)
 
     m_doing.remove(index);
     m_done.insert(index);
+    releaseSlot(index, true);
+    recordPart(index, true);
     downloads[index].get()->disconnect(this);
     startMoreParts();
 }
@@ -34,17 +59,80 @@ void NetJob::partSucceeded(int index)
 void NetJob::partFailed(int index)
 {
     m_doing.remove(index);
+    releaseSlot(index, false);
+    auto part = downloads[index];
+    part.get()->disconnect(this);
     auto &slot = parts_progress[index];
-    if (slot.failures == 3)
+    slot.lastError = part->m_error_string;
+
+    // how long to wait before the next attempt, -1 to give up
+    qint64 delay = -1;
+    switch(part->m_failure)
+    {
+        case NetFailure::Local:
+            break;
+        case NetFailure::Throttled:
+            if(slot.throttles < maxThrottles)
+            {
+                slot.throttles++;
+                delay = part->m_retry_after >= 0 ? qMin(part->m_retry_after, maxRetryAfterMsecs) : jittered(slot.backoff());
+                // everything else we send there would get the same answer
+                m_scheduler->holdOff(slot.host, delay);
+            }
+            break;
+        case NetFailure::Rejected:
+            // the next mirror may have it, no point in waiting
+            if(slot.failures < maxFailures)
+            {
+                slot.failures++;
+                delay = 0;
+            }
+            break;
+        case NetFailure::None:
+        case NetFailure::Transient:
+            if(slot.failures < maxFailures)
+            {
+                slot.failures++;
+                delay = jittered(slot.backoff());
+            }
+            break;
+    }
+
+    if (delay < 0)
     {
         m_failed.insert(index);
+        recordPart(index, false);
     }
     else
     {
-        slot.failures++;
-        m_todo.enqueue(index);
+        slot.waited += delay;
+        // the retry may go to a different mirror
+        slot.host = Net::HostScheduler::hostKey(part->effectiveUrl());
+        if(delay == 0)
+        {
+            enqueuePart(index);
+        }
+        else
+        {
+            qDebug() << "Retrying" << part->url().toString() << "in" << delay << "ms";
+            m_waiting.insert(index);
+            QTimer::singleShot(int(delay), this, [this, index]()
+            {
+                retryPart(index);
+            });
+        }
+    }
+    startMoreParts();
+}
+
+void NetJob::retryPart(int index)
+{
+    // aborted while waiting
+    if(!m_waiting.remove(index))
+    {
+        return;
     }
-    downloads[index].get()->disconnect(this);
+    enqueuePart(index);
     startMoreParts();
 }
 
@@ -53,6 +141,7 @@ void NetJob::partAborted(int index)
     m_aborted = true;
     m_doing.remove(index);
     m_failed.insert(index);
+    releaseSlot(index, false);
     downloads[index].get()->disconnect(this);
     startMoreParts();
 }
@@ -97,8 +186,135 @@ void NetJob::partProgress(int index, qint64 bytesReceived, qint64 bytesTotal)
     setProgress(current, current_total);
 }
 
+void NetJob::releaseSlot(int index, bool succeeded)
+{
+    auto &slot = parts_progress[index];
+    if(!slot.holdsSlot)
+    {
+        return;
+    }
+    slot.holdsSlot = false;
+    auto part = downloads[index];
+    m_scheduler->release(slot.host, part->currentProgress(), slot.timer.elapsed(), succeeded, part->m_multiplexed);
+    if(Tracer::isActive())
+    {
+        Tracer::endAsync(part.get(), part->url().toString(), "net",
+                         {{"succeeded", succeeded}, {"bytes", part->currentProgress()}, {"host", slot.host}});
+    }
+}
+
+void NetJob::recordPart(int index, bool succeeded)
+{
+    auto part = downloads[index];
+    auto &slot = parts_progress[index];
+    Net::DownloadStats::Transfer transfer;
+    transfer.host = slot.host;
+    transfer.mirror = part->m_mirror_name;
+    transfer.httpStatus = part->m_http_status;
+    transfer.bytes = part->currentProgress();
+    transfer.ttfbMsecs = part->m_ttfb;
+    transfer.transferMsecs = part->m_transfer_msecs;
+    transfer.retries = slot.failures + slot.throttles;
+    if(!succeeded)
+    {
+        transfer.outcome = Net::DownloadStats::Outcome::Failed;
+    }
+    else if(part->m_cache_hit)
+    {
+        transfer.outcome = Net::DownloadStats::Outcome::CacheHit;
+    }
+    else if(part->m_shared)
+    {
+        transfer.outcome = Net::DownloadStats::Outcome::Shared;
+    }
+    else if(part->m_http_status == 304)
+    {
+        transfer.outcome = Net::DownloadStats::Outcome::NotModified;
+    }
+    else
+    {
+        transfer.outcome = Net::DownloadStats::Outcome::Downloaded;
+    }
+    services().stats->record(m_statsId, objectName(), transfer);
+}
+
+const Net::Services &NetJob::services()
+{
+    if(!m_services.isValid())
+    {
+        m_services = Net::Services::application();
+    }
+    return m_services;
+}
+
+bool NetJob::startsBefore(int a, int b) const
+{
+    auto partA = downloads[a];
+    auto partB = downloads[b];
+    if(partA->m_priority != partB->m_priority)
+    {
+        return partA->m_priority > partB->m_priority;
+    }
+    if(m_policy != SchedulingPolicy::Fifo)
+    {
+        auto sizeA = partA->m_expected_size;
+        auto sizeB = partB->m_expected_size;
+        // parts of unknown size go after the ones we know about
+        if((sizeA < 0) != (sizeB < 0))
+        {
+            return sizeB < 0;
+        }
+        if(sizeA != sizeB)
+        {
+            return m_policy == SchedulingPolicy::LargestFirst ? sizeA > sizeB : sizeA < sizeB;
+        }
+    }
+    return a < b;
+}
+
+void NetJob::enqueuePart(int index)
+{
+    auto &queue = m_todo[parts_progress[index].host];
+    auto position = std::upper_bound(queue.begin(), queue.end(), index, [this](int a, int b)
+    {
+        return startsBefore(a, b);
+    });
+    queue.insert(position, index);
+}
+
+int NetJob::todoCount() const
+{
+    int count = 0;
+    for(auto & queue: m_todo)
+    {
+        count += queue.size();
+    }
+    return count;
+}
+
 void NetJob::executeTask()
 {
+    if(!m_scheduler)
+    {
+        m_scheduler = services().scheduler;
+        // other jobs finishing parts can free up slots for our hosts
+        connect(m_scheduler.get(), &Net::HostScheduler::capacityAvailable, this, &NetJob::startMoreParts, Qt::QueuedConnection);
+    }
+    m_job_timer.start();
+    m_statsId = services().stats->newJobId();
+    m_threads = 6;
+    if(services().settings)
+    {
+        m_threads = services().settings->get("Threads").toInt();
+    }
+    // the policy and priorities may have changed since the parts were added
+    for(auto & queue: m_todo)
+    {
+        std::stable_sort(queue.begin(), queue.end(), [this](int a, int b)
+        {
+            return startsBefore(a, b);
+        });
+    }
     // hack that delays early failures so they can be caught easier
     QMetaObject::invokeMethod(this, "startMoreParts", Qt::QueuedConnection);
 }
@@ -112,10 +328,12 @@ void NetJob::startMoreParts()
     }
     // OK. We are actively processing tasks, proceed.
     // Check for final conditions if there's nothing in the queue.
-    if(!m_todo.size())
+    if(!todoCount())
     {
-        if(!m_doing.size())
+        if(!m_doing.size() && m_waiting.isEmpty())
         {
+            m_scheduler->logStats(m_todo.keys().toSet());
+            services().stats->jobFinished(m_statsId, m_job_timer.elapsed());
             if(!m_failed.size())
             {
                 emitSucceeded();
@@ -126,22 +344,46 @@ void NetJob::startMoreParts()
             }
             else
             {
-                emitFailed(tr("Job '%1' failed to process:\n%2").arg(objectName()).arg(getFailedFiles().join("\n")));
+                emitFailed(tr("Job '%1' failed to process:\n%2").arg(objectName()).arg(getFailureReport().join("\n")));
             }
         }
         return;
     }
     // There's work to do, try to start more parts.
-    int source = 6;
-    if(APPLICATION->getconfigfile()){
-        source = APPLICATION->settings()->get("Threads").toInt();
-    }
-    while (m_doing.size() < source)
+    // keep starting the most important waiting part of all hosts, until the job is out of connection slots.
+    // hosts that are out of slots are skipped until the next round.
+    QSet<QString> busyHosts;
+    while(m_doing.size() < m_threads)
     {
-        if(!m_todo.size())
+        QQueue<int> *best = nullptr;
+        QString bestHost;
+        for(auto iter = m_todo.begin(); iter != m_todo.end(); iter++)
+        {
+            auto &queue = iter.value();
+            if(queue.isEmpty() || busyHosts.contains(iter.key()))
+            {
+                continue;
+            }
+            if(!best || startsBefore(queue.head(), best->head()))
+            {
+                best = &queue;
+                bestHost = iter.key();
+            }
+        }
+        if(!best)
+        {
             return;
-        int doThis = m_todo.dequeue();
+        }
+        if(!m_scheduler->acquire(bestHost))
+        {
+            busyHosts.insert(bestHost);
+            continue;
+        }
+        int doThis = best->dequeue();
         m_doing.insert(doThis);
+        auto &slot = parts_progress[doThis];
+        slot.holdsSlot = true;
+        slot.timer.start();
         auto part = downloads[doThis];
         // connect signals :D
         connect(part.get(), SIGNAL(succeeded(int)), SLOT(partSucceeded(int)));
@@ -149,7 +391,22 @@ void NetJob::startMoreParts()
         connect(part.get(), SIGNAL(aborted(int)), SLOT(partAborted(int)));
         connect(part.get(), SIGNAL(netActionProgress(int, qint64, qint64)),
                 SLOT(partProgress(int, qint64, qint64)));
+        if(Tracer::isActive())
+        {
+            Tracer::beginAsync(part.get(), part->url().toString(), "net");
+        }
         part->start(m_network);
+        // waiting for another job to transfer the same file doesn't take a connection of the host
+        auto &started = parts_progress[doThis];
+        if(started.holdsSlot && part->isRunning() && !part->needsConnection())
+        {
+            started.holdsSlot = false;
+            m_scheduler->cancel(started.host);
+            if(Tracer::isActive())
+            {
+                Tracer::endAsync(part.get(), part->url().toString(), "net", {{"shared", true}, {"host", started.host}});
+            }
+        }
     }
 }
 
@@ -165,14 +422,46 @@ QStringList NetJob::getFailedFiles()
     return failed;
 }
 
+QStringList NetJob::getFailureReport()
+{
+    QStringList report;
+    for (auto index: m_failed)
+    {
+        auto &slot = parts_progress[index];
+        auto line = downloads[index]->url().toString();
+        if(slot.failures || slot.throttles)
+        {
+            line += tr(" (retries: %1, throttled: %2, waited %3 s)")
+                .arg(slot.failures)
+                .arg(slot.throttles)
+                .arg(slot.waited / 1000.0, 0, 'f', 1);
+        }
+        if(!slot.lastError.isEmpty())
+        {
+            line += ": " + slot.lastError;
+        }
+        report.push_back(line);
+    }
+    report.sort();
+    return report;
+}
+
 bool NetJob::canAbort() const
 {
     bool canFullyAbort = true;
     // can abort the waiting?
-    for(auto index: m_todo)
+    for(auto & queue: m_todo)
     {
-        auto part = downloads[index];
-        canFullyAbort &= part->canAbort();
+        for(auto index: queue)
+        {
+            auto part = downloads[index];
+            canFullyAbort &= part->canAbort();
+        }
+    }
+    // can abort the ones waiting for a retry?
+    for(auto index: m_waiting)
+    {
+        canFullyAbort &= downloads[index]->canAbort();
     }
     // can abort the active?
     for(auto index: m_doing)
@@ -187,8 +476,13 @@ bool NetJob::abort()
 {
     bool fullyAborted = true;
     // fail all waiting
-    m_failed.unite(m_todo.toSet());
+    for(auto & queue: m_todo)
+    {
+        m_failed.unite(queue.toSet());
+    }
     m_todo.clear();
+    m_failed.unite(m_waiting);
+    m_waiting.clear();
     // abort active
     auto toKill = m_doing.toList();
     for(auto index: toKill)
@@ -196,6 +490,12 @@ bool NetJob::abort()
         auto part = downloads[index];
         fullyAborted &= part->abort();
     }
+    if(toKill.isEmpty() && isRunning())
+    {
+        // nothing in flight will report back, finish from here
+        m_aborted = true;
+        QMetaObject::invokeMethod(this, "startMoreParts", Qt::QueuedConnection);
+    }
     return fullyAborted;
 }
 
@@ -203,7 +503,21 @@ bool NetJob::addNetAction(NetAction::Ptr action)
 {
     action->m_index_within_job = downloads.size();
     downloads.append(action);
+    // ranking the mirrors is the same work for every part, do it once
+    if(m_mirrors.isEmpty())
+    {
+        m_mirrors = Net::Download::rankedMirrors(services());
+    }
+    if(action->m_mirrors.isEmpty())
+    {
+        action->m_mirrors = m_mirrors;
+    }
+    if(!action->m_services.isValid())
+    {
+        action->m_services = services();
+    }
     part_info pi;
+    pi.host = Net::HostScheduler::hostKey(action->effectiveUrl());
     parts_progress.append(pi);
     partProgress(parts_progress.count() - 1, action->currentProgress(), action->totalProgress());
 
@@ -213,11 +527,23 @@ bool NetJob::addNetAction(NetAction::Ptr action)
         connect(action.get(), SIGNAL(failed(int)), SLOT(partFailed(int)));
         connect(action.get(), SIGNAL(netActionProgress(int, qint64, qint64)), SLOT(partProgress(int, qint64, qint64)));
     }
+    else if(isRunning())
+    {
+        enqueuePart(parts_progress.size() - 1);
+    }
     else
     {
-        m_todo.append(parts_progress.size() - 1);
+        // sorted once the job starts
+        m_todo[pi.host].enqueue(parts_progress.size() - 1);
     }
     return true;
 }
 
-NetJob::~NetJob() = default;
+NetJob::~NetJob()
+{
+    // don't leak connection slots of parts that are still in flight
+    for(auto index: m_doing)
+    {
+        releaseSlot(index, false);
+    }
+}
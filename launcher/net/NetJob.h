@@ -18,8 +18,10 @@
 #include "NetAction.h"
 #include "Download.h"
 #include "HttpMetaCache.h"
+#include "HostScheduler.h"
 #include "tasks/Task.h"
 #include "QObjectPtr.h"
+#include "ExponentialSeries.h"
 
 class NetJob;
 
@@ -29,14 +31,41 @@ class NetJob : public Task
 public:
     using Ptr = shared_qobject_ptr<NetJob>;
 
+    /// order of parts that have the same priority
+    enum class SchedulingPolicy
+    {
+        /// in the order they were added
+        Fifo,
+        /// big files first, so one of them doesn't end up running alone at the end
+        LargestFirst,
+        /// small files first, for quick visible progress
+        SmallestFirst
+    };
+
     explicit NetJob(QString job_name, shared_qobject_ptr<QNetworkAccessManager> network) : Task(), m_network(network)
     {
         setObjectName(job_name);
     }
     virtual ~NetJob();
 
+    /// share these with other downloads instead of the ones of the application. Has to come before adding parts.
+    void setServices(const Net::Services &services)
+    {
+        m_services = services;
+    }
+
     bool addNetAction(NetAction::Ptr action);
 
+    /// applies to parts that haven't started yet. Higher priority parts always start first.
+    void setSchedulingPolicy(SchedulingPolicy policy)
+    {
+        m_policy = policy;
+    }
+    SchedulingPolicy schedulingPolicy() const
+    {
+        return m_policy;
+    }
+
     NetAction::Ptr operator[](int index)
     {
         return downloads[index];
@@ -56,12 +85,26 @@ public:
         return downloads.size();
     }
     QStringList getFailedFiles();
+    /// failed files along with how often they were retried, how long we waited and the last error
+    QStringList getFailureReport();
 
     bool canAbort() const override;
 
 private slots:
     void startMoreParts();
 
+private:
+    int todoCount() const;
+    /// true if part a should start before part b
+    bool startsBefore(int a, int b) const;
+    /// put a part back into the queue of its host, in order
+    void enqueuePart(int index);
+    void releaseSlot(int index, bool succeeded);
+    void retryPart(int index);
+    // report a part that is done for good to the download statistics
+    void recordPart(int index, bool succeeded);
+    const Net::Services &services();
+
 public slots:
     virtual void executeTask() override;
     virtual bool abort() override;
@@ -75,18 +118,43 @@ private slots:
 private:
     shared_qobject_ptr<QNetworkAccessManager> m_network;
 
+    Net::Services m_services;
+    shared_qobject_ptr<Net::HostScheduler> m_scheduler;
+
     struct part_info
     {
         qint64 current_progress = 0;
         qint64 total_progress = 1;
         int failures = 0;
+        /// times the server asked us to wait. These have a separate, bigger allowance.
+        int throttles = 0;
+        /// total time spent waiting for retries, in ms
+        qint64 waited = 0;
+        ExponentialSeries backoff = ExponentialSeries(500, 30000);
+        QString lastError;
+        /// scheduler key of the host this part talks to
+        QString host;
+        /// true while the part holds a connection slot of its host
+        bool holdsSlot = false;
+        QElapsedTimer timer;
     };
     QList<NetAction::Ptr> downloads;
     QList<part_info> parts_progress;
-    QQueue<int> m_todo;
+    /// parts waiting to be started, queued per host
+    QMap<QString, QQueue<int>> m_todo;
     QSet<int> m_doing;
+    /// parts waiting for their retry delay to pass
+    QSet<int> m_waiting;
     QSet<int> m_done;
     QSet<int> m_failed;
     qint64 m_current_progress = 0;
     bool m_aborted = false;
+    SchedulingPolicy m_policy = SchedulingPolicy::Fifo;
+    QElapsedTimer m_job_timer;
+    /// what the download stats know this run of the job as
+    quint64 m_statsId = 0;
+    /// parts this job runs at once, from the Threads setting when the job starts
+    int m_threads = 6;
+    /// mirrors in the order attempts go to them, picked once for all parts of the job
+    QList<DownloadSource> m_mirrors;
 };
@@ -0,0 +1,181 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
+#include "net/NetJob.h"
+#include "net/Download.h"
+#include "net/DownloadStats.h"
+#include "net/TestHttpServer.h"
+
+class NetJobTest : public QObject
+{
+    Q_OBJECT
+
+    shared_qobject_ptr<QNetworkAccessManager> m_network = new QNetworkAccessManager();
+    QByteArray m_output;
+
+    // answer the requests with the responses in turn, the last one answers all the rest
+    static TestHttpServer::Handler inTurn(const QList<TestHttpServer::Response> &responses)
+    {
+        auto served = std::make_shared<int>(0);
+        return [responses, served](const TestHttpServer::Request &)
+        {
+            return responses[qMin((*served)++, responses.size() - 1)];
+        };
+    }
+
+    static TestHttpServer::Response status(int code, const QByteArray &retryAfter = QByteArray())
+    {
+        TestHttpServer::Response response;
+        response.status = code;
+        if(!retryAfter.isEmpty())
+        {
+            response.headers = {{"Retry-After", retryAfter}};
+        }
+        return response;
+    }
+
+    static TestHttpServer::Response content()
+    {
+        TestHttpServer::Response response;
+        response.body = "content";
+        return response;
+    }
+
+    NetJob::Ptr makeJob(const QString &name, const Net::Services &services, const QString &url)
+    {
+        NetJob::Ptr job = new NetJob(name, m_network);
+        job->setServices(services);
+        job->addNetAction(Net::Download::makeByteArray(QUrl(url), &m_output));
+        return job;
+    }
+
+    static bool run(NetJob::Ptr job)
+    {
+        QSignalSpy finished(job.get(), &Task::finished);
+        job->start();
+        return finished.wait(15000);
+    }
+
+    // times the scheduler was told to hold the host off
+    static int throttled(const Net::Services &services, const QString &url)
+    {
+        auto host = Net::HostScheduler::hostKey(QUrl(url));
+        for(auto &stats: services.scheduler->stats())
+        {
+            if(stats.host == host)
+            {
+                return stats.throttled;
+            }
+        }
+        return 0;
+    }
+
+private
+slots:
+    void test_retryAfter()
+    {
+        TestHttpServer server(inTurn({status(429, "1"), content()}));
+        auto services = Net::Services::standalone(m_network);
+        auto url = server.url("throttled");
+        auto job = makeJob("throttled", services, url);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(run(job));
+        QVERIFY(job->wasSuccessful());
+        // timers may fire a little early
+        QVERIFY(timer.elapsed() >= 950);
+        QCOMPARE(server.requests().size(), 2);
+        QCOMPARE(m_output, QByteArray("content"));
+        QCOMPARE(throttled(services, url), 1);
+        QCOMPARE(services.stats->jobs().first().retries, 1);
+    }
+
+    void test_retryAfterCapped()
+    {
+        TestHttpServer server(inTurn({status(429, "3600")}));
+        auto services = Net::Services::standalone(m_network);
+        auto url = server.url("parked");
+        auto job = makeJob("parked", services, url);
+        QSignalSpy finished(job.get(), &Task::finished);
+        job->start();
+        QTRY_COMPARE(throttled(services, url), 1);
+
+        // nothing else goes to the host while it wants us to wait
+        QVERIFY(!services.scheduler->acquire(Net::HostScheduler::hostKey(QUrl(url))));
+
+        // an hour is cut down to two minutes, we don't wait for those either
+        job->abort();
+        QVERIFY(finished.wait(5000));
+        QVERIFY(!job->wasSuccessful());
+        QCOMPARE(server.requests().size(), 1);
+        QCOMPARE(job->getFailureReport(), QStringList({url + " (retries: 0, throttled: 1, waited 120.0 s): HTTP 429"}));
+    }
+
+    void test_serviceUnavailable()
+    {
+        TestHttpServer server(inTurn({status(503), content()}));
+        auto services = Net::Services::standalone(m_network);
+        auto url = server.url("unavailable");
+        auto job = makeJob("unavailable", services, url);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(run(job));
+        QVERIFY(job->wasSuccessful());
+        // without Retry-After, the first backoff step with jitter
+        QVERIFY(timer.elapsed() >= 240);
+        QCOMPARE(server.requests().size(), 2);
+        QCOMPARE(throttled(services, url), 1);
+        QCOMPARE(services.stats->jobs().first().retries, 1);
+    }
+
+    void test_rejected()
+    {
+        TestHttpServer server(inTurn({status(404)}));
+        auto services = Net::Services::standalone(m_network);
+        auto url = server.url("missing");
+        auto job = makeJob("missing", services, url);
+
+        QVERIFY(run(job));
+        QVERIFY(!job->wasSuccessful());
+        // retried right away, the next mirror may have it
+        QCOMPARE(server.requests().size(), 4);
+        QCOMPARE(throttled(services, url), 0);
+        QCOMPARE(job->failReason(),
+                 QString("Job 'missing' failed to process:\n%1 (retries: 3, throttled: 0, waited 0.0 s): HTTP 404").arg(url));
+        auto stats = services.stats->jobs().first();
+        QCOMPARE(stats.failed, 1);
+        QCOMPARE(stats.retries, 3);
+    }
+
+    void test_connectionReset()
+    {
+        TestHttpServer::Response reset;
+        reset.reset = true;
+        TestHttpServer server(inTurn({reset}));
+        auto services = Net::Services::standalone(m_network);
+        auto url = server.url("reset");
+        auto job = makeJob("reset", services, url);
+
+        QVERIFY(run(job));
+        QVERIFY(!job->wasSuccessful());
+        QCOMPARE(throttled(services, url), 0);
+
+        // three retries after 500, 1000 and 2000 ms, each cut down by up to half
+        auto report = job->getFailureReport();
+        QCOMPARE(report.size(), 1);
+        QRegularExpression line("^" + QRegularExpression::escape(url) + " \\(retries: 3, throttled: 0, waited ([0-9.]+) s\\): .+$");
+        auto match = line.match(report.first());
+        QVERIFY2(match.hasMatch(), qPrintable(report.first()));
+        auto waited = match.captured(1).toDouble();
+        QVERIFY(waited >= 1.7);
+        QVERIFY(waited <= 3.5);
+    }
+};
+
+QTEST_GUILESS_MAIN(NetJobTest)
+
+#include "NetJob_test.moc"
@@ -0,0 +1,35 @@
+#include "Services.h"
+
+#include "HostScheduler.h"
+#include "DownloadCoordinator.h"
+#include "MirrorSelector.h"
+#include "DownloadStats.h"
+
+#include "Application.h"
+
+namespace Net {
+
+Services Services::application()
+{
+    Services services;
+    services.scheduler = APPLICATION->hostScheduler();
+    services.coordinator = APPLICATION->downloadCoordinator();
+    services.mirrors = APPLICATION->mirrors();
+    services.stats = APPLICATION->downloadStats();
+    if(APPLICATION->getconfigfile())
+    {
+        services.settings = APPLICATION->settings();
+    }
+    return services;
+}
+
+Services Services::standalone(shared_qobject_ptr<QNetworkAccessManager> network)
+{
+    Services services;
+    services.scheduler = new HostScheduler();
+    services.coordinator = new DownloadCoordinator();
+    services.mirrors = new MirrorSelector(network);
+    services.stats = new DownloadStats();
+    return services;
+}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+
+#include "QObjectPtr.h"
+
+class SettingsObject;
+class QNetworkAccessManager;
+
+namespace Net {
+class HostScheduler;
+class DownloadCoordinator;
+class MirrorSelector;
+class DownloadStats;
+
+/*
+ * The objects the downloads of the whole process share. Jobs use the ones of the application, unless they are given
+ * their own, like in the tests.
+ */
+struct Services
+{
+    shared_qobject_ptr<HostScheduler> scheduler;
+    shared_qobject_ptr<DownloadCoordinator> coordinator;
+    shared_qobject_ptr<MirrorSelector> mirrors;
+    shared_qobject_ptr<DownloadStats> stats;
+    /// where the Threads and download source settings come from, the defaults are used without them
+    std::shared_ptr<SettingsObject> settings;
+
+    bool isValid() const
+    {
+        return scheduler && coordinator && mirrors && stats;
+    }
+
+    static Services application();
+
+    /// new ones, shared with nothing else, without settings. For the tests.
+    static Services standalone(shared_qobject_ptr<QNetworkAccessManager> network);
+};
+}
@@ -13,6 +13,11 @@ public: /* con/des */
 
 public: /* methods */
     virtual JobStatus init(QNetworkRequest & request) = 0;
+    // called once the response headers are known, before any data is written
+    virtual JobStatus headersReceived(QNetworkReply &)
+    {
+        return Job_InProgress;
+    }
     virtual JobStatus write(QByteArray & data) = 0;
     virtual JobStatus abort() = 0;
     virtual JobStatus finalize(QNetworkReply & reply) = 0;
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QMap>
+#include <QList>
+#include <QPair>
+
+#include <functional>
+#include <memory>
+
+/*
+ * Local stand-in for a download server or a mirror, for the tests.
+ *
+ * Every request gets what the handler returns for it, and the connection is closed after each response. The requests
+ * are kept, so tests can check what was asked for.
+ */
+class TestHttpServer : public QTcpServer
+{
+public: /* types */
+    struct Request
+    {
+        QByteArray method;
+        QByteArray path;
+        /// header names are in lower case
+        QMap<QByteArray, QByteArray> headers;
+    };
+
+    struct Response
+    {
+        int status = 200;
+        QList<QPair<QByteArray, QByteArray>> headers;
+        QByteArray body;
+        /// wait this long before answering, in ms
+        int delay = 0;
+        /// close the connection without answering
+        bool reset = false;
+        /// send only this much of the body and close the connection, -1 for all of it
+        int cutAfter = -1;
+    };
+
+    using Handler = std::function<Response(const Request &)>;
+
+public: /* con/des */
+    explicit TestHttpServer(Handler handler) : m_handler(handler)
+    {
+        connect(this, &QTcpServer::newConnection, this, [this]()
+        {
+            acceptConnections();
+        });
+        listen(QHostAddress::LocalHost);
+    }
+
+public: /* methods */
+    QString url(const QString &path = QString()) const
+    {
+        return QString("http://127.0.0.1:%1/%2").arg(serverPort()).arg(path);
+    }
+
+    const QList<Request> &requests() const
+    {
+        return m_requests;
+    }
+
+private: /* methods */
+    void acceptConnections()
+    {
+        while(hasPendingConnections())
+        {
+            auto socket = nextPendingConnection();
+            auto buffer = std::make_shared<QByteArray>();
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, socket, [this, socket, buffer]()
+            {
+                buffer->append(socket->readAll());
+                auto end = buffer->indexOf("\r\n\r\n");
+                if(end < 0)
+                {
+                    return;
+                }
+                auto request = parse(buffer->left(end));
+                buffer->clear();
+                m_requests.append(request);
+                auto response = m_handler(request);
+                QTimer::singleShot(response.delay, socket, [socket, response]()
+                {
+                    respond(socket, response);
+                });
+            });
+        }
+    }
+
+    static Request parse(const QByteArray &head)
+    {
+        Request request;
+        auto lines = head.split('\n');
+        auto requestLine = lines.takeFirst().trimmed().split(' ');
+        request.method = requestLine.value(0);
+        request.path = requestLine.value(1);
+        for(auto &line: lines)
+        {
+            auto colon = line.indexOf(':');
+            if(colon < 0)
+            {
+                continue;
+            }
+            request.headers.insert(line.left(colon).trimmed().toLower(), line.mid(colon + 1).trimmed());
+        }
+        return request;
+    }
+
+    static void respond(QTcpSocket *socket, const Response &response)
+    {
+        if(response.reset)
+        {
+            socket->abort();
+            return;
+        }
+        auto out = QString("HTTP/1.1 %1 Test\r\n").arg(response.status).toLatin1();
+        bool hasLength = false;
+        for(auto &header: response.headers)
+        {
+            hasLength |= header.first.toLower() == "content-length";
+            out += header.first + ": " + header.second + "\r\n";
+        }
+        if(!hasLength)
+        {
+            out += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+        }
+        out += "Connection: close\r\n\r\n";
+        out += response.cutAfter >= 0 ? response.body.left(response.cutAfter) : response.body;
+        socket->write(out);
+        socket->disconnectFromHost();
+    }
+
+private: /* data */
+    Handler m_handler;
+    QList<Request> m_requests;
+};
@@ -0,0 +1,176 @@
+#include "XzDecompressSink.h"
+
+#include <QDebug>
+
+#include <xz.h>
+
+namespace {
+// biggest LZMA2 dictionary we are willing to allocate, xz -9 uses 64 MiB
+const uint32_t maxDictionarySize = 1 << 26;
+const int outputBufferSize = 64 * 1024;
+
+void initCrcTables()
+{
+    static bool initialized = false;
+    if(!initialized)
+    {
+        xz_crc32_init();
+        xz_crc64_init();
+        initialized = true;
+    }
+}
+}
+
+namespace Net {
+
+XzDecompressSink::XzDecompressSink(Sink *target) : m_target(target)
+{
+    initCrcTables();
+    m_buffer.resize(outputBufferSize);
+}
+
+XzDecompressSink::~XzDecompressSink()
+{
+    if(m_decoder)
+    {
+        xz_dec_end(m_decoder);
+    }
+}
+
+void XzDecompressSink::resetDecoder()
+{
+    if(!m_decoder)
+    {
+        m_decoder = xz_dec_init(XZ_DYNALLOC, maxDictionarySize);
+    }
+    else
+    {
+        xz_dec_reset(m_decoder);
+    }
+    m_streamEnded = false;
+}
+
+JobStatus XzDecompressSink::init(QNetworkRequest & request)
+{
+    m_accepting = false;
+    resetDecoder();
+    if(!m_decoder)
+    {
+        qCritical() << "Could not create XZ decoder";
+        return Job_Failed;
+    }
+    if(!initAllValidators(request))
+    {
+        return Job_Failed;
+    }
+    auto status = m_target->init(request);
+    // the target may want to continue from what it has, which only makes sense for the decompressed data
+    request.setRawHeader("Range", QByteArray());
+    request.setRawHeader("If-Range", QByteArray());
+    return status;
+}
+
+JobStatus XzDecompressSink::headersReceived(QNetworkReply & reply)
+{
+    QVariant statusCodeV = reply.attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    int statusCode = statusCodeV.toInt();
+    // not HTTP, or the whole file
+    m_accepting = !statusCodeV.isValid() || statusCode == 200 || statusCode == 203;
+    return m_target->headersReceived(reply);
+}
+
+JobStatus XzDecompressSink::write(QByteArray & data)
+{
+    if(!m_accepting)
+    {
+        return Job_InProgress;
+    }
+    if(!writeAllValidators(data))
+    {
+        return Job_Failed;
+    }
+    if(m_streamEnded)
+    {
+        // stream padding, nothing more to decode
+        return Job_InProgress;
+    }
+    xz_buf buffer;
+    buffer.in = reinterpret_cast<const uint8_t *>(data.constData());
+    buffer.in_pos = 0;
+    buffer.in_size = data.size();
+    buffer.out = reinterpret_cast<uint8_t *>(m_buffer.data());
+    buffer.out_pos = 0;
+    buffer.out_size = m_buffer.size();
+    while(true)
+    {
+        auto result = xz_dec_run(m_decoder, &buffer);
+        bool outputFull = buffer.out_pos == buffer.out_size;
+        if(buffer.out_pos)
+        {
+            QByteArray chunk(m_buffer.constData(), int(buffer.out_pos));
+            buffer.out_pos = 0;
+            if(m_target->write(chunk) != Job_InProgress)
+            {
+                return Job_Failed;
+            }
+        }
+        if(result == XZ_STREAM_END)
+        {
+            m_streamEnded = true;
+            return Job_InProgress;
+        }
+        if(result == XZ_UNSUPPORTED_CHECK)
+        {
+            // the data is fine, we just can't verify it with the stream's own check
+            qWarning() << "XZ stream uses an unsupported integrity check, continuing without it";
+            continue;
+        }
+        if(result != XZ_OK)
+        {
+            if(result == XZ_FORMAT_ERROR)
+            {
+                qCritical() << "Download is not an XZ stream";
+            }
+            else
+            {
+                qCritical() << "Failed to decompress XZ stream, error" << result;
+            }
+            return Job_Failed;
+        }
+        if(buffer.in_pos == buffer.in_size && !outputFull)
+        {
+            return Job_InProgress;
+        }
+    }
+}
+
+JobStatus XzDecompressSink::abort()
+{
+    failAllValidators();
+    return m_target->abort();
+}
+
+JobStatus XzDecompressSink::finalize(QNetworkReply & reply)
+{
+    if(m_accepting)
+    {
+        if(!m_streamEnded)
+        {
+            qCritical() << "XZ stream ended early";
+            m_target->abort();
+            return Job_Failed;
+        }
+        if(!finalizeAllValidators(reply))
+        {
+            m_target->abort();
+            return Job_Failed;
+        }
+    }
+    return m_target->finalize(reply);
+}
+
+bool XzDecompressSink::hasLocalData()
+{
+    return m_target->hasLocalData();
+}
+}
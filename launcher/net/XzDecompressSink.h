@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Sink.h"
+
+#include <memory>
+
+struct xz_dec;
+
+namespace Net {
+/*
+ * Sink stage that inflates an XZ compressed response while it is downloaded and passes the result on to another sink.
+ *
+ * Validators added to this sink see the compressed stream as it came over the network, validators of the wrapped sink
+ * see the decompressed data. Partial downloads are not resumed, a decoder can't start in the middle of a stream.
+ *
+ * Only the .xz container is supported. Legacy .lzma ('LZMA alone') streams are refused by the bundled decoder.
+ */
+class XzDecompressSink : public Sink
+{
+public: /* con/des */
+    XzDecompressSink(Sink *target);
+    virtual ~XzDecompressSink();
+
+public: /* methods */
+    JobStatus init(QNetworkRequest & request) override;
+    JobStatus headersReceived(QNetworkReply & reply) override;
+    JobStatus write(QByteArray & data) override;
+    JobStatus abort() override;
+    JobStatus finalize(QNetworkReply & reply) override;
+    bool hasLocalData() override;
+
+    // the sink that gets the decompressed data
+    Sink *target()
+    {
+        return m_target.get();
+    }
+
+private: /* methods */
+    void resetDecoder();
+
+private: /* data */
+    std::unique_ptr<Sink> m_target;
+    xz_dec *m_decoder = nullptr;
+    QByteArray m_buffer;
+    // the response is the compressed file (and not an error page or a redirect)
+    bool m_accepting = false;
+    // the decoder saw the end of the stream
+    bool m_streamEnded = false;
+};
+}
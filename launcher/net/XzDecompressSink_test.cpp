@@ -0,0 +1,146 @@
+#include <QTest>
+#include <QCryptographicHash>
+#include <QNetworkReply>
+
+#include "TestUtil.h"
+
+#include "net/XzDecompressSink.h"
+#include "net/ByteArraySink.h"
+#include "net/ChecksumValidator.h"
+
+/*
+ * Finished HTTP response, only carries the status code.
+ */
+class FakeReply : public QNetworkReply
+{
+    Q_OBJECT
+public:
+    explicit FakeReply(int statusCode)
+    {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, statusCode);
+        open(QIODevice::ReadOnly);
+    }
+    void abort() override {}
+
+protected:
+    qint64 readData(char *, qint64) override
+    {
+        return -1;
+    }
+};
+
+class XzDecompressSinkTest : public QObject
+{
+    Q_OBJECT
+
+    QByteArray expectedContent()
+    {
+        QByteArray out;
+        for(int i = 0; i < 20000; i++)
+        {
+            out.append(QString("line %1\n").arg(i).toLatin1());
+        }
+        return out;
+    }
+
+    // feed the data to the sink the way a download would, in small chunks
+    JobStatus feed(Net::Sink &sink, const QByteArray &data, int chunkSize)
+    {
+        QNetworkRequest request;
+        auto status = sink.init(request);
+        if(status != Job_InProgress)
+        {
+            return status;
+        }
+        FakeReply reply(200);
+        status = sink.headersReceived(reply);
+        for(int offset = 0; offset < data.size() && status == Job_InProgress; offset += chunkSize)
+        {
+            auto chunk = data.mid(offset, chunkSize);
+            status = sink.write(chunk);
+        }
+        if(status != Job_InProgress)
+        {
+            sink.abort();
+            return status;
+        }
+        return sink.finalize(reply);
+    }
+
+private
+slots:
+    void test_decompress_data()
+    {
+        QTest::addColumn<int>("chunkSize");
+        QTest::newRow("tiny chunks") << 7;
+        QTest::newRow("network sized chunks") << 16 * 1024;
+        QTest::newRow("all at once") << 1024 * 1024;
+    }
+    void test_decompress()
+    {
+        QFETCH(int, chunkSize);
+        auto compressed = GET_TEST_FILE("testdata/XzDecompressSink/lines.txt.xz");
+        QVERIFY(!compressed.isEmpty());
+        auto expected = expectedContent();
+
+        QByteArray output;
+        auto target = new Net::ByteArraySink(&output);
+        target->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1,
+            QCryptographicHash::hash(expected, QCryptographicHash::Sha1)));
+        Net::XzDecompressSink sink(target);
+        sink.addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1,
+            QCryptographicHash::hash(compressed, QCryptographicHash::Sha1)));
+
+        QCOMPARE(feed(sink, compressed, chunkSize), Job_Finished);
+        QCOMPARE(output, expected);
+    }
+
+    void test_validators()
+    {
+        auto compressed = GET_TEST_FILE("testdata/XzDecompressSink/lines.txt.xz");
+        QByteArray output;
+
+        // the compressed stream doesn't match what we expect
+        {
+            Net::XzDecompressSink sink(new Net::ByteArraySink(&output));
+            sink.addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, QByteArray(20, '\0')));
+            QCOMPARE(feed(sink, compressed, 4096), Job_Failed);
+        }
+        // the decompressed data doesn't
+        {
+            auto target = new Net::ByteArraySink(&output);
+            target->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, QByteArray(20, '\0')));
+            Net::XzDecompressSink sink(target);
+            QCOMPARE(feed(sink, compressed, 4096), Job_Failed);
+        }
+    }
+
+    void test_brokenStreams()
+    {
+        auto compressed = GET_TEST_FILE("testdata/XzDecompressSink/lines.txt.xz");
+        QByteArray output;
+        // cut short
+        {
+            Net::XzDecompressSink sink(new Net::ByteArraySink(&output));
+            QCOMPARE(feed(sink, compressed.left(compressed.size() / 2), 4096), Job_Failed);
+        }
+        // corrupted in the middle
+        {
+            auto corrupted = compressed;
+            corrupted[corrupted.size() / 2] = char(corrupted.at(corrupted.size() / 2) ^ 0x55);
+            Net::XzDecompressSink sink(new Net::ByteArraySink(&output));
+            QCOMPARE(feed(sink, corrupted, 4096), Job_Failed);
+        }
+        // legacy .lzma is not something the decoder understands
+        {
+            auto lzma = GET_TEST_FILE("testdata/XzDecompressSink/lines.txt.lzma");
+            QVERIFY(!lzma.isEmpty());
+            Net::XzDecompressSink sink(new Net::ByteArraySink(&output));
+            QCOMPARE(feed(sink, lzma, 4096), Job_Failed);
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(XzDecompressSinkTest)
+
+#include "XzDecompressSink_test.moc"
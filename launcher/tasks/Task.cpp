@@ -14,9 +14,22 @@
  */
 
 #include "Task.h"
+#include "Tracer.h"
 
 #include <QDebug>
 
+namespace {
+QString traceName(const QObject *task)
+{
+    auto name = task->objectName();
+    if(name.isEmpty())
+    {
+        return task->metaObject()->className();
+    }
+    return QString("%1: %2").arg(task->metaObject()->className(), name);
+}
+}
+
 Task::Task(QObject *parent) : QObject(parent)
 {
 }
@@ -69,6 +82,10 @@ void Task::start()
     }
     // NOTE: only fall thorugh to here in end states
     m_state = State::Running;
+    if(Tracer::isActive())
+    {
+        Tracer::beginAsync(this, traceName(this), "task");
+    }
     emit started();
     executeTask();
 }
@@ -84,6 +101,10 @@ void Task::emitFailed(QString reason)
     m_state = State::Failed;
     m_failReason = reason;
     qCritical() << "Task" << describe() << "failed: " << reason;
+    if(Tracer::isActive())
+    {
+        Tracer::endAsync(this, traceName(this), "task", {{"result", "failed"}, {"reason", reason}});
+    }
     emit failed(reason);
     emit finished();
 }
@@ -99,6 +120,10 @@ void Task::emitAborted()
     m_state = State::AbortedByUser;
     m_failReason = "Aborted.";
     qDebug() << "Task" << describe() << "aborted.";
+    if(Tracer::isActive())
+    {
+        Tracer::endAsync(this, traceName(this), "task", {{"result", "aborted"}});
+    }
     emit failed(m_failReason);
     emit finished();
 }
@@ -113,6 +138,10 @@ void Task::emitSucceeded()
     }
     m_state = State::Succeeded;
     qDebug() << "Task" << describe() << "succeeded";
+    if(Tracer::isActive())
+    {
+        Tracer::endAsync(this, traceName(this), "task", {{"result", "succeeded"}});
+    }
     emit succeeded();
     emit finished();
 }
@@ -0,0 +1,181 @@
+#include "Tracer.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QDebug>
+
+#include "FileSystem.h"
+
+struct Tracer::Session::Data
+{
+    QString path;
+    QJsonArray events;
+};
+
+namespace {
+QAtomicInt activeSessions;
+QMutex sessionsMutex;
+QList<std::shared_ptr<Tracer::Session::Data>> sessions;
+
+QElapsedTimer startedTimer()
+{
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
+}
+
+// microseconds, since the first time anyone asked
+double now()
+{
+    static const QElapsedTimer timer = startedTimer();
+    return timer.nsecsElapsed() / 1000.0;
+}
+
+QJsonObject makeEvent(const char *phase, const QString &name, const char *category, double timestamp)
+{
+    QJsonObject event;
+    event.insert("ph", QString::fromLatin1(phase));
+    event.insert("name", name);
+    event.insert("cat", QString::fromLatin1(category));
+    event.insert("ts", timestamp);
+    event.insert("pid", double(QCoreApplication::applicationPid()));
+    event.insert("tid", double(quintptr(QThread::currentThreadId())));
+    return event;
+}
+
+QString asyncId(const void *object)
+{
+    return QString("0x%1").arg(quintptr(object), 0, 16);
+}
+
+void record(const QJsonObject &event)
+{
+    QMutexLocker locker(&sessionsMutex);
+    for(auto &session: sessions)
+    {
+        session->events.append(event);
+    }
+}
+}
+
+namespace Tracer
+{
+
+bool isActive()
+{
+    return activeSessions.load() > 0;
+}
+
+void beginAsync(const void *object, const QString &name, const char *category)
+{
+    if(!isActive())
+    {
+        return;
+    }
+    auto event = makeEvent("b", name, category, now());
+    event.insert("id", asyncId(object));
+    record(event);
+}
+
+void endAsync(const void *object, const QString &name, const char *category, const QVariantMap &args)
+{
+    if(!isActive())
+    {
+        return;
+    }
+    auto event = makeEvent("e", name, category, now());
+    event.insert("id", asyncId(object));
+    if(!args.isEmpty())
+    {
+        event.insert("args", QJsonObject::fromVariantMap(args));
+    }
+    record(event);
+}
+
+void instant(const QString &name, const char *category, const QVariantMap &args)
+{
+    if(!isActive())
+    {
+        return;
+    }
+    auto event = makeEvent("i", name, category, now());
+    // only mark the thread, not the whole process
+    event.insert("s", QString("t"));
+    if(!args.isEmpty())
+    {
+        event.insert("args", QJsonObject::fromVariantMap(args));
+    }
+    record(event);
+}
+
+Scope::Scope(const QString &name, const char *category) : m_name(name), m_category(category)
+{
+    if(isActive())
+    {
+        m_start = now();
+    }
+}
+
+Scope::~Scope()
+{
+    if(m_start < 0 || !isActive())
+    {
+        return;
+    }
+    auto event = makeEvent("X", m_name, m_category, m_start);
+    event.insert("dur", now() - m_start);
+    record(event);
+}
+
+Session::Session(const QString &path) : d(std::make_shared<Data>())
+{
+    d->path = path;
+    // sessions are opened from the user interface, so this names the main thread
+    auto threadName = makeEvent("M", "thread_name", "__metadata", now());
+    threadName.insert("args", QJsonObject({{"name", QString("main")}}));
+    d->events.append(threadName);
+
+    QMutexLocker locker(&sessionsMutex);
+    sessions.append(d);
+    activeSessions.ref();
+}
+
+Session::~Session()
+{
+    close();
+}
+
+bool Session::close()
+{
+    {
+        QMutexLocker locker(&sessionsMutex);
+        if(!sessions.removeOne(d))
+        {
+            return true;
+        }
+        activeSessions.deref();
+    }
+    QJsonObject root;
+    root.insert("traceEvents", d->events);
+    root.insert("displayTimeUnit", QString("ms"));
+    try
+    {
+        FS::write(d->path, QJsonDocument(root).toJson(QJsonDocument::Compact));
+        qDebug() << "Wrote a trace with" << d->events.size() << "events to" << d->path;
+        return true;
+    }
+    catch (const Exception &e)
+    {
+        qWarning() << e.what();
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+#include <memory>
+
+/*
+ * Records when things begin and end, to be looked at in a trace viewer like chrome://tracing or ui.perfetto.dev.
+ *
+ * Nothing is recorded unless a session is open. Events go to all the open sessions, and each session writes them in the
+ * Chrome trace event format when it is closed. Tasks record themselves, work on other threads can use a Tracer::Scope.
+ */
+namespace Tracer
+{
+/// whether anything is recorded at all, to skip putting the events together when nothing is
+bool isActive();
+
+/// something begins that isn't tied to a thread, like a task. The object tells it apart from others of the same name.
+void beginAsync(const void *object, const QString &name, const char *category);
+void endAsync(const void *object, const QString &name, const char *category, const QVariantMap &args = QVariantMap());
+
+/// something happens
+void instant(const QString &name, const char *category, const QVariantMap &args = QVariantMap());
+
+/// records the time between construction and destruction, on the current thread
+class Scope
+{
+public:
+    Scope(const QString &name, const char *category);
+    ~Scope();
+
+private:
+    QString m_name;
+    const char *m_category;
+    double m_start = -1;
+};
+
+class Session
+{
+public:
+    explicit Session(const QString &path);
+    /// closes the session, if that wasn't done yet
+    ~Session();
+
+    /// stop recording and write the events. Returns false if they couldn't be written.
+    bool close();
+
+private:
+    struct Data;
+    std::shared_ptr<Data> d;
+};
+}
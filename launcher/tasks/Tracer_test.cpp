@@ -0,0 +1,101 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "TestUtil.h"
+
+#include "tasks/Task.h"
+#include "tasks/Tracer.h"
+#include "FileSystem.h"
+
+class TracedTask : public Task
+{
+    Q_OBJECT
+protected:
+    void executeTask() override
+    {
+        emitSucceeded();
+    }
+};
+
+class TracerTest : public QObject
+{
+    Q_OBJECT
+
+    static QJsonArray readEvents(const QString &path)
+    {
+        QFile file(path);
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            return QJsonArray();
+        }
+        return QJsonDocument::fromJson(file.readAll()).object().value("traceEvents").toArray();
+    }
+
+    static QList<QJsonObject> eventsOfPhase(const QJsonArray &events, const QString &phase)
+    {
+        QList<QJsonObject> out;
+        for(auto event: events)
+        {
+            if(event.toObject().value("ph").toString() == phase)
+            {
+                out.append(event.toObject());
+            }
+        }
+        return out;
+    }
+
+private
+slots:
+    void test_inactive()
+    {
+        QVERIFY(!Tracer::isActive());
+        // nothing to record to, nothing happens
+        TracedTask task;
+        task.start();
+        QVERIFY(task.wasSuccessful());
+    }
+
+    void test_session()
+    {
+        QTemporaryDir dir;
+        auto path = FS::PathCombine(dir.path(), "trace.json");
+        {
+            Tracer::Session session(path);
+            QVERIFY(Tracer::isActive());
+            TracedTask task;
+            task.setObjectName("traced");
+            task.start();
+            {
+                Tracer::Scope scope("work", "test");
+            }
+            Tracer::instant("done", "test");
+            QVERIFY(session.close());
+        }
+        QVERIFY(!Tracer::isActive());
+
+        auto events = readEvents(path);
+        auto begins = eventsOfPhase(events, "b");
+        auto ends = eventsOfPhase(events, "e");
+        QCOMPARE(begins.size(), 1);
+        QCOMPARE(ends.size(), 1);
+        QCOMPARE(begins[0].value("name").toString(), QString("TracedTask: traced"));
+        QCOMPARE(ends[0].value("id"), begins[0].value("id"));
+        QCOMPARE(ends[0].value("args").toObject().value("result").toString(), QString("succeeded"));
+        QVERIFY(ends[0].value("ts").toDouble() >= begins[0].value("ts").toDouble());
+
+        auto scopes = eventsOfPhase(events, "X");
+        QCOMPARE(scopes.size(), 1);
+        QCOMPARE(scopes[0].value("name").toString(), QString("work"));
+        QVERIFY(scopes[0].value("dur").toDouble() >= 0);
+        QVERIFY(scopes[0].contains("tid"));
+        QCOMPARE(eventsOfPhase(events, "i").size(), 1);
+    }
+};
+
+QTEST_GUILESS_MAIN(TracerTest)
+
+#include "Tracer_test.moc"
@@ -0,0 +1,127 @@
+#include "DownloadStatsPage.h"
+
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QTreeWidget>
+#include <QLabel>
+
+namespace {
+QString formatBytes(qint64 bytes)
+{
+    if(bytes < 1024)
+    {
+        return QString("%1 B").arg(bytes);
+    }
+    if(bytes < 1024 * 1024)
+    {
+        return QString("%1 KiB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 MiB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+}
+
+DownloadStatsPage::DownloadStatsPage(QWidget *parent) : QWidget(parent)
+{
+    setObjectName(QStringLiteral("downloadStatsPage"));
+    auto layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    m_summary = new QLabel(this);
+    m_summary->setWordWrap(true);
+    layout->addWidget(m_summary);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setRootIsDecorated(true);
+    m_tree->setAlternatingRowColors(true);
+    m_tree->setHeaderLabels({
+        tr("Host / Job"),
+        tr("Files"),
+        tr("Downloaded"),
+        tr("Not modified"),
+        tr("Cache hits"),
+        tr("Shared"),
+        tr("Failed"),
+        tr("Retries"),
+        tr("Data"),
+        tr("Throughput"),
+        tr("Avg. TTFB"),
+        tr("Cache hit ratio"),
+        tr("Time"),
+        tr("Mirrors")
+    });
+    m_tree->header()->setStretchLastSection(true);
+    layout->addWidget(m_tree);
+
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(500);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &DownloadStatsPage::refresh);
+    connect(APPLICATION->downloadStats().get(), &Net::DownloadStats::changed, this, &DownloadStatsPage::statsChanged);
+}
+
+void DownloadStatsPage::statsChanged()
+{
+    if(isOpened && !m_refreshTimer.isActive())
+    {
+        m_refreshTimer.start();
+    }
+}
+
+void DownloadStatsPage::openedImpl()
+{
+    refresh();
+}
+
+void DownloadStatsPage::addTotals(QTreeWidgetItem *parent, const Net::DownloadStats::Totals &totals)
+{
+    QStringList mirrors;
+    for(auto iter = totals.mirrors.begin(); iter != totals.mirrors.end(); iter++)
+    {
+        mirrors.append(QString("%1: %2").arg(iter.key().isEmpty() ? "Mojang" : iter.key()).arg(iter.value()));
+    }
+    auto ttfb = totals.averageTtfb();
+    new QTreeWidgetItem(parent, {
+        totals.name,
+        QString::number(totals.transfers),
+        QString::number(totals.downloaded),
+        QString::number(totals.notModified),
+        QString::number(totals.cacheHits),
+        QString::number(totals.shared),
+        QString::number(totals.failed),
+        QString::number(totals.retries),
+        formatBytes(totals.bytes),
+        formatBytes(totals.throughput()) + "/s",
+        ttfb < 0 ? QString("-") : tr("%1 ms").arg(ttfb),
+        QString("%1 %").arg(totals.cacheHitRatio() * 100.0, 0, 'f', 1),
+        totals.elapsedMsecs ? tr("%1 s").arg(totals.elapsedMsecs / 1000.0, 0, 'f', 1) : QString("-"),
+        mirrors.join(", ")
+    });
+}
+
+void DownloadStatsPage::refresh()
+{
+    if(!isOpened)
+    {
+        return;
+    }
+    m_refreshTimer.stop();
+    auto stats = APPLICATION->downloadStats();
+    m_tree->clear();
+
+    auto hostsItem = new QTreeWidgetItem(m_tree, {tr("Hosts")});
+    for(auto & host: stats->hosts())
+    {
+        addTotals(hostsItem, host);
+    }
+    auto jobsItem = new QTreeWidgetItem(m_tree, {tr("Jobs")});
+    for(auto & job: stats->jobs())
+    {
+        addTotals(jobsItem, job);
+    }
+    m_tree->expandAll();
+    for(int i = 0; i < m_tree->columnCount() - 1; i++)
+    {
+        m_tree->resizeColumnToContents(i);
+    }
+    m_summary->setText(tr("Downloads of this session. The same numbers are written to %1 in the launcher's data folder.")
+        .arg("downloadstats.json"));
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QWidget>
+#include <QTimer>
+
+#include "ui/pages/BasePage.h"
+#include <Application.h>
+
+class QTreeWidget;
+class QTreeWidgetItem;
+class QLabel;
+
+/*
+ * Shows what the download statistics collected in this session, per host and per job.
+ */
+class DownloadStatsPage : public QWidget, public BasePage
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadStatsPage(QWidget *parent = 0);
+    virtual ~DownloadStatsPage() {};
+
+    QString displayName() const override
+    {
+        return tr("Downloads");
+    }
+    QIcon icon() const override
+    {
+        return APPLICATION->getThemedIcon("status-good");
+    }
+    QString id() const override
+    {
+        return "download-stats";
+    }
+    void openedImpl() override;
+
+private slots:
+    void statsChanged();
+    void refresh();
+
+private:
+    void addTotals(QTreeWidgetItem *parent, const Net::DownloadStats::Totals &totals);
+
+private:
+    QTreeWidget *m_tree;
+    QLabel *m_summary;
+    // the statistics change with every transfer, the page follows them a few times a second at most
+    QTimer m_refreshTimer;
+};
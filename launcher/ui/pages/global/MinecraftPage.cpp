@@ -72,6 +72,12 @@ void MinecraftPage::applySettings()
     s->set("ShowGlobalGameTime", ui->showGlobalGameTime->isChecked());
     s->set("RecordGameTime", ui->recordGameTime->isChecked());
     s->set("ShowGameTimeHours", ui->showGameTimeHours->isChecked());
+
+    // Startup
+    s->set("PrefetchGameFiles", ui->prefetchGameFilesCheck->isChecked());
+
+    // Diagnostics
+    s->set("TraceLaunches", ui->traceLaunchesCheck->isChecked());
 }
 
 void MinecraftPage::loadSettings()
@@ -90,4 +96,8 @@ void MinecraftPage::loadSettings()
     ui->showGlobalGameTime->setChecked(s->get("ShowGlobalGameTime").toBool());
     ui->recordGameTime->setChecked(s->get("RecordGameTime").toBool());
     ui->showGameTimeHours->setChecked(s->get("ShowGameTimeHours").toBool());
+
+    ui->prefetchGameFilesCheck->setChecked(s->get("PrefetchGameFiles").toBool());
+
+    ui->traceLaunchesCheck->setChecked(s->get("TraceLaunches").toBool());
 }
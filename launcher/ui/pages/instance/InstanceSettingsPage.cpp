@@ -253,6 +253,9 @@ void InstanceSettingsPage::applySettings()
     {
         m_settings->reset("JoinSingleplayerWorldOnLaunchName");
     }
+
+    // Startup
+    m_settings->set("UseClassDataSharing", ui->classDataSharingCheck->isChecked());
 }
 
 void InstanceSettingsPage::loadSettings()
@@ -337,6 +340,8 @@ void InstanceSettingsPage::loadSettings()
         ui->worldsComboBox->setCurrentText(m_settings->get("JoinSingleplayerWorldOnLaunchName").toString());
     }
 
+    // Startup
+    ui->classDataSharingCheck->setChecked(m_settings->get("UseClassDataSharing").toBool());
 }
 
 void InstanceSettingsPage::on_javaDetectBtn_clicked()
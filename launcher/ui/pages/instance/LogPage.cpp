@@ -8,6 +8,7 @@
 #include <QShortcut>
 
 #include "launch/LaunchTask.h"
+#include "launch/LogFilterModel.h"
 #include "settings/Setting.h"
 
 #include "ui/GuiUtil.h"
@@ -118,7 +119,13 @@ LogPage::LogPage(InstancePtr instance, QWidget *parent)
     ui->setupUi(this);
     ui->tabWidget->tabBar()->hide();
 
+    m_filter = new LogFilterModel(this);
+    ui->levelFilter->addItem(tr("All messages"), MessageLevel::Unknown);
+    ui->levelFilter->addItem(tr("Warnings and errors"), MessageLevel::Warning);
+    ui->levelFilter->addItem(tr("Errors"), MessageLevel::Error);
+
     m_proxy = new LogFormatProxyModel(this);
+    m_proxy->setSourceModel(m_filter);
     // set up text colors in the log proxy and adapt them to the current theme foreground and background
     {
         auto origForeground = ui->text->palette().color(ui->text->foregroundRole());
@@ -202,7 +209,7 @@ void LogPage::setInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc,
     if(m_process)
     {
         m_model = proc->getLogModel();
-        m_proxy->setSourceModel(m_model.get());
+        m_filter->setSourceModel(m_model.get());
         if(initial)
         {
             modelStateToUI();
@@ -214,7 +221,7 @@ void LogPage::setInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc,
     }
     else
     {
-        m_proxy->setSourceModel(nullptr);
+        m_filter->setSourceModel(nullptr);
         m_model.reset();
     }
 }
@@ -231,7 +238,7 @@ bool LogPage::apply()
 
 bool LogPage::shouldDisplay() const
 {
-    return m_instance->isRunning() || m_proxy->rowCount() > 0;
+    return m_instance->isRunning() || (m_model && m_model->rowCount() > 0);
 }
 
 void LogPage::on_btnPaste_clicked()
@@ -315,21 +322,53 @@ void LogPage::on_wrapCheckbox_clicked(bool checked)
     m_model->setLineWrap(checked);
 }
 
+void LogPage::on_levelFilter_currentIndexChanged(int index)
+{
+    m_filter->setMinimumLevel(MessageLevel::Enum(ui->levelFilter->itemData(index).toInt()));
+}
+
+void LogPage::findNext(bool reverse)
+{
+    auto what = ui->searchBar->text();
+    if(!m_model || what.isEmpty())
+    {
+        return;
+    }
+    // another place in the same line comes first
+    if(ui->text->findInRow(what, reverse))
+    {
+        return;
+    }
+    // then the log itself is searched, not what is shown of it
+    int row = ui->text->currentRow();
+    int from = reverse ? m_model->rowCount() - 1 : 0;
+    if(row >= 0)
+    {
+        from = m_filter->mapToSource(m_filter->index(row, 0)).row() + (reverse ? -1 : 1);
+    }
+    int found = m_model->find(what, from, reverse, m_filter->minimumLevel());
+    if(found < 0)
+    {
+        return;
+    }
+    ui->text->selectInRow(m_filter->rowFor(found), what, reverse);
+}
+
 void LogPage::on_findButton_clicked()
 {
     auto modifiers = QApplication::keyboardModifiers();
     bool reverse = modifiers & Qt::ShiftModifier;
-    ui->text->findNext(ui->searchBar->text(), reverse);
+    findNext(reverse);
 }
 
 void LogPage::findNextActivated()
 {
-    ui->text->findNext(ui->searchBar->text(), false);
+    findNext(false);
 }
 
 void LogPage::findPreviousActivated()
 {
-    ui->text->findNext(ui->searchBar->text(), true);
+    findNext(true);
 }
 
 void LogPage::findActivated()
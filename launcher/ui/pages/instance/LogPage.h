@@ -28,6 +28,7 @@ class LogPage;
 }
 class QTextCharFormat;
 class LogFormatProxyModel;
+class LogFilterModel;
 
 class LogPage : public QWidget, public BasePage
 {
@@ -63,6 +64,7 @@ private slots:
 
     void on_trackLogCheckbox_clicked(bool checked);
     void on_wrapCheckbox_clicked(bool checked);
+    void on_levelFilter_currentIndexChanged(int index);
 
     void on_findButton_clicked();
     void findActivated();
@@ -75,6 +77,7 @@ private:
     void modelStateToUI();
     void UIToModelState();
     void setInstanceLaunchTaskChanged(shared_qobject_ptr<LaunchTask> proc, bool initial);
+    void findNext(bool reverse);
 
 private:
     Ui::LogPage *ui;
@@ -82,5 +85,6 @@ private:
     shared_qobject_ptr<LaunchTask> m_process;
 
     LogFormatProxyModel * m_proxy;
+    LogFilterModel * m_filter;
     shared_qobject_ptr <LogModel> m_model;
 };
@@ -417,7 +417,8 @@ void VersionPage::on_actionDownload_All_triggered()
         return;
     }
 
-    auto updateTask = m_inst->createUpdateTask(Net::Mode::Online);
+    // the user asked for it, so take the time to check the files we already have too
+    auto updateTask = m_inst->createVerifyTask();
     if (!updateTask)
     {
         return;
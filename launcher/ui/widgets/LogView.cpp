@@ -6,6 +6,7 @@ LogView::LogView(QWidget* parent) : QPlainTextEdit(parent)
 {
     setWordWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
     m_defaultFormat = new QTextCharFormat(currentCharFormat());
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &LogView::scrolled);
 }
 
 LogView::~LogView()
@@ -63,13 +64,30 @@ void LogView::modelDestroyed(QObject* model)
 
 void LogView::repopulate()
 {
+    // the newest lines, the rest is loaded when scrolled to
+    loadWindow(m_model ? m_model->rowCount() - m_windowRows : 0);
+}
+
+void LogView::loadWindow(int first)
+{
+    bool paging = m_paging;
+    m_paging = true;
     auto doc = document();
     doc->clear();
-    if(!m_model)
+    m_first = 0;
+    m_rows = 0;
+    if(m_model)
     {
-        return;
+        int rowCount = m_model->rowCount();
+        m_first = qBound(0, first, qMax(0, rowCount - m_windowRows));
+        int last = qMin(rowCount, m_first + m_windowRows) - 1;
+        auto workCursor = textCursor();
+        workCursor.movePosition(QTextCursor::End);
+        workCursor.beginEditBlock();
+        insertRows(workCursor, m_first, last);
+        workCursor.endEditBlock();
     }
-    rowsInserted(QModelIndex(), 0, m_model->rowCount() - 1);
+    m_paging = paging;
 }
 
 void LogView::rowsAboutToBeInserted(const QModelIndex& parent, int first, int last)
@@ -90,11 +108,11 @@ void LogView::rowsAboutToBeInserted(const QModelIndex& parent, int first, int la
     }
 }
 
-void LogView::rowsInserted(const QModelIndex& parent, int first, int last)
+void LogView::insertRows(QTextCursor &cursor, int first, int last)
 {
     for(int i = first; i <= last; i++)
     {
-        auto idx = m_model->index(i, 0, parent);
+        auto idx = m_model->index(i, 0);
         auto text = m_model->data(idx, Qt::DisplayRole).toString();
         QTextCharFormat format(*m_defaultFormat);
         auto font = m_model->data(idx, Qt::FontRole);
@@ -112,10 +130,61 @@ void LogView::rowsInserted(const QModelIndex& parent, int first, int last)
         {
             format.setBackground(bg.value<QColor>());
         }
+        cursor.insertText(text, format);
+        cursor.insertBlock();
+    }
+    m_rows += last - first + 1;
+}
+
+void LogView::removeTop(int count)
+{
+    auto bar = verticalScrollBar();
+    int value = bar->value();
+    int before = bar->maximum();
+    QTextCursor cursor(document());
+    cursor.movePosition(QTextCursor::Start);
+    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, count);
+    cursor.removeSelectedText();
+    m_first += count;
+    m_rows -= count;
+    // keep the same lines in view
+    bar->setValue(value - (before - bar->maximum()));
+}
+
+void LogView::removeBottom(int count)
+{
+    QTextCursor cursor(document()->findBlockByNumber(m_rows - count));
+    cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    m_rows -= count;
+}
+
+void LogView::rowsInserted(const QModelIndex& parent, int first, int last)
+{
+    Q_UNUSED(parent)
+    if(m_first + m_rows != first)
+    {
+        // older lines are shown, the new ones are loaded when scrolled to
+        return;
+    }
+    if(last - first + 1 >= m_windowRows)
+    {
+        repopulate();
+    }
+    else
+    {
+        m_paging = true;
+        // one edit for all the rows, so the document is laid out once for them and not for every line
         auto workCursor = textCursor();
         workCursor.movePosition(QTextCursor::End);
-        workCursor.insertText(text, format);
-        workCursor.insertBlock();
+        workCursor.beginEditBlock();
+        insertRows(workCursor, first, last);
+        workCursor.endEditBlock();
+        if(m_rows > m_windowRows)
+        {
+            removeTop(m_rows - m_windowRows);
+        }
+        m_paging = false;
     }
     if(m_scroll && !m_scrolling)
     {
@@ -126,19 +195,127 @@ void LogView::rowsInserted(const QModelIndex& parent, int first, int last)
 
 void LogView::rowsRemoved(const QModelIndex& parent, int first, int last)
 {
-    // TODO: some day... maybe
+    // note: the rows are removed from the front
     Q_UNUSED(parent)
     Q_UNUSED(first)
-    Q_UNUSED(last)
+    int count = last + 1;
+    int gone = qMin(m_rows, qMax(0, count - m_first));
+    m_paging = true;
+    if(gone > 0)
+    {
+        removeTop(gone);
+    }
+    m_paging = false;
+    m_first -= count;
+    if(m_rows == 0)
+    {
+        repopulate();
+    }
+}
+
+void LogView::scrolled(int value)
+{
+    if(!m_model || m_paging)
+    {
+        return;
+    }
+    auto bar = verticalScrollBar();
+    int rowCount = m_model->rowCount();
+    m_paging = true;
+    if(value == bar->minimum() && m_first > 0)
+    {
+        int count = qMin(m_pageRows, m_first);
+        int before = bar->maximum();
+        QTextCursor cursor(document());
+        cursor.movePosition(QTextCursor::Start);
+        cursor.beginEditBlock();
+        insertRows(cursor, m_first - count, m_first - 1);
+        cursor.endEditBlock();
+        m_first -= count;
+        // keep the same lines in view
+        bar->setValue(value + bar->maximum() - before);
+        if(m_rows > m_windowRows)
+        {
+            removeBottom(m_rows - m_windowRows);
+        }
+    }
+    else if(value == bar->maximum() && m_first + m_rows < rowCount)
+    {
+        int count = qMin(m_pageRows, rowCount - m_first - m_rows);
+        if(m_rows + count > m_windowRows)
+        {
+            removeTop(m_rows + count - m_windowRows);
+        }
+        auto workCursor = textCursor();
+        workCursor.movePosition(QTextCursor::End);
+        workCursor.beginEditBlock();
+        insertRows(workCursor, m_first + m_rows, m_first + m_rows + count - 1);
+        workCursor.endEditBlock();
+    }
+    m_paging = false;
 }
 
 void LogView::scrollToBottom()
 {
     m_scrolling = false;
+    if(m_model && m_first + m_rows < m_model->rowCount())
+    {
+        repopulate();
+    }
     verticalScrollBar()->setSliderPosition(verticalScrollBar()->maximum());
 }
 
-void LogView::findNext(const QString& what, bool reverse)
+int LogView::currentRow() const
+{
+    if(!m_rows)
+    {
+        return -1;
+    }
+    return m_first + qMin(textCursor().blockNumber(), m_rows - 1);
+}
+
+bool LogView::findInRow(const QString& what, bool reverse)
+{
+    auto cursor = textCursor();
+    if(!m_rows || what.isEmpty() || cursor.blockNumber() >= m_rows)
+    {
+        return false;
+    }
+    auto text = cursor.block().text();
+    int start = cursor.selectionStart() - cursor.block().position();
+    int end = cursor.selectionEnd() - cursor.block().position();
+    int found = reverse ? (start > 0 ? text.lastIndexOf(what, start - 1, Qt::CaseInsensitive) : -1)
+                        : text.indexOf(what, end, Qt::CaseInsensitive);
+    if(found < 0)
+    {
+        return false;
+    }
+    selectInBlock(cursor.block(), found, what.size());
+    return true;
+}
+
+void LogView::selectInRow(int row, const QString& what, bool reverse)
+{
+    if(!m_model || row < 0 || row >= m_model->rowCount())
+    {
+        return;
+    }
+    if(row < m_first || row >= m_first + m_rows)
+    {
+        // only the rows around it are put into the document
+        loadWindow(row - m_windowRows / 2);
+    }
+    auto block = document()->findBlockByNumber(row - m_first);
+    auto text = block.text();
+    int found = reverse ? text.lastIndexOf(what, -1, Qt::CaseInsensitive) : text.indexOf(what, 0, Qt::CaseInsensitive);
+    selectInBlock(block, qMax(found, 0), found < 0 ? 0 : what.size());
+}
+
+void LogView::selectInBlock(const QTextBlock& block, int position, int length)
 {
-    find(what, reverse ? QTextDocument::FindFlag::FindBackward : QTextDocument::FindFlag(0));
+    QTextCursor cursor(block);
+    cursor.setPosition(block.position() + position);
+    cursor.setPosition(block.position() + position + length, QTextCursor::KeepAnchor);
+    setTextCursor(cursor);
+    centerCursor();
 }
@@ -3,7 +3,14 @@
 #include <QAbstractItemView>
 
 class QAbstractItemModel;
+class QTextBlock;
 
+/*
+ * Shows the rows of a log model as text.
+ *
+ * Only a window of the rows is in the document at a time, the newest ones unless scrolled back. More rows are loaded as
+ * the view is scrolled to either end of the window, so a log of any length can be looked through.
+ */
 class LogView: public QPlainTextEdit
 {
     Q_OBJECT
@@ -14,9 +21,15 @@ public:
     virtual void setModel(QAbstractItemModel *model);
     QAbstractItemModel *model() const;
 
+    /// the row the text cursor is in, -1 if there are no rows
+    int currentRow() const;
+    /// selects the next place of the text in the row the text cursor is in, false if there is none
+    bool findInRow(const QString & what, bool reverse);
+    /// selects the text in the row, bringing the row into the document if it isn't there
+    void selectInRow(int row, const QString & what, bool reverse);
+
 public slots:
     void setWordWrap(bool wrapping);
-    void findNext(const QString & what, bool reverse);
     void scrollToBottom();
 
 protected slots:
@@ -27,10 +40,25 @@ protected slots:
     // note: this supports only removing from front
     void rowsRemoved(const QModelIndex &parent, int first, int last);
     void modelDestroyed(QObject * model);
+    void scrolled(int value);
+
+protected:
+    void insertRows(QTextCursor &cursor, int first, int last);
+    void removeTop(int count);
+    void removeBottom(int count);
+    void loadWindow(int first);
+    void selectInBlock(const QTextBlock &block, int position, int length);
 
 protected:
     QAbstractItemModel *m_model = nullptr;
     QTextCharFormat *m_defaultFormat = nullptr;
     bool m_scroll = false;
     bool m_scrolling = false;
+    /// the model row in the first block of the document, and how many rows are in it
+    int m_first = 0;
+    int m_rows = 0;
+    int m_windowRows = 10000;
+    /// rows loaded at once when scrolled to the end of the window
+    int m_pageRows = 1000;
+    bool m_paging = false;
 };